@@ -0,0 +1,80 @@
+// Counts global heap allocations per order on the matching path,
+// comparing the typed event API with the legacy string API.
+#include "order_book.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+static std::atomic<long long> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static std::string fmt_price(int64_t ticks) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.2f", static_cast<double>(ticks) / 100.0);
+    return buf;
+}
+
+struct Result { double allocs_per_order; double ns_per_order; };
+
+// Rests 'levels' x 'per_level' asks, then sends BUYs that each sweep
+// 'sweep' whole resting orders. Only the sweeping phase is measured.
+template <class SendFn>
+static Result run(int levels, int per_level, int sweep, SendFn&& send) {
+    OrderBook ob;
+    BookEvents scratch;
+    int64_t id = 1;
+    for (int l = 0; l < levels; ++l)
+        for (int k = 0; k < per_level; ++k) {
+            scratch.clear();
+            ob.seed(Side::Sell, 10, 5000 + l, id++, scratch);
+        }
+
+    const int orders = (levels * per_level) / sweep;
+    const long long a0 = g_allocs.load();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < orders; ++i) send(ob, 10 * sweep, id++);
+    auto t1 = std::chrono::steady_clock::now();
+    const long long a1 = g_allocs.load();
+
+    Result r;
+    r.allocs_per_order = static_cast<double>(a1 - a0) / orders;
+    r.ns_per_order = std::chrono::duration<double, std::nano>(t1 - t0).count() / orders;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    int levels = 200, per_level = 500, sweep = 4;
+    if (argc > 1) levels = std::atoi(argv[1]);
+    if (argc > 2) per_level = std::atoi(argv[2]);
+    if (argc > 3) sweep = std::atoi(argv[3]);
+
+    BookEvents events;
+    events.reserve(256);
+    auto ev = run(levels, per_level, sweep, [&](OrderBook& ob, int qty, int64_t id) {
+        events.clear();
+        ob.processOrder(Side::Buy, qty, 1000000, id, events);
+    });
+    auto str = run(levels, per_level, sweep, [&](OrderBook& ob, int qty, int64_t id) {
+        auto lines = ob.processOrder(Side::Buy, qty, 1000000, id, fmt_price);
+        (void)lines;
+    });
+
+    std::cout << "Matching path: " << levels << " levels x " << per_level
+              << " orders, each BUY sweeps " << sweep << " resting orders\n";
+    std::printf("%-12s %14s %12s\n", "api", "allocs/order", "ns/order");
+    std::printf("%-12s %14.2f %12.1f\n", "events", ev.allocs_per_order, ev.ns_per_order);
+    std::printf("%-12s %14.2f %12.1f\n", "strings", str.allocs_per_order, str.ns_per_order);
+    return 0;
+}
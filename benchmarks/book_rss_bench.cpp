@@ -0,0 +1,109 @@
+// Resident memory over a million-order session, heap vs arena book memory.
+// The flow rests, crosses, cancels and replaces around a drifting mid, so
+// price levels keep appearing and emptying; orders still resting 'live'
+// ids later are cancelled, which holds the book at a steady size. Each
+// mode runs in its own process so neither inherits the other's heap.
+#include "order_book.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static std::atomic<long long> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, std::align_val_t al) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t a = static_cast<std::size_t>(al);
+    if (void* p = std::aligned_alloc(a, (n + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+static long rssKb() {
+    long pages = 0, resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void session(BookAlloc alloc, LadderKind ladder, size_t orders, int64_t live) {
+    BookConfig cfg;
+    cfg.ladder = ladder;
+    cfg.alloc = alloc;
+    const long rss0 = rssKb();
+    OrderBook ob(cfg);
+    BookEvents ev;
+    ev.reserve(1024);
+
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> pct(0, 99), qty(1, 200), off(0, 300);
+    int64_t mid = 500000, id = 1;
+    const size_t step = orders / 10;
+    long long a_warm = 0;
+    long rss_warm = 0;
+
+    std::printf("%-6s %-5s RSS KB at", alloc == BookAlloc::Arena ? "arena" : "heap",
+                ladder == LadderKind::Dense ? "dense" : "map");
+    const auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 1; i <= orders; ++i) {
+        ev.clear();
+        if (id > live) ob.cancel(id - live, ev);
+        if (pct(rng) < 2) mid += pct(rng) < 50 ? -1 : 1;   // slow random walk
+        const Side side = pct(rng) < 50 ? Side::Buy : Side::Sell;
+        const int64_t away = side == Side::Buy ? -1 - off(rng) : 1 + off(rng);
+        const int r = pct(rng);
+        if (r < 60)      ob.processOrder(side, qty(rng), mid + away, id, ev);
+        else if (r < 75) ob.processOrder(side, qty(rng), mid, id, ev);
+        else if (r < 90) ob.cancel(id - 1 - off(rng), ev);
+        else             ob.replace(id - 1 - off(rng), qty(rng), mid + away, id, ev);
+        ++id;
+        if (i % step == 0) {
+            std::printf(" %ld", rssKb() - rss0);
+            if (i == step) { a_warm = g_allocs.load(); rss_warm = rssKb(); }
+        }
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(orders);
+    std::printf("\n%-12s growth after warm-up %ld KB, %lld global allocs after warm-up, "
+                "%.1f ns/op, resting %zu, arena overflow %zu KB\n",
+                "", rssKb() - rss_warm, g_allocs.load() - a_warm, ns, ob.restingOrders(),
+                ob.memory().overflowBytes() / 1024);
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    size_t orders = 1000000;
+    int64_t live = 50000;
+    if (argc > 1) orders = static_cast<size_t>(std::atoll(argv[1]));
+    if (argc > 2) live = std::atoll(argv[2]);
+    orders = std::max<size_t>(orders, 10);
+
+    std::printf("%zu orders, resting orders cancelled after %lld ids; RSS above the\n"
+                "pre-book baseline at each tenth of the session\n",
+                orders, static_cast<long long>(live));
+    for (LadderKind ladder : {LadderKind::Map, LadderKind::Dense})
+        for (BookAlloc alloc : {BookAlloc::Heap, BookAlloc::Arena}) {
+            std::fflush(stdout);
+            const pid_t pid = fork();
+            if (pid == 0) { session(alloc, ladder, orders, live); _exit(0); }
+            int status = 0;
+            if (pid < 0 || waitpid(pid, &status, 0) < 0) { std::perror("fork"); return 1; }
+        }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Cancel-heavy workload: deep price levels (10k+ resting orders each),
+// cancels taken from the front, middle, back and at random.
+#include "order_book.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+enum class Pick { Front, Middle, Back, Random };
+
+static const char* pickName(Pick p) {
+    switch (p) {
+        case Pick::Front:  return "front";
+        case Pick::Middle: return "middle";
+        case Pick::Back:   return "back";
+        case Pick::Random: return "random";
+    }
+    return "?";
+}
+
+// Rests 'levels' x 'per_level' bids, cancels 'cancels' of them chosen by
+// 'pick' within each level, and returns ns per cancel.
+static double run(const BookConfig& cfg, int levels, int per_level, int cancels, Pick pick) {
+    OrderBook ob(cfg);
+    BookEvents ev;
+    ev.reserve(16);
+
+    std::vector<std::vector<int64_t>> ids(static_cast<size_t>(levels));
+    int64_t id = 1;
+    for (int l = 0; l < levels; ++l)
+        for (int k = 0; k < per_level; ++k) {
+            ev.clear();
+            ob.processOrder(Side::Buy, 10, 5000 - l, id, ev);
+            ids[static_cast<size_t>(l)].push_back(id++);
+        }
+
+    // Pick victims up front so the timed loop only cancels.
+    std::mt19937_64 rng(7);
+    std::vector<int64_t> victims;
+    victims.reserve(static_cast<size_t>(cancels));
+    for (int c = 0; c < cancels; ++c) {
+        auto& lvl = ids[static_cast<size_t>(c % levels)];
+        if (lvl.empty()) break;
+        size_t at = 0;
+        switch (pick) {
+            case Pick::Front:  at = 0; break;
+            case Pick::Middle: at = lvl.size() / 2; break;
+            case Pick::Back:   at = lvl.size() - 1; break;
+            case Pick::Random: at = std::uniform_int_distribution<size_t>(0, lvl.size() - 1)(rng); break;
+        }
+        victims.push_back(lvl[at]);
+        lvl.erase(lvl.begin() + static_cast<std::ptrdiff_t>(at));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int64_t v : victims) { ev.clear(); ob.cancel(v, ev); }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(victims.size());
+}
+
+int main(int argc, char** argv) {
+    int levels = 4, per_level = 20000, cancels = 20000;
+    if (argc > 1) levels = std::atoi(argv[1]);
+    if (argc > 2) per_level = std::atoi(argv[2]);
+    if (argc > 3) cancels = std::atoi(argv[3]);
+
+    BookConfig map_cfg;
+    map_cfg.pool_capacity = static_cast<size_t>(levels) * static_cast<size_t>(per_level);
+    BookConfig dense_cfg = map_cfg;
+    dense_cfg.ladder = LadderKind::Dense;
+
+    std::printf("%d levels x %d orders/level, %d cancels (ns/cancel)\n", levels, per_level, cancels);
+    std::printf("%-8s %10s %10s\n", "pick", "map", "dense");
+    for (Pick p : {Pick::Front, Pick::Middle, Pick::Back, Pick::Random}) {
+        std::printf("%-8s %10.1f %10.1f\n", pickName(p),
+                    run(map_cfg, levels, per_level, cancels, p),
+                    run(dense_cfg, levels, per_level, cancels, p));
+    }
+    return 0;
+}
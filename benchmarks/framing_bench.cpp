@@ -0,0 +1,87 @@
+// recv() syscalls and time per message: the old one-byte-per-recv reader
+// vs LineReader, over a local socketpair carrying typical order lines.
+#include "line_reader.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+static uint64_t g_byte_recvs = 0;
+
+// The reader every binary used before LineReader.
+static bool read_line_bytewise(int fd, std::string& line) {
+    line.clear();
+    char ch = 0;
+    while (true) {
+        ++g_byte_recvs;
+        ssize_t n = recv(fd, &ch, 1, 0);
+        if (n <= 0) return false;
+        if (ch == '\n') break;
+        line.push_back(ch);
+        if (line.size() > 8192) return false;
+    }
+    return true;
+}
+
+// Writer sends 'msgs' lines in bursts of 'burst' per write().
+static void writer(int fd, int msgs, int burst) {
+    const std::string one = "NEW BUY 137 @ 50.31\n";
+    std::string chunk;
+    for (int i = 0; i < burst; ++i) chunk += one;
+    for (int sent = 0; sent < msgs; sent += burst) {
+        const size_t n = std::min(burst, msgs - sent) * one.size();
+        for (size_t off = 0; off < n;) {
+            ssize_t w = write(fd, chunk.data() + off, n - off);
+            if (w <= 0) return;
+            off += static_cast<size_t>(w);
+        }
+    }
+    shutdown(fd, SHUT_WR);
+}
+
+template <class ReadAll>
+static double ns_per_msg(int msgs, int burst, ReadAll&& read_all) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) { perror("socketpair"); std::exit(1); }
+    auto t0 = std::chrono::steady_clock::now();
+    std::thread w(writer, sv[1], msgs, burst);
+    const int got = read_all(sv[0]);
+    w.join();
+    auto t1 = std::chrono::steady_clock::now();
+    close(sv[0]); close(sv[1]);
+    if (got != msgs) std::fprintf(stderr, "short read: %d/%d\n", got, msgs);
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / msgs;
+}
+
+int main(int argc, char** argv) {
+    int msgs = 200000;
+    if (argc > 1) msgs = std::atoi(argv[1]);
+
+    std::printf("%d messages of 20 bytes (recv calls and ns per message)\n", msgs);
+    std::printf("%-6s %-10s %12s %10s\n", "burst", "reader", "recv/msg", "ns/msg");
+    for (int burst : {1, 16, 256}) {
+        g_byte_recvs = 0;
+        const double b_ns = ns_per_msg(msgs, burst, [](int fd) {
+            std::string line; int n = 0;
+            while (read_line_bytewise(fd, line)) ++n;
+            return n;
+        });
+        const double b_calls = static_cast<double>(g_byte_recvs) / msgs;
+
+        uint64_t calls = 0;
+        const double l_ns = ns_per_msg(msgs, burst, [&](int fd) {
+            LineReader r;
+            std::string_view line; int n = 0;
+            while (r.readLine(fd, line) == LineReader::Status::Line) ++n;
+            calls = r.recvCalls();
+            return n;
+        });
+        std::printf("%-6d %-10s %12.3f %10.1f\n", burst, "bytewise", b_calls, b_ns);
+        std::printf("%-6d %-10s %12.3f %10.1f\n", burst, "LineReader", static_cast<double>(calls) / msgs, l_ns);
+    }
+    return 0;
+}
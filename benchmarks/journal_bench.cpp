@@ -0,0 +1,73 @@
+// Cost of the engine's write-ahead journal per durability level: records/s
+// and time per engine batch (append 'batch' records, then commit), against
+// a file in the current directory (or argv[2]).
+#include "journal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct Result {
+    double   records_per_s;
+    double   p50_us, p99_us;   // per batch
+    uint64_t syncs;
+};
+
+static Result run(const std::string& path, JournalSync sync, int records, int batch) {
+    unlink(path.c_str());
+    Journal j;
+    if (!j.open(path, static_cast<size_t>(records), sync, 10000000)) std::exit(1);
+
+    JournalRecord r{};
+    r.op = static_cast<uint8_t>(JournalOp::New);
+    r.qty = 100;
+    r.price_ticks = 5025;
+
+    std::vector<double> lat;
+    lat.reserve(static_cast<size_t>(records / batch + 1));
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int done = 0; done < records;) {
+        const auto b0 = std::chrono::steady_clock::now();
+        uint64_t first = 0, last = 0;
+        for (int k = 0; k < batch && done < records; ++k, ++done) {
+            r.order_id = done + 1;
+            last = j.append(r);
+            if (!first) first = last;
+        }
+        j.commit(first, last);
+        lat.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - b0).count());
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    const uint64_t syncs = j.syncs();
+    j.close();
+    unlink(path.c_str());
+
+    std::sort(lat.begin(), lat.end());
+    return Result{records / secs, lat[lat.size() / 2], lat[lat.size() * 99 / 100], syncs};
+}
+
+int main(int argc, char** argv) {
+    int records = 200000;
+    if (argc > 1) records = std::atoi(argv[1]);
+    const int batches[] = {1, 16, 64};
+    const std::string path = argc > 2 ? argv[2] : "journal_bench.bin";
+
+    std::printf("%d records, 64 B each, file %s\n", records, path.c_str());
+    std::printf("%-9s %6s %14s %12s %12s %8s\n", "sync", "batch", "records/s", "p50 us/batch", "p99 us/batch", "syncs");
+    struct Mode { const char* name; JournalSync sync; };
+    for (const Mode m : {Mode{"none", JournalSync::None}, Mode{"periodic", JournalSync::Periodic},
+                         Mode{"batch", JournalSync::Batch}}) {
+        for (int b : batches) {
+            // Group commit does one msync per batch; keep its runs short.
+            const int n = m.sync == JournalSync::Batch ? std::min(records, 2000 * b) : records;
+            const Result res = run(path, m.sync, n, b);
+            std::printf("%-9s %6d %14.0f %12.2f %12.2f %8llu\n", m.name, b, res.records_per_s,
+                        res.p50_us, res.p99_us, static_cast<unsigned long long>(res.syncs));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Insert / match / cancel throughput for the map and dense level backends.
+// Prices follow the bot's flow: uniform +/- band ticks around 50.25.
+#include "order_book.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+struct Op { Side side; int qty; int64_t px; };
+
+static std::vector<Op> make_flow(size_t n, int band, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> side_dist(0, 1), qty_dist(1, 200), pips(-band, band);
+    std::vector<Op> ops(n);
+    for (auto& o : ops) {
+        o.side = side_dist(rng) ? Side::Buy : Side::Sell;
+        o.qty  = qty_dist(rng);
+        o.px   = 5025 + pips(rng);
+    }
+    return ops;
+}
+
+template <class F>
+static double ns_per_op(size_t n, F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(n);
+}
+
+struct Row { double insert, match, cancel; };
+
+static Row bench(const BookConfig& cfg, size_t n, int band) {
+    Row r{};
+    BookEvents ev;
+    ev.reserve(1024);
+
+    // Insert: non-crossing passive orders (bids below, asks above the mid).
+    {
+        OrderBook ob(cfg);
+        auto flow = make_flow(n, band, 1);
+        r.insert = ns_per_op(n, [&] {
+            int64_t id = 1;
+            for (const auto& o : flow) {
+                ev.clear();
+                const int64_t off = o.px - 5025;
+                const int64_t px = o.side == Side::Buy ? 5025 - 1 - std::abs(off) : 5025 + 1 + std::abs(off);
+                ob.processOrder(o.side, o.qty, px, id++, ev);
+            }
+        });
+    }
+    // Match: the bot's mixed flow, which cross-matches continuously.
+    {
+        OrderBook ob(cfg);
+        auto flow = make_flow(n, band, 2);
+        r.match = ns_per_op(n, [&] {
+            int64_t id = 1;
+            for (const auto& o : flow) {
+                ev.clear();
+                ob.processOrder(o.side, o.qty, o.px, id++, ev);
+            }
+        });
+    }
+    // Cancel: rest n passive orders, cancel them in random order.
+    {
+        OrderBook ob(cfg);
+        auto flow = make_flow(n, band, 3);
+        std::vector<int64_t> ids;
+        ids.reserve(n);
+        int64_t id = 1;
+        for (const auto& o : flow) {
+            ev.clear();
+            const int64_t off = o.px - 5025;
+            const int64_t px = o.side == Side::Buy ? 5025 - 1 - std::abs(off) : 5025 + 1 + std::abs(off);
+            ob.processOrder(o.side, o.qty, px, id, ev);
+            ids.push_back(id++);
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937_64(4));
+        r.cancel = ns_per_op(n, [&] {
+            for (int64_t cid : ids) { ev.clear(); ob.cancel(cid, ev); }
+        });
+    }
+    return r;
+}
+
+int main(int argc, char** argv) {
+    size_t n = 200000;
+    if (argc > 1) n = static_cast<size_t>(std::atoll(argv[1]));
+
+    BookConfig map_cfg;
+    BookConfig dense_cfg;
+    dense_cfg.ladder = LadderKind::Dense;
+
+    std::printf("%zu ops per phase (ns/op)\n", n);
+    std::printf("%-8s %-6s %10s %10s %10s\n", "band", "book", "insert", "match", "cancel");
+    for (int band : {20, 200, 2000}) {
+        Row m = bench(map_cfg, n, band);
+        Row d = bench(dense_cfg, n, band);
+        std::printf("+/-%-5d %-6s %10.1f %10.1f %10.1f\n", band, "map",   m.insert, m.match, m.cancel);
+        std::printf("+/-%-5d %-6s %10.1f %10.1f %10.1f\n", band, "dense", d.insert, d.match, d.cancel);
+    }
+    return 0;
+}
@@ -0,0 +1,439 @@
+// Google Benchmark suite for the hot paths behind the README's numbers:
+// OrderBook new / sweep / cancel / replace over parameterised depth, price and
+// event formatting, OrderQueue pushes under producer contention, and the text
+// command parse done per line in exchange.cpp.
+//
+// Results go to latency_test.json (Google Benchmark's JSON schema) unless
+// --benchmark_out is given, so runs can be diffed between releases, e.g. with
+// tools/compare.py from the benchmark repository.
+#include "command_parser.hpp"
+#include "engine_queue.hpp"
+#include "order_book.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kTickFactor = 100;
+constexpr int64_t kMid = 10000;          // asks from kMid up, bids from kMid - 1 down
+constexpr int     kLotQty = 1 << 30;     // resting qty large enough never to fill away
+
+// 'levels' ask and bid levels of 'per_level' orders each. Returns the next free id.
+int64_t fillBook(OrderBook& ob, int levels, int per_level, int qty, BookEvents& ev, int64_t id = 1) {
+    for (int l = 0; l < levels; ++l)
+        for (int k = 0; k < per_level; ++k) {
+            ev.clear();
+            ob.processOrder(Side::Sell, qty, kMid + l, id++, ev);
+            ob.processOrder(Side::Buy, qty, kMid - 1 - l, id++, ev);
+        }
+    return id;
+}
+
+BookConfig bookConfig(int64_t ladder) {
+    BookConfig cfg;
+    cfg.ladder = ladder ? LadderKind::Dense : LadderKind::Map;
+    return cfg;
+}
+
+// Args: levels, orders per level, ladder (0 map, 1 dense).
+void BookArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"levels", "per_level", "dense"})->ArgsProduct({{1, 10, 100}, {1, 10, 100}, {0, 1}});
+}
+
+// ---- OrderBook ----
+
+// Passive bid joining the back of an existing level (no match).
+void BM_NewResting(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0)), per_level = static_cast<int>(state.range(1));
+    OrderBook ob(bookConfig(state.range(2)));
+    BookEvents ev;
+    ev.reserve(16);
+    int64_t id = fillBook(ob, levels, per_level, 10, ev);
+    const int64_t first = id;
+    for (auto _ : state) {
+        ev.clear();
+        ob.processOrder(Side::Buy, 10, kMid - 1 - (id % levels), id, ev);
+        ++id;
+        if (id - first == 65536) {   // keep the depth from drifting far from the parameters
+            state.PauseTiming();
+            for (int64_t x = first; x < id; ++x) { ev.clear(); ob.cancel(x, ev); }
+            id = first;
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(ev.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NewResting)->Apply(BookArgs);
+
+// Aggressive buy for 1 lot at the touch: partial fill of the front ask.
+void BM_NewMarketable(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0)), per_level = static_cast<int>(state.range(1));
+    OrderBook ob(bookConfig(state.range(2)));
+    BookEvents ev;
+    ev.reserve(16);
+    int64_t id = fillBook(ob, levels, per_level, kLotQty, ev);
+    for (auto _ : state) {
+        ev.clear();
+        ob.processOrder(Side::Buy, 1, kMid, id++, ev);
+        benchmark::DoNotOptimize(ev.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NewMarketable)->Apply(BookArgs);
+
+// One buy that takes out every ask level (levels x per_level fills).
+void BM_NewSweep(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0)), per_level = static_cast<int>(state.range(1));
+    const BookConfig cfg = bookConfig(state.range(2));
+    BookEvents ev;
+    ev.reserve(static_cast<size_t>(levels * per_level * 2 + 16));
+    std::unique_ptr<OrderBook> ob;
+    for (auto _ : state) {
+        state.PauseTiming();
+        ob = std::make_unique<OrderBook>(cfg);   // the old book is destroyed untimed
+        const int64_t id = fillBook(*ob, levels, per_level, 10, ev);
+        ev.clear();
+        state.ResumeTiming();
+        ob->processOrder(Side::Buy, levels * per_level * 10, kMid + levels, id, ev);
+        benchmark::DoNotOptimize(ev.data());
+    }
+    state.SetItemsProcessed(state.iterations() * levels * per_level);   // fills
+}
+BENCHMARK(BM_NewSweep)->Apply(BookArgs);
+
+// Cancels every bid of a book, each one taken from the front, middle or back
+// of its level. Items are cancels.
+enum Position { Front, Middle, Back };
+
+void BM_Cancel(benchmark::State& state) {
+    const Position pos = static_cast<Position>(state.range(0));
+    const int levels = static_cast<int>(state.range(1)), per_level = static_cast<int>(state.range(2));
+    const BookConfig cfg = bookConfig(state.range(3));
+    BookEvents ev;
+    ev.reserve(16);
+
+    // Bid ids of each level in FIFO order, then the order to cancel them in.
+    std::vector<int64_t> victims;
+    victims.reserve(static_cast<size_t>(levels * per_level));
+    for (int l = 0; l < levels; ++l) {
+        std::vector<int64_t> fifo;
+        for (int k = 0; k < per_level; ++k) fifo.push_back(2 + 2 * (static_cast<int64_t>(l) * per_level + k));
+        switch (pos) {
+            case Front:  victims.insert(victims.end(), fifo.begin(), fifo.end()); break;
+            case Back:   victims.insert(victims.end(), fifo.rbegin(), fifo.rend()); break;
+            case Middle: {
+                // Outward from the centre, so each victim sits mid-queue.
+                size_t lo = fifo.size() / 2, hi = lo + 1;
+                victims.push_back(fifo[lo]);
+                while (lo > 0 || hi < fifo.size()) {
+                    if (hi < fifo.size()) victims.push_back(fifo[hi++]);
+                    if (lo > 0) victims.push_back(fifo[--lo]);
+                }
+                break;
+            }
+        }
+    }
+
+    std::unique_ptr<OrderBook> ob;
+    for (auto _ : state) {
+        state.PauseTiming();
+        ob = std::make_unique<OrderBook>(cfg);
+        fillBook(*ob, levels, per_level, 10, ev);
+        state.ResumeTiming();
+        for (int64_t v : victims) { ev.clear(); ob->cancel(v, ev); }
+        benchmark::DoNotOptimize(ev.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(victims.size()));
+}
+BENCHMARK(BM_Cancel)
+    ->ArgNames({"pos", "levels", "per_level", "dense"})
+    ->ArgsProduct({{Front, Middle, Back}, {1, 10}, {10, 100, 1000}, {0, 1}});
+
+// Modify of the touch bid: moves between two prices (re-queued each time).
+void BM_Replace(benchmark::State& state) {
+    const int levels = static_cast<int>(state.range(0)), per_level = static_cast<int>(state.range(1));
+    OrderBook ob(bookConfig(state.range(2)));
+    BookEvents ev;
+    ev.reserve(16);
+    fillBook(ob, levels, per_level, 10, ev);
+    const int64_t subject = 2;   // first bid, at kMid - 1
+    int64_t flip = 0;
+    for (auto _ : state) {
+        ev.clear();
+        ob.replace(subject, 10, kMid - 1 - (flip ^= 1) * levels, subject, ev);
+        benchmark::DoNotOptimize(ev.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Replace)->Apply(BookArgs);
+
+// ---- Formatting ----
+
+// The exchange's fmt_price before PriceFormat: ticks -> "50.25" through an
+// ostringstream.
+std::string price_text(int64_t ticks, int64_t tick_factor) {
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed); oss.precision(2);
+    oss << (static_cast<double>(ticks) / static_cast<double>(tick_factor));
+    return oss.str();
+}
+
+// formatEvent as it was: an ostringstream per line, prices through a std::function.
+std::string legacyFormatEvent(const BookEvent& ev, const std::function<std::string(int64_t)>& fmt_price) {
+    std::ostringstream oss;
+    const char* side = ev.side == Side::Buy ? "BUY" : "SELL";
+    switch (ev.type) {
+        case BookEventType::Added:
+            oss << "ORDER_ADDED " << side << " " << ev.qty << " @ " << fmt_price(ev.price_ticks) << " id " << ev.order_id;
+            break;
+        case BookEventType::Trade:
+            oss << "TRADE " << side << " " << ev.qty << " @ " << fmt_price(ev.price_ticks) << " against id " << ev.order_id;
+            break;
+        case BookEventType::BestBid: oss << "BEST_BID " << fmt_price(ev.price_ticks) << " x " << ev.qty; break;
+        case BookEventType::BestAsk: oss << "BEST_ASK " << fmt_price(ev.price_ticks) << " x " << ev.qty; break;
+        default: break;   // not in the benchmark mix
+    }
+    return oss.str();
+}
+
+void BM_FmtPriceLegacy(benchmark::State& state) {
+    int64_t ticks = 5025;
+    for (auto _ : state) {
+        std::string s = price_text(ticks, kTickFactor);
+        benchmark::DoNotOptimize(s.data());
+        ticks = ticks == 5125 ? 4925 : ticks + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FmtPriceLegacy);
+
+void BM_FmtPrice(benchmark::State& state) {
+    const PriceFormat px(kTickFactor);
+    char buf[PriceFormat::kMaxChars];
+    int64_t ticks = 5025;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(px.write(buf, ticks));
+        benchmark::ClobberMemory();
+        ticks = ticks == 5125 ? 4925 : ticks + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FmtPrice);
+
+BookEvent tradeEvent() {
+    BookEvent ev;
+    ev.type = BookEventType::Trade;
+    ev.qty = 100;
+    ev.price_ticks = 5025;
+    ev.order_id = 123456;
+    return ev;
+}
+
+// One TRADE reply line.
+void BM_FormatEventLegacy(benchmark::State& state) {
+    const std::function<std::string(int64_t)> fmt_price = [](int64_t t) { return price_text(t, kTickFactor); };
+    const BookEvent ev = tradeEvent();
+    for (auto _ : state) {
+        std::string s = legacyFormatEvent(ev, fmt_price);
+        benchmark::DoNotOptimize(s.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatEventLegacy);
+
+void BM_FormatEvent(benchmark::State& state) {
+    const PriceFormat px(kTickFactor);
+    const BookEvent ev = tradeEvent();
+    std::string s;
+    for (auto _ : state) {
+        s.clear();
+        appendEvent(s, ev, px);
+        benchmark::DoNotOptimize(s.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatEvent);
+
+// A marketable NEW's reply payload, as engine_loop builds it: two fills, the
+// rest added, the new touch; every line tagged " sym AAPL tag <N>".
+// Items are lines.
+BookEvents replyEvents() {
+    BookEvents evs(4, tradeEvent());
+    evs[1].price_ticks = 5026;
+    evs[1].order_id = 123457;
+    evs[2].type = BookEventType::Added;
+    evs[2].order_id = 200001;
+    evs[3].type = BookEventType::BestBid;
+    return evs;
+}
+
+void BM_ReplyLinesLegacy(benchmark::State& state) {
+    const std::function<std::string(int64_t)> fmt_price = [](int64_t t) { return price_text(t, kTickFactor); };
+    const BookEvents evs = replyEvents();
+    std::string payload;
+    uint64_t tag = 1;
+    for (auto _ : state) {
+        payload.clear();
+        std::string sym_tag = " sym " + std::string("AAPL");
+        sym_tag += " tag " + std::to_string(tag++);
+        for (const auto& ev : evs) {
+            payload += legacyFormatEvent(ev, fmt_price);
+            payload += sym_tag;
+            payload += '\n';
+        }
+        benchmark::DoNotOptimize(payload.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(evs.size()));
+}
+BENCHMARK(BM_ReplyLinesLegacy);
+
+void BM_ReplyLines(benchmark::State& state) {
+    const PriceFormat px(kTickFactor);
+    const BookEvents evs = replyEvents();
+    std::string payload, suffix;
+    uint64_t tag = 1;
+    for (auto _ : state) {
+        payload.clear();
+        suffix.clear();
+        suffix += " sym ";
+        suffix += "AAPL";
+        suffix += " tag ";
+        appendInt(suffix, tag++);
+        for (const auto& ev : evs) {
+            appendEvent(payload, ev, px);
+            payload += suffix;
+            payload += '\n';
+        }
+        benchmark::DoNotOptimize(payload.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(evs.size()));
+}
+BENCHMARK(BM_ReplyLines);
+
+// ---- OrderQueue ----
+
+// Producers (the benchmark threads) push while one engine-style consumer
+// drains in batches. Arg: 0 mutex, 1 mpsc.
+std::unique_ptr<OrderQueue> g_queue;
+std::thread g_consumer;
+
+void startConsumer(const benchmark::State& state) {
+    g_queue = std::make_unique<OrderQueue>(4096, state.range(0) ? QueueKind::Mpsc : QueueKind::Mutex,
+                                           WaitPolicy::Block);
+    g_consumer = std::thread([] {
+        OrderMsg batch[64];
+        while (g_queue->popBatch(batch, 64)) {}
+    });
+}
+
+void stopConsumer(const benchmark::State&) {
+    g_queue->stop();
+    g_consumer.join();
+    g_queue.reset();
+}
+
+void BM_QueuePush(benchmark::State& state) {
+    OrderMsg m;
+    m.session = static_cast<SessionId>(state.thread_index() + 1);
+    for (auto _ : state) {
+        ++m.order_id;
+        g_queue->push(m);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueuePush)
+    ->ArgName("mpsc")->Arg(0)->Arg(1)
+    ->ThreadRange(1, 8)
+    ->Setup(startConsumer)->Teardown(stopConsumer)
+    ->UseRealTime();
+
+// ---- Command parsing ----
+
+// Per-line parse as handle_line did before command_parser: istringstream
+// tokens, double prices.
+struct Parsed { int cmd; bool buy; int qty; int64_t id; int64_t ticks; };
+
+bool parseLine(const std::string& line, Parsed& p) {
+    std::istringstream iss{line};
+    std::string cmd; iss >> cmd;
+    std::string tok; iss >> tok;
+    if (cmd == "NEW") {
+        int qty = 0; char at = 0; double price = 0.0;
+        iss >> qty >> at >> price;
+        if ((tok != "BUY" && tok != "SELL") || at != '@' || qty <= 0 || price <= 0.0) return false;
+        p = Parsed{0, tok == "BUY", qty, 0, static_cast<int64_t>(std::llround(price * static_cast<double>(kTickFactor)))};
+        return true;
+    }
+    if (cmd == "CXL" || cmd == "MOD") {
+        char* end = nullptr;
+        int64_t id = std::strtoll(tok.c_str(), &end, 10);
+        if (tok.empty() || *end || id <= 0) return false;
+        if (cmd == "CXL") { p = Parsed{1, false, 0, id, 0}; return true; }
+        int qty = 0; char at = 0; double px = 0.0;
+        iss >> qty >> at >> px;
+        if (qty <= 0 || at != '@' || px <= 0.0) return false;
+        p = Parsed{2, false, qty, id, static_cast<int64_t>(std::llround(px * static_cast<double>(kTickFactor)))};
+        return true;
+    }
+    return false;
+}
+
+const std::vector<std::string> kCommandLines = {
+    "NEW BUY 100 @ 50.25", "NEW SELL 7 @ 50.31", "CXL 123456", "MOD 123457 50 @ 50.27",
+    "NEW BUY 2500 @ 49.99", "NEW SELL 1 @ 50.26", "CXL 9", "NEW BUY 40 @ 50.2",
+};
+
+void BM_ParseCommandLegacy(benchmark::State& state) {
+    Parsed p{};
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parseLine(kCommandLines[i], p));
+        benchmark::DoNotOptimize(p);
+        i = (i + 1) % kCommandLines.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseCommandLegacy);
+
+void BM_ParseCommand(benchmark::State& state) {
+    Command c;
+    std::string_view bad;
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parseCommand(kCommandLines[i], kTickFactor, c, bad));
+        benchmark::DoNotOptimize(c);
+        i = (i + 1) % kCommandLines.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseCommand);
+
+}  // namespace
+
+// Like BENCHMARK_MAIN(), but writes JSON to latency_test.json by default.
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    bool has_out = false;
+    for (int i = 1; i < argc; ++i)
+        if (std::strncmp(argv[i], "--benchmark_out=", 16) == 0) has_out = true;
+    static char out[] = "--benchmark_out=latency_test.json";
+    static char fmt[] = "--benchmark_out_format=json";
+    if (!has_out) { args.push_back(out); args.push_back(fmt); }
+    int n = static_cast<int>(args.size());
+    benchmark::Initialize(&n, args.data());
+    if (benchmark::ReportUnrecognizedArguments(n, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Order-id index at 1M live orders: std::unordered_map (as the book used,
+// reserved for the default 65,536-order pool) against OrderIndex. Ids are
+// increasing with random gaps of 1-4, as one book sees the exchange's shared
+// counter. Phases: insert 1M, look up 1M random live ids, erase all in random
+// order. Each op is timed on its own for the tail (steady_clock adds ~20 ns)
+// and each phase as a whole for the mean. Each index runs in its own process.
+#include "order_index.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+struct Item { int64_t id; };
+
+static long rssKb() {
+    long pages = 0, resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+struct MapIndex {
+    std::unordered_map<int64_t, Item*> m;
+    MapIndex() { m.reserve(65536); }
+    void  insert(int64_t id, Item* v) { m[id] = v; }
+    Item* find(int64_t id) const { auto it = m.find(id); return it == m.end() ? nullptr : it->second; }
+    Item* erase(int64_t id) {
+        auto it = m.find(id);
+        if (it == m.end()) return nullptr;
+        Item* v = it->second;
+        m.erase(it);
+        return v;
+    }
+};
+
+// Times f(i) for i in [0, n): per-op percentiles plus the whole-phase mean.
+template <class F>
+static void phase(const char* name, size_t n, std::vector<uint32_t>& ns, F&& f) {
+    using clk = std::chrono::steady_clock;
+    ns.resize(n);
+    const auto t0 = clk::now();
+    for (size_t i = 0; i < n; ++i) {
+        const auto a = clk::now();
+        f(i);
+        ns[i] = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clk::now() - a).count());
+    }
+    const double mean = std::chrono::duration<double, std::nano>(clk::now() - t0).count() / static_cast<double>(n);
+    std::sort(ns.begin(), ns.end());
+    auto at = [&](double p) { return ns[std::min(n - 1, static_cast<size_t>(p * static_cast<double>(n)))]; };
+    std::printf("  %-7s %8.1f %8u %8u %8u %10u\n", name, mean, at(0.50), at(0.99), at(0.999), ns.back());
+}
+
+template <class Index>
+static void run(const char* label, size_t n) {
+    std::mt19937_64 rng(3);
+    std::vector<Item> items(n);
+    int64_t id = 1;
+    for (auto& it : items) { it.id = id; id += 1 + static_cast<int64_t>(rng() % 4); }
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    std::vector<uint32_t> ns;
+    ns.reserve(n);
+
+    const long rss0 = rssKb();
+    Index ix;
+    std::printf("%s\n  %-7s %8s %8s %8s %8s %10s\n", label, "op", "mean", "p50", "p99", "p99.9", "max");
+    phase("insert", n, ns, [&](size_t i) { ix.insert(items[i].id, &items[i]); });
+    const long rss = rssKb() - rss0;
+    std::shuffle(order.begin(), order.end(), rng);
+    size_t hits = 0;
+    phase("find", n, ns, [&](size_t i) { hits += ix.find(items[order[i]].id) != nullptr; });
+    std::shuffle(order.begin(), order.end(), rng);
+    phase("erase", n, ns, [&](size_t i) { hits += ix.erase(items[order[i]].id) != nullptr; });
+    std::printf("  RSS for %zu live ids: %ld KB (%zu hits)\n", n, rss, hits);
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    size_t n = 1000000;
+    if (argc > 1) n = static_cast<size_t>(std::atoll(argv[1]));
+    n = std::max<size_t>(n, 1);
+    std::printf("%zu live orders, ns per op\n", n);
+    for (int which = 0; which < 2; ++which) {
+        std::fflush(stdout);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            if (which == 0) run<MapIndex>("unordered_map", n);
+            else            run<OrderIndex<Item>>("OrderIndex", n);
+            _exit(0);
+        }
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0) { std::perror("fork"); return 1; }
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+// OrderQueue throughput and enqueue->dequeue latency with 1..32 producers:
+// mutex/condvar backend vs the lock-free MPSC ring under each wait policy.
+#include "engine_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Result { double mops; int64_t p50, p99, p999; };
+
+static Result run(QueueKind kind, WaitPolicy wait, int producers, int total) {
+    OrderQueue q(4096, kind, wait);
+    const int per = total / producers;
+    const int expected = per * producers;
+
+    std::vector<int64_t> lat;
+    lat.reserve(static_cast<size_t>(expected));
+
+    std::thread consumer([&] {
+        std::vector<OrderMsg> batch(64);
+        int got = 0;
+        while (got < expected) {
+            const size_t n = q.popBatch(batch.data(), batch.size());
+            if (n == 0) break;
+            const int64_t t = now_ns();
+            for (size_t i = 0; i < n; ++i) lat.push_back(t - batch[i].price_ticks);
+            got += static_cast<int>(n);
+        }
+    });
+
+    const int64_t t0 = now_ns();
+    std::vector<std::thread> ps;
+    for (int p = 0; p < producers; ++p) {
+        ps.emplace_back([&, p] {
+            OrderMsg m;
+            m.session = static_cast<SessionId>(p);
+            for (int i = 0; i < per; ++i) {
+                m.order_id = i;
+                m.price_ticks = now_ns();   // enqueue timestamp
+                q.push(m);
+            }
+        });
+    }
+    for (auto& t : ps) t.join();
+    consumer.join();
+    const int64_t t1 = now_ns();
+    q.stop();
+
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&](double p) { return lat.empty() ? 0 : lat[static_cast<size_t>(p * (lat.size() - 1))]; };
+    return Result{ expected * 1e3 / static_cast<double>(t1 - t0), pct(0.50), pct(0.99), pct(0.999) };
+}
+
+int main(int argc, char** argv) {
+    int total = 400000;
+    if (argc > 1) total = std::atoi(argv[1]);
+
+    struct Variant { const char* name; QueueKind kind; WaitPolicy wait; };
+    const Variant variants[] = {
+        {"mutex",       QueueKind::Mutex, WaitPolicy::Block},
+        {"mpsc-block",  QueueKind::Mpsc,  WaitPolicy::Block},
+        {"mpsc-yield",  QueueKind::Mpsc,  WaitPolicy::SpinYield},
+        {"mpsc-spin",   QueueKind::Mpsc,  WaitPolicy::Spin},
+    };
+
+    std::printf("%d messages per run; latency = enqueue -> dequeue (ns)\n", total);
+    std::printf("%-11s %4s %9s %9s %9s %10s\n", "queue", "prod", "Mmsg/s", "p50", "p99", "p99.9");
+    for (int producers : {1, 2, 4, 8, 16, 32}) {
+        for (const auto& v : variants) {
+            Result r = run(v.kind, v.wait, producers, total);
+            std::printf("%-11s %4d %9.2f %9lld %9lld %10lld\n", v.name, producers, r.mops,
+                        static_cast<long long>(r.p50), static_cast<long long>(r.p99),
+                        static_cast<long long>(r.p999));
+        }
+    }
+    return 0;
+}
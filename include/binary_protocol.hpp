@@ -0,0 +1,173 @@
+#pragma once
+#include "order_book.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Compact binary order-entry protocol, negotiated per connection: if the
+// first byte a client sends is kBinaryMagic the session is binary, otherwise
+// it is the text protocol. Every message is a packed little-endian struct
+// that starts with BinHeader; 'length' is the size of the whole message.
+// Prices are integer ticks. client_id is an opaque correlation id chosen by
+// the client and echoed on every response to that request.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "binary_protocol.hpp assumes a little-endian host"
+#endif
+
+constexpr uint8_t kBinaryMagic = 0xB7;
+
+enum class BinType : uint8_t {
+    // client -> exchange
+    New      = 0x01,
+    Cancel   = 0x02,
+    Modify   = 0x03,
+    Quit     = 0x04,
+    // exchange -> client
+    Ack      = 0x81,
+    Added    = 0x82,
+    Trade    = 0x83,
+    Canceled = 0x84,
+    Replaced = 0x85,
+    Reject   = 0x86,
+};
+
+enum class BinReject : uint8_t {
+    InvalidOrder   = 1,
+    UnknownOrderId = 2,
+    InvalidReplace = 3,
+    BadMessage     = 4,
+    EngineOffline  = 5,
+};
+
+#pragma pack(push, 1)
+struct BinHeader {
+    uint16_t length;
+    uint8_t  type;
+};
+
+struct BinNew {
+    BinHeader h;
+    uint64_t  client_id;
+    char      symbol[8];     // NUL-padded, all zero = default instrument
+    uint8_t   side;          // 0 = buy, 1 = sell
+    uint32_t  qty;
+    int64_t   price_ticks;
+};
+
+struct BinCancel {
+    BinHeader h;
+    uint64_t  client_id;
+    char      symbol[8];     // NUL-padded, all zero = default instrument
+    int64_t   order_id;
+};
+
+struct BinModify {
+    BinHeader h;
+    uint64_t  client_id;
+    char      symbol[8];     // NUL-padded, all zero = default instrument
+    int64_t   order_id;
+    uint32_t  qty;
+    int64_t   price_ticks;
+};
+
+struct BinQuit {
+    BinHeader h;
+    uint64_t  client_id;
+};
+
+// All responses share this prefix.
+struct BinRespHeader {
+    BinHeader h;
+    uint64_t  client_id;
+    uint64_t  server_ts_ns;   // exchange wall clock, ns since epoch
+};
+
+struct BinAck {
+    BinRespHeader r;
+    int64_t       order_id;   // id assigned to a New, else the id acted on (0 for Quit)
+};
+
+struct BinAdded {
+    BinRespHeader r;
+    int64_t       order_id;
+    uint8_t       side;
+    uint32_t      qty;
+    int64_t       price_ticks;
+};
+
+struct BinTrade {
+    BinRespHeader r;
+    int64_t       resting_id;
+    uint8_t       side;       // aggressor side
+    uint32_t      qty;
+    int64_t       price_ticks;
+};
+
+struct BinCanceled {
+    BinRespHeader r;
+    int64_t       order_id;
+};
+
+struct BinReplaced {
+    BinRespHeader r;
+    int64_t       old_id;
+    int64_t       new_id;
+};
+
+struct BinRejectMsg {
+    BinRespHeader r;
+    int64_t       order_id;
+    uint8_t       reason;     // BinReject
+};
+#pragma pack(pop)
+
+// Fills in the header of a message struct.
+template <class Msg>
+inline void binInit(Msg& m, BinType type) {
+    std::memset(&m, 0, sizeof(m));
+    BinHeader h{static_cast<uint16_t>(sizeof(Msg)), static_cast<uint8_t>(type)};
+    std::memcpy(&m, &h, sizeof(h));
+}
+
+template <class Msg>
+inline void binAppend(std::string& out, const Msg& m) {
+    out.append(reinterpret_cast<const char*>(&m), sizeof(m));
+}
+
+constexpr size_t kBinMaxFrame = 256;
+constexpr size_t kBinBadFrame = SIZE_MAX;
+
+// Length of the complete message at the front of 'buf', 0 if more bytes
+// are needed, or kBinBadFrame if the length field cannot be valid.
+inline size_t binFrameLength(std::string_view buf) {
+    if (buf.size() < sizeof(uint16_t)) return 0;
+    uint16_t len;
+    std::memcpy(&len, buf.data(), sizeof(len));
+    if (len < sizeof(BinHeader) || len > kBinMaxFrame) return kBinBadFrame;
+    return buf.size() >= len ? len : 0;
+}
+
+// Copies a complete frame into Msg if the sizes match exactly.
+template <class Msg>
+inline bool binDecode(std::string_view frame, Msg& m) {
+    if (frame.size() != sizeof(Msg)) return false;
+    std::memcpy(&m, frame.data(), sizeof(Msg));
+    return true;
+}
+
+inline BinType binType(std::string_view frame) {
+    return static_cast<BinType>(static_cast<uint8_t>(frame[2]));
+}
+
+// Appends the binary response for one book event; BestBid/BestAsk are
+// market data and have no order-entry encoding (returns false).
+bool binAppendEvent(std::string& out, const BookEvent& ev, uint64_t client_id, uint64_t ts_ns);
+
+// Appends a response carrying only the common prefix plus an order id.
+void binAppendAck(std::string& out, uint64_t client_id, uint64_t ts_ns, int64_t order_id);
+void binAppendReject(std::string& out, uint64_t client_id, uint64_t ts_ns,
+                     int64_t order_id, BinReject reason);
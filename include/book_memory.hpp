@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+
+// Where one OrderBook's containers (order nodes, id index, price levels) get
+// their memory.
+//   Heap  : global new/delete for every index entry and map level (original)
+//   Arena : one block reserved at construction and carved up by a monotonic
+//           resource. Small blocks (index entries, map levels) are recycled
+//           through per-size free lists, so once the book has warmed up the
+//           matching path makes no global allocations. Past the reserve the
+//           arena grows from the heap in chunks, never per operation.
+// Single-threaded, like the book it belongs to.
+enum class BookAlloc { Heap, Arena };
+
+class BookMemory {
+public:
+    BookMemory(BookAlloc kind, size_t arena_bytes) : kind_(kind) {
+        if (kind == BookAlloc::Heap) { res_ = std::pmr::new_delete_resource(); return; }
+        reserved_ = arena_bytes;
+        buf_.reset(new std::byte[reserved_]);   // untouched pages stay out of RSS
+        arena_.emplace(buf_.get(), reserved_, &overflow_);
+        small_.upstream = &*arena_;
+        res_ = &small_;
+    }
+
+    BookMemory(const BookMemory&) = delete;
+    BookMemory& operator=(const BookMemory&) = delete;
+
+    std::pmr::memory_resource* resource() const { return res_; }
+    BookAlloc kind() const { return kind_; }
+    size_t reserved() const { return reserved_; }
+    // Arena only: bytes taken from the heap after the reserve ran out.
+    size_t overflowBytes() const { return overflow_.bytes; }
+
+private:
+    // Upstream of the arena: the heap, with a tally.
+    struct Overflow : std::pmr::memory_resource {
+        size_t bytes = 0;
+        void* do_allocate(size_t n, size_t align) override {
+            bytes += n;
+            return std::pmr::new_delete_resource()->allocate(n, align);
+        }
+        void do_deallocate(void* p, size_t n, size_t align) override {
+            std::pmr::new_delete_resource()->deallocate(p, n, align);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+    };
+
+    // LIFO free list per 16-byte size class up to kMaxSmall; larger blocks
+    // (bucket arrays, node slabs, dense windows) come straight from the
+    // arena and are only given back when the book is destroyed.
+    struct SmallBlocks : std::pmr::memory_resource {
+        static constexpr size_t kGrain = 16, kMaxSmall = 256;
+        struct Free { Free* next; };
+        std::pmr::memory_resource* upstream = nullptr;
+        Free* free_[kMaxSmall / kGrain] = {};
+
+        static bool small(size_t n, size_t align) { return n <= kMaxSmall && align <= kGrain; }
+        static size_t sizeClass(size_t n) { return n ? (n - 1) / kGrain : 0; }
+
+        void* do_allocate(size_t n, size_t align) override {
+            if (!small(n, align)) return upstream->allocate(n, align);
+            Free*& head = free_[sizeClass(n)];
+            if (Free* f = head) { head = f->next; return f; }
+            return upstream->allocate((sizeClass(n) + 1) * kGrain, kGrain);
+        }
+        void do_deallocate(void* p, size_t n, size_t align) override {
+            if (!small(n, align)) { upstream->deallocate(p, n, align); return; }
+            Free*& head = free_[sizeClass(n)];
+            head = ::new (p) Free{head};
+        }
+        bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+    };
+
+    BookAlloc kind_;
+    size_t reserved_ = 0;
+    std::unique_ptr<std::byte[]> buf_;
+    Overflow overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+    SmallBlocks small_;
+    std::pmr::memory_resource* res_ = nullptr;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include "order_book.hpp"
+#include "symbol.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Parser for the text order-entry commands (client tag already removed):
+//   NEW [SYMBOL] BUY|SELL <qty> @ <price>
+//   CXL [SYMBOL] <order_id>
+//   MOD [SYMBOL] <order_id> <new_qty> @ <new_price>
+//   QUIT
+// Works in place on the line: no allocation, integers through from_chars,
+// and prices read as decimal text straight into integer ticks, so a price is
+// either exact or rejected (never rounded through a double).
+
+enum class CmdType { New, Cancel, Modify, Quit };
+
+enum class CmdStatus {
+    Ok,
+    UnknownCommand,
+    BadSymbol,        // 'bad' = the symbol
+    BadNew,           // wrong shape: usage message
+    BadCancel,
+    BadModify,
+    BadQty,           // 'bad' = the quantity: not an integer in 1..INT32_MAX
+    BadOrderId,       // 'bad' = the id: not an integer in 1..INT64_MAX
+    BadPrice,         // 'bad' = the price: not a positive decimal
+    PriceTooFine,     // more decimals than the tick allows
+    PriceOutOfRange,  // ticks would not fit in int64
+    TrailingInput,    // 'bad' = the first unexpected token
+};
+
+enum class PriceStatus { Ok, Bad, TooFine, OutOfRange };
+
+struct Command {
+    CmdType  type = CmdType::New;
+    SymbolId symbol = kDefaultSymbol;
+    Side     side = Side::Buy;       // NEW
+    int      qty = 0;                // NEW, MOD
+    int64_t  price_ticks = 0;        // NEW, MOD
+    int64_t  order_id = 0;           // CXL, MOD
+};
+
+// Decimal price ("50", "50.25", ".5", "50.250") to ticks of 1/tick_factor.
+// Trailing zeros past the tick are fine; other extra digits are TooFine.
+PriceStatus parsePriceTicks(std::string_view text, int64_t tick_factor, int64_t& ticks);
+
+// Fills 'cmd' on Ok. Otherwise 'bad' points into 'line' at the offending
+// token (empty when the problem is a missing one).
+CmdStatus parseCommand(std::string_view line, int64_t tick_factor, Command& cmd, std::string_view& bad);
+
+// The client-facing "ERROR ..." text for a failed parse (no newline).
+void appendCommandError(CmdStatus st, std::string_view bad, int64_t tick_factor, std::string& out);
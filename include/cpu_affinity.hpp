@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Thread placement for the exchange: CPU pinning and real-time scheduling,
+// applied by each thread to itself as it starts. Linux only; elsewhere
+// placement is reported as unsupported and threads run where they are put.
+
+// "3", "0,2" or "0-3,6" -> CPU numbers in the order given. False on bad
+// syntax or an empty list.
+bool parseCpuList(std::string_view text, std::vector<int>& cpus);
+
+// "0,2,3" (as given; no range folding).
+std::string formatCpuList(const std::vector<int>& cpus);
+
+// CPUs this process may run on.
+std::vector<int> allowedCpus();
+
+struct ThreadPlacement {
+    int cpu = -1;            // -1: left to the scheduler
+    int fifo_priority = 0;   // 1..99: ask for SCHED_FIFO at this priority; 0: SCHED_OTHER
+};
+
+// Names the calling thread (shown by top -H / ps -L; at most 15 chars) and
+// applies 'p' to it. Returns an empty string when everything took effect,
+// otherwise what did not and what the thread runs with instead.
+std::string placeThisThread(const char* name, const ThreadPlacement& p);
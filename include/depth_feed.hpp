@@ -0,0 +1,88 @@
+#pragma once
+#include "md_feed.hpp"
+#include "order_book.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Remembers the top 'depth' levels per side last published for one book and
+// turns the difference to the book's current state into LevelNew / Update /
+// Delete records. A level pushed below the top N is published as a Delete.
+class DepthTracker {
+public:
+    explicit DepthTracker(size_t depth) : depth_(depth) {}
+
+    // Appends one record per changed level; returns how many were added.
+    size_t update(const OrderBook& book, SymbolId symbol, uint64_t ts_ns,
+                  std::vector<MdLevelMsg>& out);
+
+    size_t depth() const { return depth_; }
+
+    // Levels as of the last update(), best first.
+    const std::vector<LevelInfo>& levels(Side side) const { return last_[side == Side::Buy ? 0 : 1]; }
+
+private:
+    size_t depth_;
+    std::vector<LevelInfo> last_[2];
+    std::vector<LevelInfo> cur_;
+};
+
+// SnapshotBegin, one SnapshotLevel per level (bids then asks), SnapshotEnd.
+// The levels are the top 'depth' per side, which SnapshotBegin carries.
+void mdSnapshotRecords(SymbolId symbol, uint64_t ts_ns, uint16_t channel, uint64_t ref_seq,
+                       size_t depth, const std::vector<LevelInfo>& bids, const std::vector<LevelInfo>& asks,
+                       std::vector<MdLevelMsg>& out);
+
+// Latest published depth of every book, written by the engine shards at the
+// end of each batch and read by the snapshot server.
+class DepthCache {
+public:
+    // 'seq' is the last incremental sequence on 'channel' the levels include;
+    // they are the book's top 'depth' per side.
+    void store(SymbolId symbol, uint16_t channel, uint64_t seq, size_t depth,
+               const std::vector<LevelInfo>& bids, const std::vector<LevelInfo>& asks);
+
+    // Snapshot records for one symbol, or for every book if 'all'.
+    // Returns the number of books written.
+    size_t snapshot(bool all, SymbolId symbol, uint64_t ts_ns, std::vector<MdLevelMsg>& out) const;
+
+private:
+    struct Entry {
+        uint16_t channel = 0;
+        uint64_t seq = 0;
+        size_t depth = 0;
+        std::vector<LevelInfo> bids, asks;
+    };
+    mutable std::mutex m_;
+    std::unordered_map<SymbolId, Entry> books_;
+};
+
+// Small TCP service for late or gapped subscribers. A client sends one line,
+// "SNAPSHOT" (every book) or "SNAPSHOT <SYMBOL>" ("-" for the default book),
+// and receives the snapshot records back to back before the server closes
+// the connection. Requests are served one at a time on its own thread.
+class SnapshotServer {
+public:
+    SnapshotServer(uint16_t port, const DepthCache& cache) : port_(port), cache_(cache) {}
+    ~SnapshotServer() { stop(); }
+
+    SnapshotServer(const SnapshotServer&) = delete;
+    SnapshotServer& operator=(const SnapshotServer&) = delete;
+
+    bool start();   // false if the port cannot be bound
+    void stop();
+
+private:
+    void run();
+    void serve(int fd);
+
+    uint16_t port_;
+    const DepthCache& cache_;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thr_;
+};
@@ -1,15 +1,25 @@
 #pragma once
 #include "protocol.hpp"
+#include "mpsc_ring.hpp"
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
 
-// Thread-safe bounded queue for OrderMsg.
-// Blocking push/pop with a stop() to wake all waiters and drain.
+// Backend behind OrderQueue.
+//   Mutex : std::queue guarded by a mutex and two condvars (original)
+//   Mpsc  : lock-free bounded MPSC ring; the engine waits per WaitPolicy
+enum class QueueKind { Mutex, Mpsc };
+
+// Thread-safe bounded queue for OrderMsg: many network threads push,
+// one engine thread pops. Blocking push/pop with a stop() to wake all
+// waiters and drain.
 class OrderQueue {
 public:
-    explicit OrderQueue(size_t capacity);
+    explicit OrderQueue(size_t capacity,
+                        QueueKind kind = QueueKind::Mutex,
+                        WaitPolicy wait = WaitPolicy::Block);
 
     // Blocking push; returns false if queue is stopping.
     bool push(const OrderMsg& msg);
@@ -17,13 +27,19 @@ public:
     // Blocking pop; returns empty optional when stopped and drained.
     std::optional<OrderMsg> pop();
 
+    // Waits for at least one message, then takes up to 'max' without waiting.
+    // Returns 0 when stopped and drained.
+    size_t popBatch(OrderMsg* out, size_t max);
+
     // Request shutdown and wake all waiters.
     void stop();
 
 private:
     size_t capacity_;
+    std::unique_ptr<MpscRing<OrderMsg>> ring_;   // set for QueueKind::Mpsc
+
     std::queue<OrderMsg> q_;
     std::mutex m_;
     std::condition_variable cv_not_empty_, cv_not_full_;
     bool stop_ = false;
-};
\ No newline at end of file
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include "order_book.hpp"
+#include "symbol.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Write-ahead journal of the engine's input. Every New / Cancel / Modify an
+// engine shard processes is appended, before it touches a book, as one
+// fixed-size record in a preallocated, memory-mapped file. Replaying the
+// records in order through fresh books rebuilds every book exactly.
+//
+// File layout: a 4096-byte header page, then 64-byte records. Space past
+// the last record is zero. Shards take slots from one counter but write and
+// sync them on their own schedules, so a crash can leave a slot unwritten
+// below records another shard has already made durable and acknowledged.
+// Recovery therefore checks every record on its own (sequence number and
+// checksum), skips bad ones, and stops only after kJournalMaxGap bad slots
+// in a row.
+
+constexpr char     kJournalMagic[8] = {'T', 'S', 'J', 'R', 'N', 'L', '0', '1'};
+constexpr size_t   kJournalHeaderBytes = 4096;
+constexpr size_t   kJournalMaxGap = 65536;   // records; far above shards x batch in flight
+
+enum class JournalOp : uint8_t { New = 1, Cancel = 2, Modify = 3 };
+
+#pragma pack(push, 1)
+struct JournalHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;     // records the file has room for
+};
+
+struct JournalRecord {
+    uint8_t  op;           // JournalOp
+    uint8_t  side;         // 0 buy, 1 sell (New)
+    uint16_t shard;        // engine shard that processed it
+    uint32_t qty;          // New / Modify
+    uint64_t seq;          // 1-based position in the file
+    uint64_t ts_ns;        // wall clock when the engine journaled it
+    SymbolId symbol;
+    int64_t  price_ticks;  // New / Modify
+    int64_t  order_id;     // New: assigned id; Cancel / Modify: subject id
+    uint8_t  reserved[12];
+    uint32_t check;        // FNV-1a of the bytes above
+};
+#pragma pack(pop)
+
+static_assert(sizeof(JournalRecord) == 64, "journal records are one cache line");
+
+// How far an appended record is pushed towards the disk.
+enum class JournalSync {
+    None,       // page cache only: survives a process crash, not a power loss
+    Periodic,   // a background thread msyncs every interval
+    Batch,      // group commit: the engine msyncs its records at the end of each batch
+};
+
+uint32_t journalChecksum(const JournalRecord& r);
+
+// Applies one record to a book (the same call the engine made live).
+void journalApply(OrderBook& book, const JournalRecord& r, BookEvents& out);
+
+class Journal {
+public:
+    Journal() = default;
+    ~Journal() { close(); }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Opens 'path', creating and preallocating it for 'capacity' records if
+    // it does not exist. Records already in the file are kept; new ones are
+    // appended after them.
+    bool open(const std::string& path, size_t capacity, JournalSync sync,
+              uint64_t sync_interval_ns = 10000000);
+    // Opens an existing journal for reading only.
+    bool openReadOnly(const std::string& path);
+    void close();
+
+    bool isOpen() const { return base_ != nullptr; }
+    size_t capacity() const { return capacity_; }
+    JournalSync sync() const { return sync_; }
+
+    // Valid records found when the file was opened, in file order (holes
+    // skipped), valid for reading at any time.
+    size_t recovered() const { return valid_.size(); }
+    const JournalRecord& record(size_t i) const { return records_[valid_[i]]; }
+
+    // Fills in seq and check and appends. Thread-safe. Returns the record's
+    // seq, or 0 if the file is full.
+    uint64_t append(JournalRecord r);
+    // Batch mode: makes records [first_seq, last_seq] durable (msync). No-op otherwise.
+    void commit(uint64_t first_seq, uint64_t last_seq);
+
+    uint64_t appended() const { return next_.load(std::memory_order_relaxed) - end_; }
+    uint64_t syncs() const { return syncs_.load(std::memory_order_relaxed); }
+
+private:
+    bool map(int fd, size_t bytes, bool writable);
+    void syncRange(size_t first, size_t end);   // record indices
+    void syncLoop();
+
+    int      fd_ = -1;
+    char*    base_ = nullptr;
+    size_t   bytes_ = 0;
+    JournalRecord* records_ = nullptr;
+    size_t   capacity_ = 0;
+    std::vector<size_t> valid_;   // indices of the records recovered at open
+    size_t   end_ = 0;            // one past the last recovered record
+    JournalSync sync_ = JournalSync::None;
+    uint64_t sync_interval_ns_ = 0;
+
+    std::atomic<uint64_t> next_{0};      // records reserved
+    std::atomic<uint64_t> syncs_{0};
+    bool stop_ = false;
+    std::mutex stop_m_;
+    std::condition_variable stop_cv_;
+    std::thread syncer_;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// HDR-style latency histogram: values below 256 are counted exactly, larger
+// ones in 128 log-linear sub-buckets per power of two, so every reported
+// value is within 1/128 (0.8%) of the true one across the whole 64-bit range.
+// Recording is a few instructions and never allocates; per-thread histograms
+// are combined with merge().
+class LatencyHistogram {
+public:
+    static constexpr int    kSubBits = 7;
+    static constexpr size_t kSub     = size_t{1} << kSubBits;          // 128
+    static constexpr size_t kBuckets = 2 * kSub + (64 - kSubBits - 1) * kSub;
+
+    LatencyHistogram() : counts_(kBuckets, 0) {}
+
+    void record(uint64_t v) {
+        ++counts_[index(v)];
+        ++count_;
+        sum_ += static_cast<double>(v);
+        if (v < min_) min_ = v;
+        if (v > max_) max_ = v;
+    }
+    void merge(const LatencyHistogram& o);
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t min()   const { return count_ ? min_ : 0; }
+    uint64_t max()   const { return max_; }
+    double   mean()  const { return count_ ? sum_ / static_cast<double>(count_) : 0.0; }
+
+    // Highest value equivalent to the sample at percentile p (0..100],
+    // clamped to the largest value recorded.
+    uint64_t percentile(double p) const;
+
+    // Full distribution in HdrHistogram's percentile-output (.hgrm) layout,
+    // one row per non-empty bucket, values divided by 'unit' (e.g. 1000 for
+    // ns recorded, us written). Loads in the HdrHistogram plotter.
+    void writePercentiles(std::ostream& out, double unit = 1.0) const;
+
+    static size_t index(uint64_t v) {
+        if (v < 2 * kSub) return static_cast<size_t>(v);
+        const int shift = 63 - __builtin_clzll(v) - kSubBits;   // >= 1
+        return 2 * kSub + static_cast<size_t>(shift - 1) * kSub + static_cast<size_t>((v >> shift) - kSub);
+    }
+    // Largest value that lands in bucket i.
+    static uint64_t highest(size_t i) {
+        if (i < 2 * kSub) return i;
+        const size_t shift = (i - 2 * kSub) / kSub + 1;
+        const uint64_t top = kSub + (i - 2 * kSub) % kSub;
+        return ((top + 1) << shift) - 1;
+    }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    double   sum_ = 0.0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+// Per-connection receive buffer for the '\n'-framed text protocol.
+// Reads large chunks from the socket and yields complete lines as views into
+// the buffer (no copy, '\n' stripped). A view stays valid until the next
+// call that reads from the socket (readLine / fill). pending()/consume()
+// expose the raw bytes for length-prefixed (binary) framing.
+class LineReader {
+public:
+    enum class Status {
+        Line,     // 'line' holds the next complete line
+        Again,    // no complete line yet and the socket would block / timed out
+        Closed,   // peer closed the connection
+        Error,    // recv failed (errno is preserved)
+        TooLong   // a line exceeded max_line bytes without a '\n'
+    };
+
+    explicit LineReader(size_t max_line = 8192, size_t chunk = 16384);
+
+    // Returns the next buffered line, reading from fd only when no complete
+    // line is buffered. Blocks according to the socket's mode / SO_RCVTIMEO,
+    // or never if recv_flags contains MSG_DONTWAIT.
+    Status readLine(int fd, std::string_view& line, int recv_flags = 0);
+
+    // Event-loop style: one recv() into the buffer. Returns bytes read,
+    // 0 on EOF, -1 on error / would-block (check errno).
+    ssize_t fill(int fd, int recv_flags = 0);
+
+    // Next complete line already in the buffer; false if none.
+    bool nextLine(std::string_view& line);
+
+    // Raw unconsumed bytes, and dropping n of them from the front.
+    std::string_view pending() const { return std::string_view(buf_.data() + begin_, end_ - begin_); }
+    void consume(size_t n) { begin_ += n; if (scan_ < begin_) scan_ = begin_; }
+
+    // True when the unterminated tail is longer than max_line.
+    bool overflow() const { return end_ - begin_ > max_line_; }
+
+    size_t   buffered()  const { return end_ - begin_; }
+    uint64_t recvCalls() const { return recv_calls_; }
+
+private:
+    size_t max_line_;
+    size_t chunk_;
+    std::vector<char> buf_;
+    size_t begin_ = 0;   // start of the first unconsumed line
+    size_t scan_  = 0;   // resume point for the '\n' search (>= begin_)
+    size_t end_   = 0;   // one past the last valid byte
+    uint64_t recv_calls_ = 0;
+};
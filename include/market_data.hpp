@@ -1,7 +1,12 @@
 #pragma once
+#include "md_feed.hpp"
+
+#include <atomic>
 #include <string>
 #include <cstdint>
+#include <vector>
 #include <arpa/inet.h>
+#include <sys/uio.h>
 
 class MarketDataPublisher {
 public:
@@ -12,10 +17,54 @@ public:
     // Sends one datagram containing 'line' (no extra '\n' added).
     void sendLine(const std::string& line) const;
 
+    // Sends n datagrams with as few syscalls as possible (sendmmsg on Linux).
+    void sendDatagrams(const struct iovec* dgrams, size_t n) const;
+
     bool enabled() const { return enabled_; }
 
+    // Totals over the publisher's lifetime, all threads.
+    uint64_t datagramsSent() const { return datagrams_.load(std::memory_order_relaxed); }
+    uint64_t bytesSent()     const { return bytes_.load(std::memory_order_relaxed); }
+
 private:
     int sock_ = -1;
     bool enabled_ = false;
     struct sockaddr_in dest_{};
-};
\ No newline at end of file
+    mutable std::atomic<uint64_t> datagrams_{0};
+    mutable std::atomic<uint64_t> bytes_{0};
+};
+
+// One sequenced binary channel (see md_feed.hpp), owned by a single engine
+// thread. Messages are packed into MTU-sized datagrams; flush() sends every
+// pending datagram in one batch. publish() flushes on its own once the
+// buffer is full or the oldest pending message is older than flush_ns.
+class MdChannel {
+public:
+    MdChannel(const MarketDataPublisher& pub, uint16_t channel, uint64_t flush_ns);
+
+    void publish(const BookEvent& ev, SymbolId symbol, uint64_t ts_ns);
+    void publish(const MdLevelMsg& rec);
+    // Leaves the next n sequence numbers unused: records lost before they
+    // reached the channel show up as a gap, as if UDP had dropped them.
+    void skip(uint64_t n) { next_seq_ += n; }
+    void flush();
+
+    uint64_t nextSeq() const { return next_seq_; }
+
+private:
+    static constexpr size_t kMaxDatagrams = 16;   // per flush
+
+    void append(const void* rec, uint64_t ts_ns);   // one MdMsg-sized record
+
+    MdPacketHeader* header(size_t d) {
+        return reinterpret_cast<MdPacketHeader*>(buf_.data() + d * kMdMaxDatagram);
+    }
+
+    const MarketDataPublisher& pub_;
+    const uint16_t channel_;
+    const uint64_t flush_ns_;
+    uint64_t next_seq_ = 1;
+    uint64_t oldest_ts_ = 0;
+    std::vector<char> buf_;     // kMaxDatagrams slots of kMdMaxDatagram bytes
+    size_t dgrams_ = 0;         // slots in use; the last one may be partial
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include "order_book.hpp"
+#include "symbol.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Binary market-data feed. Each datagram is an MdPacketHeader followed by
+// 'count' fixed-size MdMsg records. Every engine shard publishes on its own
+// channel; message i of a datagram has sequence number first_seq + i, and
+// sequences on a channel start at 1 and never skip, so a subscriber detects
+// loss by comparing first_seq with the next sequence it expected.
+// Little-endian, like the binary order-entry protocol.
+
+constexpr uint8_t kMdMagic   = 0xB7;   // never the first byte of a text line
+constexpr uint8_t kMdVersion = 1;
+
+// Payload budget per datagram: a 1500-byte Ethernet MTU minus IPv4 + UDP headers.
+constexpr size_t kMdMaxDatagram = 1472;
+
+#pragma pack(push, 1)
+struct MdPacketHeader {
+    uint8_t  magic;
+    uint8_t  version;
+    uint16_t channel;
+    uint16_t count;
+    uint16_t reserved;
+    uint64_t first_seq;
+};
+
+struct MdMsg {
+    uint8_t  type;          // BookEventType
+    uint8_t  side;          // 0 = buy, 1 = sell
+    uint16_t reserved;
+    uint32_t qty;           // BestBid / BestAsk level totals saturate at UINT32_MAX
+    uint64_t ts_ns;         // engine wall clock when the event was produced
+    SymbolId symbol;
+    int64_t  price_ticks;
+    int64_t  order_id;
+    int64_t  new_id;        // Replaced only
+};
+
+// Depth-of-book records share MdMsg's size and leading type byte.
+//   LevelNew / LevelUpdate / LevelDelete : one price level among the top N
+//     changed; qty and count are the level's new totals (0 for Delete).
+//   SnapshotBegin : the book's top 'qty' levels per side (the feed's depth N,
+//     the same levels the increments describe) follow in 'count'
+//     SnapshotLevel records and a SnapshotEnd; it includes every increment on
+//     incremental channel 'channel' up to and including sequence 'ref_seq'.
+//     A side with N levels may have more below them.
+enum class MdType : uint8_t {
+    LevelNew      = 0x10,
+    LevelUpdate   = 0x11,
+    LevelDelete   = 0x12,
+    SnapshotBegin = 0x20,
+    SnapshotLevel = 0x21,
+    SnapshotEnd   = 0x22,
+};
+
+struct MdLevelMsg {
+    uint8_t  type;          // MdType
+    uint8_t  side;          // 0 = bid, 1 = ask
+    uint16_t channel;       // SnapshotBegin only
+    uint32_t count;         // orders at the level (SnapshotBegin: records that follow)
+    uint64_t ts_ns;
+    SymbolId symbol;
+    int64_t  price_ticks;
+    int64_t  qty;           // total quantity at the level (SnapshotBegin: depth N)
+    uint64_t ref_seq;       // SnapshotBegin only
+};
+#pragma pack(pop)
+
+static_assert(sizeof(MdPacketHeader) == 16, "MdPacketHeader layout");
+static_assert(sizeof(MdMsg) == 48, "MdMsg layout");
+static_assert(sizeof(MdLevelMsg) == sizeof(MdMsg), "one record size per feed");
+
+// Snapshots for shard channel c are published on channel c | kMdSnapshotChannel.
+constexpr uint16_t kMdSnapshotChannel = 0x8000;
+
+inline bool mdIsLevelRecord(uint8_t type) { return type >= static_cast<uint8_t>(MdType::LevelNew); }
+
+constexpr size_t kMdMsgsPerDatagram = (kMdMaxDatagram - sizeof(MdPacketHeader)) / sizeof(MdMsg);
+
+// Rejects are replies to one client, not market data.
+inline bool mdPublishes(BookEventType t) { return t != BookEventType::Reject; }
+
+inline MdMsg mdEncode(const BookEvent& ev, SymbolId symbol, uint64_t ts_ns) {
+    MdMsg m;
+    std::memset(&m, 0, sizeof(m));
+    m.type        = static_cast<uint8_t>(ev.type);
+    m.side        = ev.side == Side::Buy ? 0 : 1;
+    m.qty         = static_cast<uint32_t>(std::min<int64_t>(ev.qty, UINT32_MAX));
+    m.ts_ns       = ts_ns;
+    m.symbol      = symbol;
+    m.price_ticks = ev.price_ticks;
+    m.order_id    = ev.order_id;
+    m.new_id      = ev.new_id;
+    return m;
+}
+
+inline BookEvent mdDecode(const MdMsg& m) {
+    BookEvent ev;
+    ev.type        = static_cast<BookEventType>(m.type);
+    ev.side        = m.side == 0 ? Side::Buy : Side::Sell;
+    ev.qty         = m.qty;
+    ev.price_ticks = m.price_ticks;
+    ev.order_id    = m.order_id;
+    ev.new_id      = m.new_id;
+    return ev;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "market_data.hpp"
+#include "spsc_ring.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// One market-data item produced by an engine shard. Serialization (text or
+// binary), batching and sending happen in MdWriter, on whichever thread
+// owns it. The engine numbers the items of each binary channel as it posts
+// them, dropped ones included, so the writer can tell what never arrived.
+struct MdItem {
+    enum class Kind : uint8_t {
+        Event,      // 'ev' for 'symbol' at 'ts_ns'
+        Level,      // depth record for the incremental channel
+        Snapshot,   // record for the snapshot channel
+        Flush,      // end of an engine batch
+    };
+    Kind       kind = Kind::Event;
+    SymbolId   symbol = kDefaultSymbol;
+    uint64_t   ts_ns = 0;
+    uint64_t   seq = 0;   // Event / Level: feed channel; Snapshot: snapshot channel
+    BookEvent  ev;
+    MdLevelMsg rec;
+};
+
+struct MdWriterConfig {
+    bool     binary = false;         // binary feed, else one text line per datagram
+    uint64_t flush_ns = 100000;      // binary: max age of a batched message
+    uint64_t conflate_ns = 0;        // >0: send only the latest BBO per symbol per interval
+    PriceFormat price;               // text feed prices
+};
+
+// Serializes and sends one shard's market data. Single-threaded.
+class MdWriter {
+public:
+    MdWriter(const MarketDataPublisher& pub, uint16_t shard, const MdWriterConfig& cfg);
+
+    void handle(const MdItem& item);
+    // Sends batched datagrams, and the conflated BBOs once their interval is up.
+    void flush(uint64_t now_ns);
+
+    uint64_t conflated() const { return conflated_; }
+
+private:
+    struct Bbo {
+        BookEvent ev[2];   // BestBid, BestAsk
+        uint64_t  ts[2] = {0, 0};
+        bool      pending[2] = {false, false};
+    };
+
+    void publish(const BookEvent& ev, SymbolId symbol, uint64_t ts_ns);
+    // Turns items missing before 'seq' into a gap on 'ch'.
+    static void sequence(MdChannel& ch, uint64_t& last, uint64_t seq);
+
+    const MarketDataPublisher& pub_;
+    MdWriterConfig cfg_;
+    MdChannel feed_, snapshots_;
+    std::unordered_map<SymbolId, Bbo> bbo_;
+    uint64_t feed_in_ = 0, snap_in_ = 0;   // last item seq seen per channel
+    bool     bbo_pending_ = false;
+    uint64_t window_start_ = 0;
+    uint64_t conflated_ = 0;
+    std::string line_;   // text feed line, reused
+};
+
+// Dedicated publisher thread. Each engine shard posts MdItems into its own
+// SPSC ring and never waits: when a ring is full the item is dropped and
+// counted, and on the binary feed its sequence number goes unused, so
+// subscribers see the loss as a gap and recover from a snapshot. The
+// thread drains every ring into that shard's MdWriter.
+class MdPublisherThread {
+public:
+    MdPublisherThread(const MarketDataPublisher& pub, size_t shards, const MdWriterConfig& cfg,
+                      size_t ring_capacity = 65536);
+    ~MdPublisherThread() { stop(); }
+
+    MdPublisherThread(const MdPublisherThread&) = delete;
+    MdPublisherThread& operator=(const MdPublisherThread&) = delete;
+
+    // Called only from the engine thread of 'shard'.
+    bool post(size_t shard, const MdItem& item) {
+        if (rings_[shard]->tryPush(item)) return true;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void start(std::function<void()> on_start = nullptr);   // 'on_start' runs first on the thread
+    void stop();   // drains what was posted, then joins
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t conflated() const;   // valid after stop()
+
+private:
+    void run();
+
+    std::vector<std::unique_ptr<SpscRing<MdItem>>> rings_;
+    std::vector<std::unique_ptr<MdWriter>> writers_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thr_;
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// How the single consumer waits when the ring is empty.
+//   Spin      : busy-poll (lowest latency, burns a core)
+//   SpinYield : poll, then std::this_thread::yield() between polls
+//   Block     : poll briefly, then sleep on a condvar until a producer signals
+enum class WaitPolicy { Spin, SpinYield, Block };
+
+constexpr size_t kCacheLine = 64;
+
+// Bounded lock-free multi-producer / single-consumer ring.
+// Each slot carries a sequence number (Vyukov's scheme): producers claim a
+// slot with one CAS on tail_, the consumer owns head_ outright. Producers
+// spin-then-yield while the ring is full.
+template <class T>
+class MpscRing {
+public:
+    MpscRing(size_t capacity, WaitPolicy wait)
+    : mask_(roundPow2(capacity) - 1), slots_(new Slot[mask_ + 1]), wait_(wait) {
+        for (size_t i = 0; i <= mask_; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Non-blocking; false if full or stopping.
+    bool tryPush(const T& v) {
+        if (stop_.load(std::memory_order_relaxed)) return false;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* s;
+        while (true) {
+            s = &slots_[pos & mask_];
+            const size_t seq = s->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        s->value = v;
+        s->seq.store(pos + 1, std::memory_order_release);
+        if (wait_ == WaitPolicy::Block) wakeConsumer();
+        return true;
+    }
+
+    // Waits while full; false if stopping.
+    bool push(const T& v) {
+        for (unsigned spins = 0; !tryPush(v); ++spins) {
+            if (stop_.load(std::memory_order_relaxed)) return false;
+            if (spins > 64) std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // Waits per policy; empty optional once stopped and drained.
+    std::optional<T> pop() {
+        T v;
+        if (popBatch(&v, 1) == 0) return std::nullopt;
+        return v;
+    }
+
+    // Waits for at least one item, then takes up to 'max' without waiting.
+    // Returns 0 once stopped and drained.
+    size_t popBatch(T* out, size_t max) {
+        while (true) {
+            size_t n = drain(out, max);
+            if (n) return n;
+            if (stop_.load(std::memory_order_acquire)) {
+                n = drain(out, max);  // items published before stop()
+                return n;
+            }
+            waitNonEmpty();
+        }
+    }
+
+    void stop() {
+        stop_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lk(m_);
+        cv_.notify_all();
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct alignas(kCacheLine) Slot {
+        std::atomic<size_t> seq{0};
+        T value{};
+    };
+
+    static size_t roundPow2(size_t v) {
+        size_t p = 2;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    bool ready() const {
+        return slots_[head_ & mask_].seq.load(std::memory_order_acquire) == head_ + 1;
+    }
+
+    size_t drain(T* out, size_t max) {
+        size_t n = 0;
+        while (n < max && ready()) {
+            Slot& s = slots_[head_ & mask_];
+            out[n++] = s.value;
+            s.seq.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+        }
+        return n;
+    }
+
+    void waitNonEmpty() {
+        if (wait_ == WaitPolicy::Spin) return;
+        if (wait_ == WaitPolicy::SpinYield) { std::this_thread::yield(); return; }
+
+        for (int i = 0; i < 256; ++i) if (ready()) return;
+        std::unique_lock<std::mutex> lk(m_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);  // pairs with wakeConsumer()
+        if (!ready() && !stop_.load(std::memory_order_acquire))
+            cv_.wait_for(lk, std::chrono::milliseconds(100));
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    void wakeConsumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lk(m_);
+            cv_.notify_one();
+        }
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    const WaitPolicy wait_;
+
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};   // producers
+    alignas(kCacheLine) size_t head_ = 0;               // consumer only
+    alignas(kCacheLine) std::atomic<bool> stop_{false};
+    std::atomic<bool> sleeping_{false};
+    std::mutex m_;
+    std::condition_variable cv_;
+};
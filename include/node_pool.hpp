@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Slab allocator for fixed-size nodes. Free nodes are chained through the
+// node's own 'next' pointer, so acquire/release are O(1) and never touch the
+// heap once enough slabs exist. Slabs are never freed or moved, so node
+// addresses stay stable for the pool's lifetime. Slabs come from 'mem'.
+template <class Node>
+class NodePool {
+    static_assert(std::is_trivially_destructible_v<Node>, "slabs are released without running destructors");
+
+public:
+    explicit NodePool(size_t initial_capacity, size_t slab_size = 4096,
+                      std::pmr::memory_resource* mem = std::pmr::get_default_resource())
+    : mem_(mem), slab_size_(slab_size ? slab_size : 1), slabs_(mem) {
+        if (initial_capacity) addSlab(initial_capacity);
+    }
+    ~NodePool() {
+        for (const Slab& s : slabs_) mem_->deallocate(s.nodes, s.size * sizeof(Node), alignof(Node));
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // Returns an uninitialised-but-constructed node; grows by one slab when empty.
+    Node* acquire() {
+        if (!free_) addSlab(slab_size_);
+        Node* n = free_;
+        free_ = n->next;
+        if (++in_use_ > high_water_) high_water_ = in_use_;
+        return n;
+    }
+
+    void release(Node* n) {
+        n->next = free_;
+        free_ = n;
+        --in_use_;
+    }
+
+    // Returns every node to the free list (keeps all slabs).
+    void reset() {
+        free_ = nullptr;
+        for (size_t s = slabs_.size(); s-- > 0;) threadSlab(slabs_[s].nodes, slabs_[s].size);
+        in_use_ = 0;
+    }
+
+    size_t capacity()  const { return capacity_; }
+    size_t inUse()     const { return in_use_; }
+    size_t highWater() const { return high_water_; }
+
+private:
+    struct Slab { Node* nodes; size_t size; };
+
+    void addSlab(size_t n) {
+        Node* nodes = static_cast<Node*>(mem_->allocate(n * sizeof(Node), alignof(Node)));
+        for (size_t i = 0; i < n; ++i) new (&nodes[i]) Node();
+        slabs_.push_back(Slab{nodes, n});
+        threadSlab(nodes, n);
+        capacity_ += n;
+    }
+
+    void threadSlab(Node* slab, size_t n) {
+        for (size_t i = n; i-- > 0;) {
+            slab[i].next = free_;
+            free_ = &slab[i];
+        }
+    }
+
+    std::pmr::memory_resource* mem_;
+    size_t slab_size_;
+    std::pmr::vector<Slab> slabs_;
+    Node*  free_ = nullptr;
+    size_t capacity_ = 0;
+    size_t in_use_ = 0;
+    size_t high_water_ = 0;
+};
@@ -1,25 +1,130 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <functional>
-#include <map>
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include <utility>
 
+#include "book_memory.hpp"
+#include "node_pool.hpp"
+#include "order_index.hpp"
+#include "price_ladder.hpp"
+#include "price_format.hpp"
+
 enum class Side { Buy, Sell };
 
-// FIFO per price level
-struct RestingOrder {
-    int64_t id; // unique order id
-    int     qty;
+// Resting order, pooled and linked into its price level's FIFO.
+struct OrderNode {
+    int64_t    id{0};          // unique order id
+    int64_t    price_ticks{0};
+    int        qty{0};
+    Side       side{Side::Buy};
+    OrderNode* prev{nullptr};
+    OrderNode* next{nullptr};  // also the pool's free-list link
+};
+
+// Intrusive doubly linked FIFO of orders at one price, with running totals
+// kept in step on every add / fill / unlink.
+struct OrderLevel {
+    OrderNode* head{nullptr};
+    OrderNode* tail{nullptr};
+    int64_t    qty{0};     // sum of resting qty
+    int        count{0};   // number of resting orders
+
+    bool empty() const { return head == nullptr; }
+    void clear() { head = tail = nullptr; qty = 0; count = 0; }
+
+    void push_back(OrderNode* n) {
+        n->prev = tail;
+        n->next = nullptr;
+        if (tail) tail->next = n; else head = n;
+        tail = n;
+        qty += n->qty;
+        ++count;
+    }
+
+    void unlink(OrderNode* n) {
+        if (n->prev) n->prev->next = n->next; else head = n->next;
+        if (n->next) n->next->prev = n->prev; else tail = n->prev;
+        n->prev = n->next = nullptr;
+        qty -= n->qty;
+        --count;
+    }
+
+    // Partial fill of a resting order in this level.
+    void reduce(OrderNode* n, int by) {
+        n->qty -= by;
+        qty    -= by;
+    }
+};
+
+// Aggregate view of one price level.
+struct LevelInfo {
+    int64_t price_ticks{0};
+    int64_t qty{0};
+    int     count{0};
+};
+
+// Typed book output. Everything is integer ticks/quantities; text is rendered
+// by the caller (see formatEvent) only where it is actually needed.
+enum class BookEventType { Added, Trade, Canceled, Replaced, BestBid, BestAsk, Reject };
+
+enum class RejectReason { InvalidOrder, InvalidSeed, UnknownOrderId, CancelFailed, InvalidReplace, JournalFull };
+
+struct BookEvent {
+    BookEventType type{BookEventType::Added};
+    Side          side{Side::Buy};   // Added: resting side; Trade: aggressor side
+    int64_t       qty{0};            // Added / Trade / BestBid / BestAsk (level total)
+    int64_t       price_ticks{0};    // Added / Trade / BestBid / BestAsk
+    int64_t       order_id{0};       // Added: new id; Trade: resting id; Canceled / Replaced / Reject: subject id
+    int64_t       new_id{0};         // Replaced only
+    RejectReason  reason{RejectReason::InvalidOrder};
+};
+
+// Caller-owned event buffer. The book only appends, so a buffer that is
+// cleared and reused between calls stops allocating once it has warmed up.
+using BookEvents = std::vector<BookEvent>;
+
+// Render one event as its wire line (no trailing '\n').
+std::string formatEvent(const BookEvent& ev, const std::function<std::string(int64_t)>& fmt_price);
+
+// Same line appended to 'out': no temporaries, so a reused buffer stops
+// allocating once it has grown.
+void appendEvent(std::string& out, const BookEvent& ev, const PriceFormat& px);
+
+// Construction-time book options.
+struct BookConfig {
+    LadderKind ladder     = LadderKind::Map;
+    int64_t    dense_span = 4096;   // ticks per side held in the dense window
+    size_t     pool_capacity = 65536; // resting orders preallocated (grows by slabs)
+    BookAlloc  alloc = BookAlloc::Arena;
+    size_t     arena_bytes = 0;       // Arena: bytes reserved up front (0: arenaEstimate())
 };
 
+// Arena reserve for a book: its order nodes and id index at pool_capacity,
+// the dense window, and room for sparse levels and the pools' chunk growth.
+size_t arenaEstimate(const BookConfig& cfg);
+
 class OrderBook {
 public:
+    explicit OrderBook(const BookConfig& cfg = BookConfig{});
+
     void clear();
 
+    // ---- Event API: appends typed events to 'out' (never clears it) ----
+
+    // Add resting liquidity without matching (admin/seed path)
+    void seed(Side side, int qty, int64_t price_ticks, int64_t order_id, BookEvents& out);
+
+    void processOrder(Side side, int qty, int64_t price_ticks, int64_t order_id, BookEvents& out);
+
+    void cancel(int64_t order_id, BookEvents& out);
+
+    void replace(int64_t old_id, int new_qty, int64_t new_price_ticks, int64_t new_id, BookEvents& out);
+
+    // ---- String API: thin adapters over the event API ----
+
     // Add resting liquidity without matching (admin/seed path)
     std::vector<std::string> seed(Side side,
                                   int qty,
@@ -47,31 +152,45 @@ public:
     // Diagnostics (engine thread owns the book)
     bool    hasBestBid()   const { return !bids_.empty(); }
     bool    hasBestAsk()   const { return !asks_.empty(); }
-    int64_t bestBidTicks() const { return bids_.empty() ? 0 : bids_.begin()->first; }
-    int     bestBidQty()   const { return bids_.empty() ? 0 : levelQty(bids_.begin()->second); }
-    int64_t bestAskTicks() const { return asks_.empty() ? 0 : asks_.begin()->first; }
-    int     bestAskQty()   const { return asks_.empty() ? 0 : levelQty(asks_.begin()->second); }
+    int64_t bestBidTicks() const { return bids_.empty() ? 0 : bids_.bestPrice(); }
+    int64_t bestBidQty()   const { return bids_.empty() ? 0 : bids_.find(bids_.bestPrice())->qty; }
+    int64_t bestAskTicks() const { return asks_.empty() ? 0 : asks_.bestPrice(); }
+    int64_t bestAskQty()   const { return asks_.empty() ? 0 : asks_.find(asks_.bestPrice())->qty; }
+
+    // Depth queries read per-level totals, so no orders are scanned, but they
+    // walk the occupied levels best-first: depthAt is O(level), depth is
+    // O(max_levels). Level 0 is the touch; depthAt returns false if the side
+    // has fewer levels.
+    size_t depthLevels(Side side) const { return ladder(side).levels(); }
+    bool   depthAt(Side side, size_t level, LevelInfo& out) const;
+    // Appends up to 'max_levels' levels best-first; returns how many were added.
+    size_t depth(Side side, size_t max_levels, std::vector<LevelInfo>& out) const;
+
+    // Order pool usage
+    size_t restingOrders() const { return pool_.inUse(); }
+    size_t poolCapacity()  const { return pool_.capacity(); }
+    size_t poolHighWater() const { return pool_.highWater(); }
+    const BookMemory& memory() const { return mem_; }
 
 private:
-    using Level = std::deque<RestingOrder>;
+    using Level  = OrderLevel;
+    using Ladder = PriceLadder<Level>;
 
-    static int levelQty(const Level& lvl) {
-        int sum = 0;
-        for (const auto& ro : lvl) sum += ro.qty;
-        return sum;
-    }
+    const Ladder& ladder(Side side) const { return side == Side::Buy ? bids_ : asks_; }
+
+    void refreshSnapshots(BookEvents& out) const;
 
-    void refreshSnapshots(std::vector<std::string>& out,
-                          const std::function<std::string(int64_t)>& fmt_price) const;
+    OrderNode* rest(Side side, int qty, int64_t price_ticks, int64_t order_id);
+    void       removeResting(OrderNode* n);
 
-    // Distinct helpers to avoid overload ambiguity
-    bool eraseFromBidsLevel(std::map<int64_t, Level, std::greater<int64_t>>::iterator lvl_it, int64_t id);
-    bool eraseFromAsksLevel(std::map<int64_t, Level>::iterator lvl_it, int64_t id);
+    BookMemory mem_;   // first member: outlives every container below
 
-    // Index of id -> (side, price_ticks)
-    std::unordered_map<int64_t, std::pair<Side,int64_t>> index_;
+    NodePool<OrderNode> pool_;
+
+    // Index of id -> resting node
+    OrderIndex<OrderNode> index_;
 
     // Price → FIFO of orders; bids highest-first, asks lowest-first
-    std::map<int64_t, Level, std::greater<int64_t>> bids_;
-    std::map<int64_t, Level>                        asks_;
-};
\ No newline at end of file
+    Ladder bids_;
+    Ladder asks_;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include "order_book.hpp"
+#include "symbol.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Order-flow model for the load generator: a mix of NEW / CXL / MOD around a
+// mid price that random-walks, with marketable and passive NEWs and a chosen
+// quantity distribution. CXL / MOD target the client's own resting orders,
+// learnt from the exchange's replies (onAdded / observeLine). Every draw comes
+// from one seeded generator, so a (config, stream) pair always produces the
+// same requests given the same replies.
+
+enum class FlowAction { New, Cancel, Modify };
+enum class QtyDist { Uniform, LogNormal, Fixed };
+
+struct FlowConfig {
+    uint64_t seed          = 1;
+    double   new_weight    = 0.55;   // relative weights of the three actions
+    double   cancel_weight = 0.35;
+    double   modify_weight = 0.10;
+    double   marketable    = 0.15;   // share of NEWs priced through the touch
+    int64_t  mid_ticks     = 5025;   // starting mid price
+    double   walk_ticks    = 0.5;    // std dev of the mid's step per request
+    int64_t  half_spread   = 1;      // passive orders rest at least this far from mid
+    double   depth_ticks   = 4.0;    // mean extra distance of passive orders (geometric)
+    int64_t  cross_ticks   = 2;      // how far marketable orders reach past mid
+    QtyDist  qty_dist      = QtyDist::LogNormal;
+    int      qty_min       = 1;
+    int      qty_max       = 1000;
+    double   qty_median    = 100;    // lognormal median / fixed size
+    double   qty_sigma     = 0.8;    // lognormal shape
+    int      symbols       = 0;      // spread over SYM0..SYM<n-1>; 0 = default book
+    size_t   max_live      = 500;    // resting orders per client before NEWs turn into CXLs
+};
+
+// One "key = value" setting, as in a scenario file. False with 'err' set on
+// an unknown key or bad value.
+bool setFlowOption(FlowConfig& cfg, std::string_view key, std::string_view value, std::string& err);
+// Scenario file: "key = value" lines, '#' comments. Keys are FlowConfig's
+// field names; qty_dist is uniform | lognormal | fixed.
+bool loadFlowConfig(const std::string& path, FlowConfig& cfg, std::string& err);
+
+struct FlowOrder {
+    FlowAction action = FlowAction::New;
+    Side       side = Side::Buy;        // NEW (MOD: the resting order's side)
+    int        qty = 0;                 // NEW / MOD
+    int64_t    price_ticks = 0;         // NEW / MOD
+    int64_t    order_id = 0;            // CXL / MOD
+    SymbolId   symbol = kDefaultSymbol;
+    bool       marketable = false;      // NEW priced through the touch
+};
+
+struct FlowStats {
+    uint64_t news = 0, marketable = 0, cancels = 0, modifies = 0;
+    uint64_t added = 0;     // ORDER_ADDED seen (orders that came to rest)
+    uint64_t rejects = 0;   // ERROR lines / Reject frames
+
+    void merge(const FlowStats& o) {
+        news += o.news; marketable += o.marketable; cancels += o.cancels;
+        modifies += o.modifies; added += o.added; rejects += o.rejects;
+    }
+};
+
+class FlowModel {
+public:
+    // 'stream' separates clients sharing one config (a per-client substream).
+    explicit FlowModel(const FlowConfig& cfg, uint64_t stream = 0);
+
+    FlowOrder next();
+
+    // Feedback from the exchange.
+    void onAdded(int64_t id, Side side, SymbolId symbol, int qty);
+    void onFill(int64_t id, int qty);   // one of ours traded against; gone when filled
+    void onGone(int64_t id);            // canceled or unknown to the exchange
+    void onReject() { ++stats_.rejects; }
+    // Applies one text reply line (ORDER_ADDED / TRADE / CANCELED / ERROR ...).
+    void observeLine(std::string_view line);
+
+    size_t  live() const { return live_.size(); }
+    int64_t mid() const { return static_cast<int64_t>(mid_ + 0.5); }
+    const FlowStats& stats() const { return stats_; }
+
+    // Text command for 'o' (with trailing '\n') appended to 'out'.
+    static void appendText(const FlowOrder& o, int64_t tick_factor, std::string& out);
+
+private:
+    struct Live { int64_t id; Side side; SymbolId symbol; int qty; };
+
+    int     drawQty();
+    int64_t passivePrice(Side side);
+    size_t  pickLive();
+    void    removeAt(size_t i);
+
+    FlowConfig cfg_;
+    std::mt19937_64 rng_;
+    double mid_;
+    std::vector<Live> live_;
+    std::unordered_map<int64_t, size_t> where_;   // id -> index in live_
+    std::vector<SymbolId> symbols_;
+    FlowStats stats_;
+};
@@ -0,0 +1,253 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+// Order id -> resting order, for ids that are handed out by one increasing
+// counter (the exchange's g_order_id), so the live ids of a book sit in a
+// band that slides upwards.
+//   Window : pages of kPageSlots pointers indexed by (id - base), held in a
+//            ring of page pointers. Lookup is two loads; growing appends a
+//            page (the ring only ever copies page pointers, never entries).
+//            A page goes back to the spare list once its last id is erased,
+//            and the window's ends are trimmed past empty pages.
+//   Table  : open-addressing hash (linear probing, backward-shift erase) for
+//            ids the window does not take: negative or below the window.
+//            Empty in the exchange's normal flow.
+// The window spans at most kMaxPages pages; when a new id would stretch it
+// further, the oldest pages' survivors move to the table. Values must not be
+// null (null marks an empty slot). Spare pages are kept for reuse, like
+// NodePool's slabs, and freed with the index.
+template <class V>
+class OrderIndex {
+public:
+    static constexpr int64_t kPageSlots = 1024;
+    static constexpr size_t  kMaxPages  = 16384;   // 16M ids
+
+    explicit OrderIndex(std::pmr::memory_resource* mem = std::pmr::get_default_resource())
+    : mem_(mem), ring_(16, nullptr, mem), table_(mem) {}
+
+    ~OrderIndex() {
+        for (size_t k = 0; k < count_; ++k)
+            if (Page* p = pageAt(k)) freePage(p);
+        while (Page* p = spare_) { spare_ = p->next_spare; freePage(p); }
+    }
+
+    OrderIndex(const OrderIndex&) = delete;
+    OrderIndex& operator=(const OrderIndex&) = delete;
+
+    size_t size()          const { return size_; }
+    bool   empty()         const { return size_ == 0; }
+    size_t windowPages()   const { return pages_; }        // pages holding at least one id
+    size_t tableEntries()  const { return table_size_; }
+
+    V* find(int64_t id) const {
+        if (inWindow(id)) {
+            const int64_t off = id - base_;
+            if (const Page* p = pageAt(static_cast<size_t>(off / kPageSlots)))
+                if (V* v = p->slot[off % kPageSlots]) return v;
+        }
+        return table_size_ ? tableFind(id) : nullptr;
+    }
+
+    // Sets id -> v, replacing any existing entry for id.
+    void insert(int64_t id, V* v) {
+        if (id >= 0 && windowTake(id)) {
+            const int64_t off = id - base_;
+            const size_t k = static_cast<size_t>(off / kPageSlots);
+            Page* p = pageAt(k);
+            if (!p) p = setPage(k, takePage());
+            V*& s = p->slot[off % kPageSlots];
+            if (!s) {
+                ++p->live;
+                ++size_;
+                if (table_size_ && tableErase(id)) --size_;
+            }
+            s = v;
+            return;
+        }
+        if (tableErase(id)) --size_;
+        tableInsert(id, v);
+        ++size_;
+    }
+
+    // Removes id; returns its value, or nullptr if it was not present.
+    V* erase(int64_t id) {
+        if (inWindow(id)) {
+            const int64_t off = id - base_;
+            const size_t k = static_cast<size_t>(off / kPageSlots);
+            if (Page* p = pageAt(k)) {
+                V*& s = p->slot[off % kPageSlots];
+                if (V* v = s) {
+                    s = nullptr;
+                    --size_;
+                    if (--p->live == 0) releasePage(k);
+                    return v;
+                }
+            }
+        }
+        if (!table_size_) return nullptr;
+        V* v = tableErase(id);
+        if (v) --size_;
+        return v;
+    }
+
+    void clear() {
+        for (size_t k = 0; k < count_; ++k) {
+            if (Page* p = pageAt(k)) {
+                std::memset(p->slot, 0, sizeof(p->slot));
+                p->live = 0;
+                pushSpare(p);
+                pageAt(k) = nullptr;
+            }
+        }
+        count_ = pages_ = 0;
+        for (Entry& e : table_) e = Entry{};
+        table_size_ = size_ = 0;
+    }
+
+private:
+    struct Page {
+        Page*    next_spare;
+        uint32_t live;               // non-null slots
+        V*       slot[kPageSlots];
+    };
+    struct Entry {
+        int64_t id = 0;
+        V*      v  = nullptr;        // null: free
+    };
+
+    bool inWindow(int64_t id) const {
+        return count_ && id >= base_ && (id - base_) / kPageSlots < static_cast<int64_t>(count_);
+    }
+
+    Page*& pageAt(size_t k) { return ring_[(head_ + k) & (ring_.size() - 1)]; }
+    Page*  pageAt(size_t k) const { return ring_[(head_ + k) & (ring_.size() - 1)]; }
+
+    // Makes room for id in the window, extending or sliding it; false if the
+    // id belongs in the table.
+    bool windowTake(int64_t id) {
+        if (count_ == 0) {
+            base_ = id - id % kPageSlots;
+            head_ = 0;
+        }
+        if (id < base_) return false;
+        size_t k = static_cast<size_t>((id - base_) / kPageSlots);
+        while (k >= kMaxPages) {   // slide: the oldest page's survivors go to the table
+            if (Page* p = pageAt(0)) {
+                for (int64_t i = 0; i < kPageSlots; ++i)
+                    if (V* v = p->slot[i]) { p->slot[i] = nullptr; tableInsert(base_ + i, v); }
+                p->live = 0;
+                pushSpare(p);
+                pageAt(0) = nullptr;
+                --pages_;
+            }
+            dropFront();
+            if (count_ == 0) return windowTake(id);
+            k = static_cast<size_t>((id - base_) / kPageSlots);
+        }
+        while (count_ <= k) {
+            if (count_ == ring_.size()) growRing();
+            pageAt(count_++) = nullptr;
+        }
+        return true;
+    }
+
+    Page* setPage(size_t k, Page* p) { ++pages_; return pageAt(k) = p; }
+
+    void releasePage(size_t k) {
+        pushSpare(pageAt(k));
+        pageAt(k) = nullptr;
+        --pages_;
+        while (count_ && !pageAt(0)) dropFront();
+        while (count_ && !pageAt(count_ - 1)) --count_;
+    }
+
+    void dropFront() {
+        head_ = (head_ + 1) & (ring_.size() - 1);
+        base_ += kPageSlots;
+        --count_;
+    }
+
+    void growRing() {
+        std::pmr::vector<Page*> bigger(ring_.size() * 2, nullptr, ring_.get_allocator());
+        for (size_t k = 0; k < count_; ++k) bigger[k] = pageAt(k);
+        ring_.swap(bigger);
+        head_ = 0;
+    }
+
+    Page* takePage() {
+        if (Page* p = spare_) { spare_ = p->next_spare; return p; }
+        return ::new (mem_->allocate(sizeof(Page), alignof(Page))) Page();
+    }
+    void pushSpare(Page* p) { p->next_spare = spare_; spare_ = p; }
+    void freePage(Page* p) { mem_->deallocate(p, sizeof(Page), alignof(Page)); }
+
+    // ---- Table ----
+
+    size_t slotFor(int64_t id) const {
+        return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL) >> 32) & (table_.size() - 1);
+    }
+
+    V* tableFind(int64_t id) const {
+        for (size_t i = slotFor(id);; i = (i + 1) & (table_.size() - 1)) {
+            const Entry& e = table_[i];
+            if (!e.v) return nullptr;
+            if (e.id == id) return e.v;
+        }
+    }
+
+    // id must not be present.
+    void tableInsert(int64_t id, V* v) {
+        if ((table_size_ + 1) * 2 > table_.size()) growTable();
+        size_t i = slotFor(id);
+        while (table_[i].v) i = (i + 1) & (table_.size() - 1);
+        table_[i] = Entry{id, v};
+        ++table_size_;
+    }
+
+    V* tableErase(int64_t id) {
+        if (table_.empty()) return nullptr;
+        const size_t mask = table_.size() - 1;
+        size_t i = slotFor(id);
+        while (table_[i].v && table_[i].id != id) i = (i + 1) & mask;
+        V* v = table_[i].v;
+        if (!v) return nullptr;
+        // Backward shift: pull later entries of the probe run into the hole.
+        for (size_t j = (i + 1) & mask; table_[j].v; j = (j + 1) & mask) {
+            const size_t home = slotFor(table_[j].id);
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                table_[i] = table_[j];
+                i = j;
+            }
+        }
+        table_[i] = Entry{};
+        --table_size_;
+        return v;
+    }
+
+    void growTable() {
+        std::pmr::vector<Entry> old(std::max<size_t>(64, table_.size() * 2), Entry{}, table_.get_allocator());
+        old.swap(table_);   // 'old' now holds the entries to re-insert
+        table_size_ = 0;
+        for (const Entry& e : old)
+            if (e.v) tableInsert(e.id, e.v);
+    }
+
+    std::pmr::memory_resource* mem_;
+
+    std::pmr::vector<Page*> ring_;   // power-of-two ring; window page k at (head_ + k)
+    size_t  head_  = 0;
+    size_t  count_ = 0;              // pages spanned by the window (some may be null)
+    size_t  pages_ = 0;              // non-null pages in the window
+    int64_t base_  = 0;              // first id of window page 0
+    Page*   spare_ = nullptr;
+
+    std::pmr::vector<Entry> table_;
+    size_t  table_size_ = 0;
+    size_t  size_ = 0;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Integer tick -> decimal text for the wire, with no double and no stream.
+// Prints as many decimals as the tick factor has digits (100 -> "50.25",
+// 1000 -> "50.250", 1 -> "50"), so at the exchange's factor of 100 it is
+// byte-for-byte what the old "%.2f" of ticks / 100.0 produced. A factor that
+// is not a power of ten rounds the fraction half away from zero.
+class PriceFormat {
+public:
+    static constexpr size_t kMaxChars = 48;   // sign, 19 digits, '.', 18 decimals
+
+    explicit PriceFormat(int64_t tick_factor = 100);
+
+    // Writes the price at 'p' (at most kMaxChars bytes); returns its end.
+    char* write(char* p, int64_t ticks) const;
+
+    void append(std::string& out, int64_t ticks) const {
+        char buf[kMaxChars];
+        out.append(buf, static_cast<size_t>(write(buf, ticks) - buf));
+    }
+    std::string operator()(int64_t ticks) const {
+        std::string s;
+        append(s, ticks);
+        return s;
+    }
+
+    int64_t tickFactor() const { return tick_factor_; }
+    int decimals() const { return decimals_; }
+
+private:
+    int64_t tick_factor_;
+    int64_t scale_;    // 10^decimals_
+    int     decimals_;
+};
+
+// to_chars into the string; no temporary.
+template <class T>
+inline void appendInt(std::string& out, T v) {
+    char buf[24];
+    out.append(buf, static_cast<size_t>(std::to_chars(buf, buf + sizeof(buf), v).ptr - buf));
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Level storage backend for one side of the book.
+//   Map   : every level lives in a std::map (original behaviour).
+//   Dense : levels inside a window of 'span' ticks live in a contiguous array
+//           indexed by (price - base); an occupancy bitmap gives the best level
+//           with a word scan. Prices outside the window fall back to the map.
+//           The window is re-centred when it is empty and a price lands outside.
+enum class LadderKind { Map, Dense };
+
+// Level must be default-constructible, movable and provide clear()/empty().
+// Level storage comes from 'mem'.
+template <class Level>
+class PriceLadder {
+public:
+    PriceLadder(bool bids, LadderKind kind, int64_t span,
+                std::pmr::memory_resource* mem = std::pmr::get_default_resource())
+    : bids_(bids), span_(kind == LadderKind::Dense ? roundUp64(span) : 0), dense_(mem), occ_(mem), sparse_(mem) {
+        dense_.resize(static_cast<size_t>(span_));
+        occ_.assign(static_cast<size_t>(span_ / 64), 0);
+    }
+
+    bool   empty()  const { return dense_count_ == 0 && sparse_.empty(); }
+    size_t levels() const { return dense_count_ + sparse_.size(); }
+
+    // Best price / level; only valid when !empty().
+    int64_t bestPrice() const {
+        if (dense_count_ == 0) return sparseBest()->first;
+        const int64_t dpx = base_ + dbest_;
+        if (sparse_.empty()) return dpx;
+        const int64_t spx = sparseBest()->first;
+        return better(spx, dpx) ? spx : dpx;
+    }
+    Level& bestLevel() { return *find(bestPrice()); }
+
+    Level* find(int64_t px) {
+        if (inWindow(px)) {
+            const int64_t i = px - base_;
+            return testBit(i) ? &dense_[static_cast<size_t>(i)] : nullptr;
+        }
+        auto it = sparse_.find(px);
+        return it == sparse_.end() ? nullptr : &it->second;
+    }
+    const Level* find(int64_t px) const { return const_cast<PriceLadder*>(this)->find(px); }
+
+    // Returns the level at px, creating an empty one if needed.
+    Level& getOrCreate(int64_t px) {
+        if (span_ > 0 && !inWindow(px) && dense_count_ == 0) recenter(px);
+        if (inWindow(px)) {
+            const int64_t i = px - base_;
+            if (!testBit(i)) markOccupied(i);
+            return dense_[static_cast<size_t>(i)];
+        }
+        return sparse_[px];
+    }
+
+    // Removes the level at px (its contents are cleared).
+    void erase(int64_t px) {
+        if (inWindow(px)) {
+            const int64_t i = px - base_;
+            if (!testBit(i)) return;
+            dense_[static_cast<size_t>(i)].clear();
+            markFree(i);
+            return;
+        }
+        sparse_.erase(px);
+    }
+
+    void clear() {
+        for (size_t w = 0; w < occ_.size(); ++w) {
+            while (occ_[w]) {
+                const int b = __builtin_ctzll(occ_[w]);
+                dense_[w * 64 + static_cast<size_t>(b)].clear();
+                occ_[w] &= occ_[w] - 1;
+            }
+        }
+        dense_count_ = 0;
+        dbest_ = -1;
+        sparse_.clear();
+    }
+
+    // Visit up to 'max' levels best-first: f(price, const Level&) -> bool (false stops).
+    template <class F>
+    void forEach(F&& f, size_t max = SIZE_MAX) const {
+        size_t n = 0;
+        auto visit = [&](int64_t px, const Level& lvl) { return n++ < max && f(px, lvl); };
+        const int64_t hi = base_ + span_;
+        if (bids_) {
+            for (auto it = sparse_.rbegin(); it != sparse_.rend() && it->first >= hi; ++it)
+                if (!visit(it->first, it->second)) return;
+            if (!denseForEach(visit)) return;
+            for (auto it = std::make_reverse_iterator(sparse_.lower_bound(base_)); it != sparse_.rend(); ++it)
+                if (!visit(it->first, it->second)) return;
+        } else {
+            for (auto it = sparse_.begin(); it != sparse_.end() && it->first < base_; ++it)
+                if (!visit(it->first, it->second)) return;
+            if (!denseForEach(visit)) return;
+            for (auto it = sparse_.lower_bound(hi); it != sparse_.end(); ++it)
+                if (!visit(it->first, it->second)) return;
+        }
+    }
+
+private:
+    static int64_t roundUp64(int64_t v) { return v <= 0 ? 64 : (v + 63) / 64 * 64; }
+
+    bool better(int64_t a, int64_t b) const { return bids_ ? a > b : a < b; }
+    bool inWindow(int64_t px) const { return px >= base_ && px < base_ + span_; }
+    bool testBit(int64_t i) const { return (occ_[static_cast<size_t>(i >> 6)] >> (i & 63)) & 1u; }
+
+    typename std::pmr::map<int64_t, Level>::const_iterator sparseBest() const {
+        return bids_ ? std::prev(sparse_.end()) : sparse_.begin();
+    }
+
+    void markOccupied(int64_t i) {
+        occ_[static_cast<size_t>(i >> 6)] |= (uint64_t{1} << (i & 63));
+        ++dense_count_;
+        if (dbest_ < 0 || better(i, dbest_)) dbest_ = i;
+    }
+
+    void markFree(int64_t i) {
+        occ_[static_cast<size_t>(i >> 6)] &= ~(uint64_t{1} << (i & 63));
+        if (--dense_count_ == 0) { dbest_ = -1; return; }
+        if (i == dbest_) dbest_ = bids_ ? scanDown(i) : scanUp(i);
+    }
+
+    // Highest occupied index <= i, or -1.
+    int64_t scanDown(int64_t i) const {
+        int64_t w = i >> 6;
+        uint64_t bits = occ_[static_cast<size_t>(w)] & (~uint64_t{0} >> (63 - (i & 63)));
+        while (true) {
+            if (bits) return (w << 6) + 63 - __builtin_clzll(bits);
+            if (--w < 0) return -1;
+            bits = occ_[static_cast<size_t>(w)];
+        }
+    }
+
+    // Lowest occupied index >= i, or -1.
+    int64_t scanUp(int64_t i) const {
+        int64_t w = i >> 6;
+        const int64_t words = static_cast<int64_t>(occ_.size());
+        uint64_t bits = occ_[static_cast<size_t>(w)] & (~uint64_t{0} << (i & 63));
+        while (true) {
+            if (bits) return (w << 6) + __builtin_ctzll(bits);
+            if (++w >= words) return -1;
+            bits = occ_[static_cast<size_t>(w)];
+        }
+    }
+
+    template <class V>
+    bool denseForEach(V& visit) const {
+        if (dense_count_ == 0) return true;
+        for (int64_t i = dbest_; i >= 0; i = bids_ ? (i > 0 ? scanDown(i - 1) : -1)
+                                                  : (i + 1 < span_ ? scanUp(i + 1) : -1)) {
+            if (!visit(base_ + i, dense_[static_cast<size_t>(i)])) return false;
+        }
+        return true;
+    }
+
+    // Only called with an empty window: centre it on px and pull in any
+    // sparse levels that now fall inside.
+    void recenter(int64_t px) {
+        base_ = px - span_ / 2;
+        auto it = sparse_.lower_bound(base_);
+        while (it != sparse_.end() && it->first < base_ + span_) {
+            const int64_t i = it->first - base_;
+            dense_[static_cast<size_t>(i)] = std::move(it->second);
+            markOccupied(i);
+            it = sparse_.erase(it);
+        }
+    }
+
+    bool    bids_;
+    int64_t span_;
+    int64_t base_ = 0;
+
+    std::pmr::vector<Level>    dense_;
+    std::pmr::vector<uint64_t> occ_;
+    size_t                     dense_count_ = 0;
+    int64_t                    dbest_ = -1;   // index of best dense level, -1 if none
+
+    std::pmr::map<int64_t, Level> sparse_;
+};
@@ -1,13 +1,17 @@
 #pragma once
 #include "order_book.hpp"
+#include "symbol.hpp"
+#include "session.hpp"
+#include "stage_stats.hpp"
 #include <cstdint>
 
 // Type of work item for the engine thread
 enum class MsgType { New, Cancel, Modify };
 
-// Work item sent from a network thread to the engine thread.
+// Work item sent from a network thread to the engine shard owning its symbol.
 struct OrderMsg {
     MsgType   type{MsgType::New};
+    SymbolId  symbol{kDefaultSymbol};  // selects the engine shard and book
 
     // For NEW only
     Side      side{Side::Buy};
@@ -16,5 +20,16 @@ struct OrderMsg {
 
     // For all types
     int64_t   order_id{0};          // for NEW: server-assigned id; for CXL/MOD: existing id
-    int       client_fd{-1};        // where to send response lines
+    SessionId session{kNoSession};  // where to send responses (stale once the client leaves)
+
+    // Session encoding: binary sessions get binary responses carrying client_tag
+    bool      binary{false};
+    uint64_t  client_tag{0};        // client correlation id echoed back (binary client_id,
+                                    // or a text command's trailing "tag <N>"; 0 = none)
+#if STAGE_TIMING
+    // stageNow() when the request was read off the socket and when it was
+    // queued for the engine (0 for messages that did not come from a client).
+    uint64_t  read_ns{0};
+    uint64_t  enqueue_ns{0};
+#endif
 };
\ No newline at end of file
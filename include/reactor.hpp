@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include "line_reader.hpp"
+#include <thread>
+#include <vector>
+
+// Fixed pool of epoll event-loop threads serving every client socket.
+// Each thread watches the (non-blocking) listening socket with
+// EPOLLEXCLUSIVE, accepts into its own epoll set, reads whatever is
+// available into the connection's LineReader and hands it to the callback,
+// which consumes complete messages (lines or binary frames).
+// Client sockets stay in blocking mode; reads use MSG_DONTWAIT so other
+// threads can still write replies to them.
+class Reactor {
+public:
+    // Per-connection scratch for the handlers, zeroed on accept.
+    struct ConnState {
+        int      mode = 0;
+        uint64_t id = 0;
+    };
+
+    // Called after each read. Return false to close the connection.
+    using DataHandler = std::function<bool(int fd, LineReader& in, ConnState& state)>;
+    using ConnHandler = std::function<void(int fd, ConnState& state)>;
+
+    Reactor(int listen_fd, int threads, DataHandler on_data,
+            ConnHandler on_open = nullptr, ConnHandler on_close = nullptr);
+    ~Reactor();
+
+    // Starts the I/O threads and blocks until stop(); false if epoll is unavailable.
+    // 'on_start' runs first on each I/O thread (thread index 0..threads-1).
+    bool run(std::function<void(int idx)> on_start = nullptr);
+
+    // Async-signal-safe: flags shutdown and wakes every loop.
+    void stop();
+
+private:
+    void loop(int idx);
+
+    int listen_fd_;
+    int threads_;
+    DataHandler on_data_;
+    ConnHandler on_open_, on_close_;
+    std::function<void(int idx)> on_start_;
+
+    std::vector<int> epfds_;
+    int wake_fd_ = -1;   // eventfd shared by all loops
+    std::atomic<bool> running_{false};
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include "journal.hpp"
+#include "order_book.hpp"
+#include "symbol.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Order streams for offline replay (the 'replay' tool). A stream is loaded
+// up front into JournalRecords, so a run measures the books and nothing else.
+//
+// Text form: the client commands, one per line, with commas accepted as
+// separators and '@' optional. Blank lines and lines starting with '#' are
+// skipped. NEWs are numbered 1, 2, ... in file order, as a fresh exchange
+// would number them, so CXL / MOD refer to orders by that number.
+//   NEW [SYMBOL] BUY|SELL <qty> @ <price>
+//   CXL [SYMBOL] <order_id>
+//   MOD [SYMBOL] <order_id> <new_qty> @ <new_price>
+//   NEW,AAPL,SELL,100,50.25
+// Binary form: a journal file written by 'exchange --journal'.
+
+enum class ReplayFormat { Auto, Text, Journal };
+
+enum class ReplayParse { Ok, Skip, Error };
+
+// Parses one text line into 'out' (op, side, qty, symbol, price, order_id).
+// A NEW takes its id from 'next_id' and advances it.
+ReplayParse parseReplayLine(std::string_view line, int64_t tick_factor, int64_t& next_id, JournalRecord& out);
+
+// Appends the stream in 'path' to 'out'. Auto picks Journal when the file
+// starts with the journal magic. On failure 'err' says where and why.
+bool loadReplay(const std::string& path, ReplayFormat format, int64_t tick_factor,
+                std::vector<JournalRecord>& out, std::string& err);
+
+// One book per symbol, created on first use (a CXL / MOD for a symbol with
+// no book gets the book's own unknown-id reject).
+class ReplayBooks {
+public:
+    explicit ReplayBooks(const BookConfig& cfg = BookConfig{}) : cfg_(cfg) {}
+
+    void apply(const JournalRecord& r, BookEvents& out) {
+        if (!last_ || r.symbol != last_sym_) {
+            auto& b = books_[r.symbol];
+            if (!b) b = std::make_unique<OrderBook>(cfg_);
+            last_sym_ = r.symbol;
+            last_ = b.get();
+        }
+        journalApply(*last_, r, out);
+    }
+
+    const std::map<SymbolId, std::unique_ptr<OrderBook>>& books() const { return books_; }
+
+private:
+    BookConfig cfg_;
+    std::map<SymbolId, std::unique_ptr<OrderBook>> books_;
+    SymbolId   last_sym_ = kDefaultSymbol;
+    OrderBook* last_ = nullptr;
+};
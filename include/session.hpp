@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Generation-checked reference to a client session: slot index in the low
+// 32 bits, the slot's generation in the high 32. Once a session closes its
+// id goes stale, so late replies can never reach a recycled socket.
+using SessionId = uint64_t;
+constexpr SessionId kNoSession = 0;
+
+struct SessionStats {
+    uint64_t replies = 0;       // send() calls accepted
+    uint64_t bytes = 0;         // bytes accepted
+    uint64_t writes = 0;        // write syscalls used to deliver them
+    uint64_t peak_backlog = 0;  // most bytes ever waiting to be written
+    bool     overflowed = false;   // disconnected for exceeding the backlog limit
+};
+
+// Outbound side of every client connection. Any thread may send replies; it
+// never blocks on the socket. A reply to a session with nothing queued is
+// written straight through (non-blocking); whatever the socket does not take
+// is queued. One writer thread flushes each session's queue with a single
+// vectored write where it can, and waits for POLLOUT on sessions whose socket
+// buffer is full. A session whose backlog passes 'max_backlog' is shut down
+// instead of growing further.
+//
+// open() takes a private dup of the socket, which only the writer closes:
+// the reader keeps (and closes) its own descriptor.
+class SessionTable {
+public:
+    explicit SessionTable(size_t capacity = 16384, size_t max_backlog = 4u << 20);
+    ~SessionTable();
+
+    SessionTable(const SessionTable&) = delete;
+    SessionTable& operator=(const SessionTable&) = delete;
+
+    void start(std::function<void()> on_start = nullptr);   // 'on_start' runs first on the writer thread
+    void stop();   // delivers what it can without waiting, then closes every session
+
+    SessionId open(int fd);   // kNoSession when the table is full
+    // Queues bytes for the session. False if the id is stale or the session
+    // was just disconnected for exceeding its backlog limit.
+    bool send(SessionId id, std::string_view data);
+    // No more replies are accepted; what is queued is written without
+    // waiting and the socket is closed. Returns the session's counters.
+    SessionStats close(SessionId id);
+
+    size_t backlog(SessionId id) const;   // bytes queued, not yet written
+    SessionStats totals() const;          // sessions closed so far
+    uint64_t opened() const { return opened_.load(std::memory_order_relaxed); }
+    uint64_t slowDisconnects() const { return slow_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        mutable std::mutex m;
+        uint32_t gen = 1;
+        int      fd = -1;          // writer's dup; -1 when free
+        bool     open = false;     // accepting replies
+        bool     queued = false;   // in ready_
+        bool     closed = false;   // close() called; the writer releases the slot
+        bool     waiting = false;  // writer only: waiting for POLLOUT
+        std::vector<std::string> out;   // reply chunks, oldest first
+        size_t   out_off = 0;      // bytes of out[0] already written
+        size_t   backlog = 0;
+        SessionStats stats;
+    };
+
+    Slot* find(SessionId id, std::unique_lock<std::mutex>& lk) const;
+    void markReady(uint32_t slot);
+    bool flush(uint32_t slot);   // true if the socket is full and data remains
+    void release(uint32_t slot, Slot& s);
+    void run();
+
+    const size_t capacity_;
+    const size_t max_backlog_;
+    std::unique_ptr<Slot[]> slots_;
+
+    mutable std::mutex free_m_;
+    std::vector<uint32_t> free_;
+    SessionStats totals_;
+
+    std::mutex ready_m_;
+    std::vector<uint32_t> ready_;
+    int wake_[2] = {-1, -1};   // pipe: wakes the writer out of poll()
+
+    std::atomic<uint64_t> opened_{0}, slow_{0};
+    std::atomic<bool> stop_{false};
+    std::thread thr_;
+};
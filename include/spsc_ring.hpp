@@ -0,0 +1,63 @@
+#pragma once
+#include "mpsc_ring.hpp"   // kCacheLine
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded wait-free single-producer / single-consumer ring. Each side keeps a
+// cached copy of the other side's index and only re-reads the shared atomic
+// when the cache says full (producer) or empty (consumer), so the common case
+// touches no shared cache line besides the slot itself.
+template <class T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+    : mask_(roundPow2(capacity) - 1), slots_(new T[mask_ + 1]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only. False if full.
+    bool tryPush(const T& v) {
+        const size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t - head_cache_ > mask_) return false;
+        }
+        slots_[t & mask_] = v;
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Takes up to 'max' items without waiting.
+    size_t popBatch(T* out, size_t max) {
+        const size_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h == tail_cache_) return 0;
+        }
+        size_t n = tail_cache_ - h;
+        if (n > max) n = max;
+        for (size_t i = 0; i < n; ++i) out[i] = slots_[(h + i) & mask_];
+        head_.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static size_t roundPow2(size_t v) {
+        size_t p = 2;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};   // written by producer
+    size_t head_cache_ = 0;                             // producer's view of head_
+    alignas(kCacheLine) std::atomic<size_t> head_{0};   // written by consumer
+    size_t tail_cache_ = 0;                             // consumer's view of tail_
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include "latency_histogram.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <time.h>
+
+// Per-stage latency inside the exchange. Built in when STAGE_TIMING is 1
+// (CMake option STAGE_TIMING, on by default); at 0 the timestamps in
+// OrderMsg and every stamp in the exchange compile away.
+#ifndef STAGE_TIMING
+#define STAGE_TIMING 0
+#endif
+
+// CLOCK_MONOTONIC_RAW in ns: a vDSO call, unaffected by NTP slewing, so
+// stamps taken on different threads can be subtracted.
+inline uint64_t stageNow() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// The path of one order, split at the points the exchange stamps:
+//   socket read -> enqueue -> dequeue -> book start -> matched -> market data
+//   handed off -> reply handed off.
+// The last two end at the hand-off to the publisher / session writer
+// thread, not at the send() those threads make later.
+enum class Stage : size_t {
+    Parse,        // read -> enqueue: ACK, parse, shard pick
+    Queue,        // enqueue -> popped by the engine
+    Batch,        // popped -> book start: journal and earlier messages in the batch
+    Match,        // the OrderBook call
+    MarketData,   // market-data items and depth diff
+    Reply,        // reply formatting and hand-off
+    Total,        // read -> reply handed off
+    Count
+};
+
+constexpr size_t kStageCount = static_cast<size_t>(Stage::Count);
+
+const char* stageName(Stage s);
+
+// One engine shard's stage histograms. Written only by that shard's thread;
+// an interval set is dumped and cleared periodically, and folded into the
+// running total that is printed at shutdown.
+class StageStats {
+public:
+    struct Stamps {
+        uint64_t read, enqueue, dequeue, start, matched, md, replied;
+    };
+
+    void record(const Stamps& t);
+
+    // Folds the interval into the total; returns false if it was empty.
+    bool rollInterval();
+    const LatencyHistogram& interval(Stage s) const { return interval_[static_cast<size_t>(s)]; }
+    const LatencyHistogram& total(Stage s) const { return total_[static_cast<size_t>(s)]; }
+    void merge(const StageStats& o);   // totals only
+
+    // Table of count, p50 .. p99.9, max and mean per stage, in us.
+    static void write(std::ostream& out, const LatencyHistogram (&h)[kStageCount]);
+    void writeInterval(std::ostream& out) const { write(out, interval_); }
+    void writeTotal(std::ostream& out) const { write(out, total_); }
+
+private:
+    LatencyHistogram interval_[kStageCount];
+    LatencyHistogram total_[kStageCount];
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Instrument symbols are 1-8 characters of [A-Z0-9.], starting with a letter,
+// packed NUL-padded into a uint64 so they ride inside OrderMsg and key hash
+// maps without allocating. 0 is the default instrument used by commands that
+// carry no symbol (the original single-book protocol).
+using SymbolId = uint64_t;
+
+constexpr SymbolId kDefaultSymbol = 0;
+constexpr size_t   kSymbolMaxLen  = 8;
+
+inline bool symbolChar(char c, bool first) {
+    if (c >= 'A' && c <= 'Z') return true;
+    return !first && ((c >= '0' && c <= '9') || c == '.');
+}
+
+// False if 's' is not a valid symbol.
+inline bool encodeSymbol(std::string_view s, SymbolId& out) {
+    if (s.empty() || s.size() > kSymbolMaxLen) return false;
+    for (size_t i = 0; i < s.size(); ++i)
+        if (!symbolChar(s[i], i == 0)) return false;
+    char raw[kSymbolMaxLen] = {};
+    std::memcpy(raw, s.data(), s.size());
+    std::memcpy(&out, raw, sizeof(out));
+    return true;
+}
+
+// Validates a packed symbol received as raw bytes (binary protocol).
+inline bool validSymbol(SymbolId id) {
+    if (id == kDefaultSymbol) return true;
+    char raw[kSymbolMaxLen];
+    std::memcpy(raw, &id, sizeof(raw));
+    size_t n = 0;
+    while (n < kSymbolMaxLen && raw[n]) ++n;
+    for (size_t i = n; i < kSymbolMaxLen; ++i)
+        if (raw[i]) return false;   // padding must be all NUL
+    for (size_t i = 0; i < n; ++i)
+        if (!symbolChar(raw[i], i == 0)) return false;
+    return true;
+}
+
+inline std::string symbolName(SymbolId id) {
+    char raw[kSymbolMaxLen];
+    std::memcpy(raw, &id, sizeof(raw));
+    size_t n = 0;
+    while (n < kSymbolMaxLen && raw[n]) ++n;
+    return std::string(raw, n);
+}
+
+// Engine shard that owns a symbol. Fixed for a given shard count, so no
+// table has to be shared between the network threads.
+inline size_t symbolShard(SymbolId id, size_t shards) {
+    uint64_t h = id;                 // splitmix64 finaliser
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return shards > 1 ? static_cast<size_t>(h % shards) : 0;
+}
@@ -0,0 +1,85 @@
+#include "binary_protocol.hpp"
+
+static BinRespHeader respHeader(BinType type, size_t size, uint64_t client_id, uint64_t ts_ns) {
+    BinRespHeader r;
+    r.h.length = static_cast<uint16_t>(size);
+    r.h.type = static_cast<uint8_t>(type);
+    r.client_id = client_id;
+    r.server_ts_ns = ts_ns;
+    return r;
+}
+
+static uint8_t sideByte(Side s) { return s == Side::Buy ? 0 : 1; }
+
+void binAppendAck(std::string& out, uint64_t client_id, uint64_t ts_ns, int64_t order_id) {
+    BinAck m;
+    m.r = respHeader(BinType::Ack, sizeof(m), client_id, ts_ns);
+    m.order_id = order_id;
+    binAppend(out, m);
+}
+
+void binAppendReject(std::string& out, uint64_t client_id, uint64_t ts_ns,
+                     int64_t order_id, BinReject reason) {
+    BinRejectMsg m;
+    m.r = respHeader(BinType::Reject, sizeof(m), client_id, ts_ns);
+    m.order_id = order_id;
+    m.reason = static_cast<uint8_t>(reason);
+    binAppend(out, m);
+}
+
+bool binAppendEvent(std::string& out, const BookEvent& ev, uint64_t client_id, uint64_t ts_ns) {
+    switch (ev.type) {
+        case BookEventType::Added: {
+            BinAdded m;
+            m.r = respHeader(BinType::Added, sizeof(m), client_id, ts_ns);
+            m.order_id = ev.order_id;
+            m.side = sideByte(ev.side);
+            m.qty = static_cast<uint32_t>(ev.qty);
+            m.price_ticks = ev.price_ticks;
+            binAppend(out, m);
+            return true;
+        }
+        case BookEventType::Trade: {
+            BinTrade m;
+            m.r = respHeader(BinType::Trade, sizeof(m), client_id, ts_ns);
+            m.resting_id = ev.order_id;
+            m.side = sideByte(ev.side);
+            m.qty = static_cast<uint32_t>(ev.qty);
+            m.price_ticks = ev.price_ticks;
+            binAppend(out, m);
+            return true;
+        }
+        case BookEventType::Canceled: {
+            BinCanceled m;
+            m.r = respHeader(BinType::Canceled, sizeof(m), client_id, ts_ns);
+            m.order_id = ev.order_id;
+            binAppend(out, m);
+            return true;
+        }
+        case BookEventType::Replaced: {
+            BinReplaced m;
+            m.r = respHeader(BinType::Replaced, sizeof(m), client_id, ts_ns);
+            m.old_id = ev.order_id;
+            m.new_id = ev.new_id;
+            binAppend(out, m);
+            return true;
+        }
+        case BookEventType::Reject: {
+            BinReject reason = BinReject::InvalidOrder;
+            switch (ev.reason) {
+                case RejectReason::InvalidOrder:
+                case RejectReason::InvalidSeed:    reason = BinReject::InvalidOrder; break;
+                case RejectReason::UnknownOrderId:
+                case RejectReason::CancelFailed:   reason = BinReject::UnknownOrderId; break;
+                case RejectReason::InvalidReplace: reason = BinReject::InvalidReplace; break;
+                case RejectReason::JournalFull:    reason = BinReject::EngineOffline; break;
+            }
+            binAppendReject(out, client_id, ts_ns, ev.order_id, reason);
+            return true;
+        }
+        case BookEventType::BestBid:
+        case BookEventType::BestAsk:
+            return false;
+    }
+    return false;
+}
@@ -1,4 +1,8 @@
 #include "bot.hpp"
+#include "line_reader.hpp"
+#include "binary_protocol.hpp"
+#include "latency_histogram.hpp"
+#include "order_flow.hpp"
 
 #include <arpa/inet.h>
 #include <chrono>
@@ -9,12 +13,19 @@
 #include <thread>
 #include <unistd.h>
 #include <netinet/tcp.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
 #include <vector>
 #include <sys/time.h>
 #include <cerrno>
+#include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <string_view>
 #include <algorithm>
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 // --- TCP safe send ---
 static ssize_t safe_send(int fd, const void* buf, size_t len) {
@@ -40,21 +51,26 @@ static void send_udp(const std::string& msg, const std::string& host, uint16_t p
     close(sock);
 }
 
-// --- Utility: read one line ---
-static bool read_line_fd(int fd, std::string& out, bool nonfatal_timeout) {
-    out.clear(); char ch=0;
+// --- Utility: read one line (false on EOF/error/timeout) ---
+static bool read_line_fd(int fd, LineReader& reader, std::string_view& out) {
+    const auto st = reader.readLine(fd, out);
+    if (st == LineReader::Status::Error) perror("recv");
+    return st == LineReader::Status::Line;
+}
+
+// --- Utility: read one binary frame (false on EOF/error/timeout/bad frame) ---
+static bool read_frame_fd(int fd, LineReader& reader, std::string_view& out) {
     while (true) {
-        ssize_t n = recv(fd, &ch, 1, 0);
-        if (n == 0) return false; // peer closed
-        if (n < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
-            perror("recv"); return false;
-        }
-        if (ch == '\n') break;
-        out.push_back(ch);
-        if (out.size() > 8192) return false;
+        const std::string_view p = reader.pending();
+        const size_t len = binFrameLength(p);
+        if (len == kBinBadFrame) return false;
+        if (len) { out = p.substr(0, len); reader.consume(len); return true; }
+        const ssize_t r = reader.fill(fd);
+        if (r > 0) continue;
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK) perror("recv");
+        return false;
     }
-    return true;
 }
 
 // --- Percentile helper ---
@@ -65,19 +81,514 @@ static long long percentile(std::vector<long long>& v, double p) {
     return v[idx];
 }
 
+// Random NEWs within +/-20 ticks of 50.25, as text lines or binary frames;
+// or, given a FlowConfig, the NEW / CXL / MOD mix of a FlowModel, which
+// learns the client's resting ids from the replies passed to observe*().
+// The open loop's sender and receiver share one, hence the mutex.
+struct OrderGen {
+    std::mt19937_64 rng;
+    std::uniform_int_distribution<int> side_dist{0, 1};
+    std::uniform_int_distribution<int> qty_dist{1, 200};
+    std::uniform_int_distribution<int> pips_dist{-20, 20};
+    std::uniform_int_distribution<int> sym_dist;
+    int symbols;
+    std::unique_ptr<FlowModel> flow;
+    std::vector<SymbolId> flow_sym;   // symbol by client_id - 1 (binary Added has none)
+    std::mutex mu;
+
+    OrderGen(uint64_t seed, int symbols_, const FlowConfig* flow_cfg = nullptr)
+    : rng(seed), sym_dist(0, symbols_ > 0 ? symbols_ - 1 : 0), symbols(symbols_) {
+        if (flow_cfg) flow = std::make_unique<FlowModel>(*flow_cfg, seed);
+    }
+
+    // Sets 'out' to order number i: a text line, or a binary frame with
+    // client_id i + 1.
+    void next(int i, bool binary, std::string& out) {
+        out.clear();
+        if (flow) { next_flow(i, binary, out); return; }
+        const int pips = pips_dist(rng);
+        const int qty = qty_dist(rng);
+        const bool buy = side_dist(rng) != 0;
+        const std::string sym = symbols > 0 ? "SYM" + std::to_string(sym_dist(rng)) : std::string();
+        if (binary) {
+            BinNew nm;
+            binInit(nm, BinType::New);
+            nm.client_id   = static_cast<uint64_t>(i + 1);
+            std::memcpy(nm.symbol, sym.data(), std::min(sym.size(), sizeof(nm.symbol)));
+            nm.side        = buy ? 0 : 1;
+            nm.qty         = static_cast<uint32_t>(qty);
+            nm.price_ticks = 5025 + pips;
+            binAppend(out, nm);
+        } else {
+            double px = 50.25 + pips * 0.01;
+            out = "NEW " + (sym.empty() ? std::string() : sym + " ") + (buy ? "BUY" : "SELL") + " " + std::to_string(qty) + " @ " + std::to_string(px) + "\n";
+        }
+    }
+
+    void next_flow(int i, bool binary, std::string& out) {
+        std::lock_guard<std::mutex> lk(mu);
+        const FlowOrder o = flow->next();
+        if (!binary) { FlowModel::appendText(o, 100, out); return; }
+        const auto cid = static_cast<uint64_t>(i + 1);
+        if (flow_sym.size() < cid) flow_sym.resize(cid);
+        flow_sym[cid - 1] = o.symbol;
+        switch (o.action) {
+            case FlowAction::New: {
+                BinNew m; binInit(m, BinType::New);
+                m.client_id = cid; std::memcpy(m.symbol, &o.symbol, sizeof(m.symbol));
+                m.side = o.side == Side::Buy ? 0 : 1;
+                m.qty = static_cast<uint32_t>(o.qty); m.price_ticks = o.price_ticks;
+                binAppend(out, m);
+                break;
+            }
+            case FlowAction::Cancel: {
+                BinCancel m; binInit(m, BinType::Cancel);
+                m.client_id = cid; std::memcpy(m.symbol, &o.symbol, sizeof(m.symbol));
+                m.order_id = o.order_id;
+                binAppend(out, m);
+                break;
+            }
+            case FlowAction::Modify: {
+                BinModify m; binInit(m, BinType::Modify);
+                m.client_id = cid; std::memcpy(m.symbol, &o.symbol, sizeof(m.symbol));
+                m.order_id = o.order_id;
+                m.qty = static_cast<uint32_t>(o.qty); m.price_ticks = o.price_ticks;
+                binAppend(out, m);
+                break;
+            }
+        }
+    }
+
+    void observe_line(std::string_view l) {
+        if (!flow) return;
+        std::lock_guard<std::mutex> lk(mu);
+        flow->observeLine(l);
+    }
+    void observe_frame(std::string_view f) {
+        if (!flow) return;
+        std::lock_guard<std::mutex> lk(mu);
+        BinAdded a; BinTrade t; BinCanceled c; BinReplaced r; BinRejectMsg j;
+        switch (binType(f)) {
+            case BinType::Added:
+                if (binDecode(f, a)) {
+                    const uint64_t cid = a.r.client_id;
+                    const SymbolId sym = cid && cid <= flow_sym.size() ? flow_sym[cid - 1] : kDefaultSymbol;
+                    flow->onAdded(a.order_id, a.side ? Side::Sell : Side::Buy, sym, static_cast<int>(a.qty));
+                }
+                break;
+            case BinType::Trade: if (binDecode(f, t)) flow->onFill(t.resting_id, static_cast<int>(t.qty)); break;
+            case BinType::Canceled: if (binDecode(f, c)) flow->onGone(c.order_id); break;
+            case BinType::Replaced: if (binDecode(f, r)) flow->onGone(r.old_id); break;
+            case BinType::Reject:
+                if (binDecode(f, j)) { flow->onReject(); flow->onGone(j.order_id); }
+                break;
+            default: break;
+        }
+    }
+    FlowStats flow_stats() {
+        std::lock_guard<std::mutex> lk(mu);
+        return flow ? flow->stats() : FlowStats{};
+    }
+};
+
+static void print_flow_stats(const FlowStats& s) {
+    std::printf("Flow: %llu NEW (%llu marketable), %llu CXL, %llu MOD; %llu rested, %llu rejected\n",
+                static_cast<unsigned long long>(s.news), static_cast<unsigned long long>(s.marketable),
+                static_cast<unsigned long long>(s.cancels), static_cast<unsigned long long>(s.modifies),
+                static_cast<unsigned long long>(s.added), static_cast<unsigned long long>(s.rejects));
+}
+
 // Send one line and wait for a single '\n'-terminated reply (ACK or first line)
-static bool send_and_wait_ack(int s, const std::string& line) {
+static bool send_and_wait_ack(int s, LineReader& reader, const std::string& line) {
     if (send(s, line.c_str(), line.size(), 0) < 0) return false;
-    std::string resp; resp.reserve(256);
-    char ch;
-    while (true) {
-        ssize_t n = recv(s, &ch, 1, 0);
-        if (n <= 0) return false;
-        if (ch == '\n') break;
-        resp.push_back(ch);
-        if (resp.size() > 4096) break;
+    std::string_view resp;
+    return read_line_fd(s, reader, resp);
+}
+
+// Connected TCP_NODELAY socket, or -1.
+static int connect_exchange(const std::string& host, uint16_t port) {
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s < 0) return -1;
+#ifdef TCP_NODELAY
+    int one = 1; setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#endif
+    sockaddr_in a{}; a.sin_family = AF_INET; a.sin_port = htons(port);
+    inet_pton(AF_INET, host.c_str(), &a.sin_addr);
+    if (connect(s, (sockaddr*)&a, sizeof(a)) < 0) { close(s); return -1; }
+    return s;
+}
+
+static int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct OpenLoopConfig {
+    std::string host;
+    uint16_t    port;
+    int         clients;
+    int         orders;      // per client
+    double      rate;        // orders/s over all clients
+    bool        poisson;     // exponential gaps, else constant
+    bool        binary;
+    int         symbols;
+    std::string csv_path;
+    std::string hist_path;   // full response-time histogram (.hgrm)
+    const FlowConfig* flow;  // order-flow model, or null for plain NEWs
+};
+
+// Open loop: every client sends on a precomputed schedule at rate/clients,
+// whether or not earlier orders have been answered; a receiver thread per
+// connection matches ACKs to orders (in order for text, by client_id for
+// binary). Response time runs from the *intended* send time, so a stall is
+// charged to every order that should have gone out during it (no
+// coordinated omission). Service time runs from the actual send.
+static int run_open_loop(const OpenLoopConfig& cfg) {
+    struct Client {
+        int fd = -1;
+        std::vector<int64_t> due;                        // intended send, ns after start
+        std::unique_ptr<std::atomic<int64_t>[]> sent;    // actual send, steady ns
+        LatencyHistogram response, service;
+        int replies = 0;
+        int sent_count = 0;
+        std::unique_ptr<OrderGen> gen;
+    };
+    const size_t n = static_cast<size_t>(cfg.clients);
+    const int orders = cfg.orders;
+    std::vector<Client> cl(n);
+
+    const double gap_ns = 1e9 * cfg.clients / cfg.rate;   // mean gap per client
+    for (size_t c = 0; c < n; ++c) {
+        Client& k = cl[c];
+        k.fd = connect_exchange(cfg.host, cfg.port);
+        if (k.fd < 0) { perror("connect"); return 1; }
+        if (cfg.binary) {
+            const char magic = static_cast<char>(kBinaryMagic);
+            if (send(k.fd, &magic, 1, 0) < 0) return 1;
+        }
+        struct timeval tv{5, 0}; setsockopt(k.fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        k.sent.reset(new std::atomic<int64_t>[static_cast<size_t>(orders)]);
+        k.due.resize(static_cast<size_t>(orders));
+        k.gen = std::make_unique<OrderGen>(c * 1337ULL, cfg.symbols, cfg.flow);
+        // Clients start staggered by a fraction of a gap.
+        std::mt19937_64 rng(c * 7919ULL + 1);
+        std::exponential_distribution<double> expo(1.0 / gap_ns);
+        double t = gap_ns * static_cast<double>(c) / static_cast<double>(n);
+        for (int i = 0; i < orders; ++i) {
+            k.due[static_cast<size_t>(i)] = static_cast<int64_t>(t);
+            t += cfg.poisson ? expo(rng) : gap_ns;
+        }
+    }
+
+    const int64_t start = steady_ns() + 20000000;   // everyone connected; go in 20 ms
+    std::vector<std::thread> ts;
+    for (size_t c = 0; c < n; ++c) {
+        Client& k = cl[c];
+        ts.emplace_back([&] {   // sender
+            std::string line;
+            for (int i = 0; i < orders; ++i) {
+                k.gen->next(i, cfg.binary, line);
+                const int64_t due = start + k.due[static_cast<size_t>(i)];
+                int64_t now = steady_ns();
+                if (due - now > 50000) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(due - now - 20000));
+                }
+                while ((now = steady_ns()) < due) {}
+                k.sent[static_cast<size_t>(i)].store(now, std::memory_order_release);
+                if (safe_send(k.fd, line.data(), line.size()) < 0) break;
+                ++k.sent_count;
+            }
+        });
+        ts.emplace_back([&] {   // receiver
+            LineReader reader;
+            std::string_view msg;
+            while (k.replies < orders) {
+                size_t i;
+                if (cfg.binary) {
+                    if (!read_frame_fd(k.fd, reader, msg)) break;
+                    if (binType(msg) != BinType::Ack) { k.gen->observe_frame(msg); continue; }
+                    BinAck ack;
+                    if (!binDecode(msg, ack) || ack.r.client_id == 0 ||
+                        ack.r.client_id > static_cast<uint64_t>(orders)) continue;
+                    i = static_cast<size_t>(ack.r.client_id - 1);
+                } else {
+                    if (!read_line_fd(k.fd, reader, msg)) break;
+                    if (msg.compare(0, 4, "ACK ") != 0) { k.gen->observe_line(msg); continue; }
+                    i = static_cast<size_t>(k.replies);
+                }
+                const int64_t now = steady_ns();
+                k.response.record(static_cast<uint64_t>(std::max<int64_t>(0, now - (start + k.due[i]))));
+                k.service.record(static_cast<uint64_t>(std::max<int64_t>(0, now - k.sent[i].load(std::memory_order_acquire))));
+                ++k.replies;
+            }
+        });
+    }
+    for (auto& t : ts) t.join();
+    const double wall_s = static_cast<double>(steady_ns() - start) / 1e9;
+
+    LatencyHistogram response, service;
+    FlowStats flow;
+    long long sent = 0, replies = 0;
+    for (auto& k : cl) {
+        flow.merge(k.gen->flow_stats());
+        if (cfg.binary) { BinQuit q; binInit(q, BinType::Quit); (void)safe_send(k.fd, &q, sizeof(q)); }
+        else { const char* bye = "QUIT\n"; (void)safe_send(k.fd, bye, strlen(bye)); }
+        close(k.fd);
+        response.merge(k.response);
+        service.merge(k.service);
+        sent += k.sent_count;
+        replies += k.replies;
+    }
+
+    std::printf("Open loop: %d clients x %d orders, offered %.0f orders/s (%s arrivals)\n",
+                cfg.clients, orders, cfg.rate, cfg.poisson ? "poisson" : "constant");
+    std::printf("Sent %lld, answered %lld, lost %lld in %.2f s (%.0f orders/s answered)\n",
+                sent, replies, sent - replies, wall_s, static_cast<double>(replies) / wall_s);
+    if (cfg.flow) print_flow_stats(flow);
+    if (!replies) { std::cout << "No samples collected.\n"; return 1; }
+
+    const double pcts[] = {50, 90, 99, 99.9, 99.99, 99.999};
+    std::printf("%-22s %9s %9s %9s %9s %9s %9s %9s %9s\n", "latency (us)", "p50", "p90", "p99",
+                "p99.9", "p99.99", "p99.999", "max", "mean");
+    auto row = [&](const char* name, const LatencyHistogram& h) {
+        std::printf("%-22s", name);
+        for (double p : pcts) std::printf(" %9.1f", static_cast<double>(h.percentile(p)) / 1000.0);
+        std::printf(" %9.1f %9.1f\n", static_cast<double>(h.max()) / 1000.0, h.mean() / 1000.0);
+    };
+    row("response (intended)", response);
+    row("service (actual send)", service);
+
+    if (!cfg.hist_path.empty()) {
+        std::ofstream out(cfg.hist_path);
+        response.writePercentiles(out, 1000.0);
+        std::cout << "Wrote " << cfg.hist_path << " (response time, us)\n";
+    }
+    if (!cfg.csv_path.empty()) {
+        std::ofstream csv(cfg.csv_path);
+        csv << "percentile,value_us\n";
+        for (double p : pcts) csv << "p" << p << "," << static_cast<double>(response.percentile(p)) / 1000.0 << "\n";
+        csv << "max," << static_cast<double>(response.max()) / 1000.0 << "\n";
+        std::cout << "Wrote " << cfg.csv_path << "\n";
+    }
+    return 0;
+}
+
+struct AsyncConfig {
+    std::string host;
+    uint16_t    port;
+    int         connections;
+    int         orders;      // per connection
+    int         threads;     // event-loop threads
+    int         inflight;    // orders outstanding per connection
+    bool        fifo;        // match by ACK order instead of tags
+    bool        binary;
+    int         symbols;
+    std::string csv_path;
+    std::string hist_path;   // completion-time histogram (.hgrm)
+    const FlowConfig* flow;  // order-flow model, or null for plain NEWs
+};
+
+// Pipelined load: a few epoll threads each drive a share of the connections,
+// keeping up to 'inflight' orders outstanding on every one. Orders carry a
+// tag (text "tag <N>", binary client_id) that the exchange echoes on the ACK
+// and on every reply line, so the bot can tell when the engine has answered
+// an order. With --match fifo no tag is sent and the N-th ACK completes the
+// N-th order, which only measures the exchange's network side.
+static int run_async(const AsyncConfig& cfg) {
+    struct Conn {
+        int fd = -1;
+        LineReader in{8192, 65536};
+        std::string out;
+        size_t out_off = 0;
+        bool want_out = false;
+        int sent = 0, acked = 0, done = 0;
+        std::vector<int64_t> sent_ns;    // by order number
+        std::vector<uint8_t> finished;   // engine reply seen (tag mode)
+        std::unique_ptr<OrderGen> gen;
+    };
+    struct Loop {
+        std::vector<Conn*> conns;
+        LatencyHistogram ack, done;
+        long long completed = 0;
+    };
+    const int orders = cfg.orders;
+    std::vector<Conn> conns(static_cast<size_t>(cfg.connections));
+    std::vector<Loop> loops(static_cast<size_t>(std::max(1, cfg.threads)));
+    for (size_t c = 0; c < conns.size(); ++c) {
+        Conn& k = conns[c];
+        k.fd = connect_exchange(cfg.host, cfg.port);
+        if (k.fd < 0) { perror("connect"); return 1; }
+        if (cfg.binary) {
+            const char magic = static_cast<char>(kBinaryMagic);
+            if (send(k.fd, &magic, 1, 0) < 0) return 1;
+        }
+        fcntl(k.fd, F_SETFL, fcntl(k.fd, F_GETFL, 0) | O_NONBLOCK);
+        k.sent_ns.resize(static_cast<size_t>(orders));
+        k.finished.assign(static_cast<size_t>(orders), 0);
+        k.gen = std::make_unique<OrderGen>(c * 1337ULL, cfg.symbols, cfg.flow);
+        loops[c % loops.size()].conns.push_back(&k);
+    }
+
+    auto loop_main = [&](Loop& L) {
+        const int ep = epoll_create1(0);
+        for (Conn* k : L.conns) {
+            epoll_event ev{}; ev.events = EPOLLIN; ev.data.ptr = k;
+            epoll_ctl(ep, EPOLL_CTL_ADD, k->fd, &ev);
+        }
+        size_t active = L.conns.size();
+        std::string line;
+
+        // Queue orders up to the window, then write what the socket takes.
+        auto pump = [&](Conn* k) {
+            const int completed = cfg.fifo ? k->acked : k->done;
+            while (k->sent < orders && k->sent - completed < cfg.inflight) {
+                const int i = k->sent++;
+                k->gen->next(i, cfg.binary, line);
+                if (cfg.binary) {
+                    k->out += line;
+                } else {
+                    if (!cfg.fifo) { line.pop_back(); line += " tag " + std::to_string(i + 1) + "\n"; }
+                    k->out += line;
+                }
+                k->sent_ns[static_cast<size_t>(i)] = steady_ns();
+            }
+            while (k->out_off < k->out.size()) {
+                const ssize_t w = safe_send(k->fd, k->out.data() + k->out_off, k->out.size() - k->out_off);
+                if (w <= 0) break;
+                k->out_off += static_cast<size_t>(w);
+            }
+            if (k->out_off == k->out.size()) { k->out.clear(); k->out_off = 0; }
+            const bool want = !k->out.empty();
+            if (want != k->want_out) {
+                k->want_out = want;
+                epoll_event ev{}; ev.events = EPOLLIN | (want ? static_cast<uint32_t>(EPOLLOUT) : 0u); ev.data.ptr = k;
+                epoll_ctl(ep, EPOLL_CTL_MOD, k->fd, &ev);
+            }
+        };
+        auto finish = [&](Conn* k, size_t i, int64_t now) {
+            if (i >= k->finished.size() || k->finished[i]) return;
+            k->finished[i] = 1;
+            ++k->done;
+            ++L.completed;
+            L.done.record(static_cast<uint64_t>(now - k->sent_ns[i]));
+        };
+        auto ack = [&](Conn* k, size_t i, int64_t now) {
+            if (i >= k->sent_ns.size()) return;
+            ++k->acked;
+            L.ack.record(static_cast<uint64_t>(now - k->sent_ns[i]));
+            if (cfg.fifo) finish(k, i, now);
+        };
+        // Tag at the end of a text reply line, or 0.
+        auto line_tag = [](std::string_view l) -> uint64_t {
+            const size_t p = l.rfind(" tag ");
+            return p == std::string_view::npos ? 0 : std::strtoull(std::string(l.substr(p + 5)).c_str(), nullptr, 10);
+        };
+        auto close_conn = [&](Conn* k) {
+            if (cfg.binary) { BinQuit q; binInit(q, BinType::Quit); (void)safe_send(k->fd, &q, sizeof(q)); }
+            else { const char* bye = "QUIT\n"; (void)safe_send(k->fd, bye, strlen(bye)); }
+            epoll_ctl(ep, EPOLL_CTL_DEL, k->fd, nullptr);
+            close(k->fd);
+            k->fd = -1;
+            --active;
+        };
+
+        for (Conn* k : L.conns) pump(k);
+        epoll_event evs[256];
+        while (active > 0) {
+            const int n = epoll_wait(ep, evs, 256, 5000);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { std::cerr << "No replies for 5 s; giving up on " << active << " connection(s)\n"; break; }
+            for (int e = 0; e < n; ++e) {
+                Conn* k = static_cast<Conn*>(evs[e].data.ptr);
+                if (k->fd < 0) continue;
+                bool dead = false;
+                if (evs[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    while (true) {
+                        const ssize_t r = k->in.fill(k->fd, MSG_DONTWAIT);
+                        if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) { dead = true; break; }
+                        if (r < 0) break;
+                    }
+                    const int64_t now = steady_ns();
+                    std::string_view msg;
+                    if (cfg.binary) {
+                        while (true) {
+                            const std::string_view p = k->in.pending();
+                            const size_t len = binFrameLength(p);
+                            if (len == 0 || len == kBinBadFrame) break;
+                            msg = p.substr(0, len);
+                            BinRespHeader h;
+                            if (msg.size() >= sizeof(h)) {
+                                std::memcpy(&h, msg.data(), sizeof(h));
+                                const size_t i = static_cast<size_t>(h.client_id - 1);
+                                if (binType(msg) == BinType::Ack) ack(k, i, now);
+                                else { finish(k, i, now); k->gen->observe_frame(msg); }
+                            }
+                            k->in.consume(len);
+                        }
+                    } else {
+                        while (k->in.nextLine(msg)) {
+                            if (msg.compare(0, 4, "ACK ") == 0) {
+                                ack(k, cfg.fifo ? static_cast<size_t>(k->acked) : line_tag(msg) - 1, now);
+                            } else {
+                                k->gen->observe_line(msg);
+                                const uint64_t t = cfg.fifo ? 0 : line_tag(msg);
+                                if (t) finish(k, static_cast<size_t>(t - 1), now);
+                            }
+                        }
+                    }
+                }
+                if (k->done == orders) { close_conn(k); continue; }
+                if (dead) { std::cerr << "Connection closed by exchange\n"; close_conn(k); continue; }
+                pump(k);
+            }
+        }
+        for (Conn* k : L.conns) if (k->fd >= 0) close_conn(k);
+        close(ep);
+    };
+
+    const int64_t t0 = steady_ns();
+    std::vector<std::thread> ts;
+    for (auto& L : loops) ts.emplace_back(loop_main, std::ref(L));
+    for (auto& t : ts) t.join();
+    const double wall_s = static_cast<double>(steady_ns() - t0) / 1e9;
+
+    LatencyHistogram ack, done;
+    FlowStats flow;
+    long long completed = 0;
+    for (auto& L : loops) { ack.merge(L.ack); done.merge(L.done); completed += L.completed; }
+    for (auto& k : conns) flow.merge(k.gen->flow_stats());
+    const long long total = static_cast<long long>(cfg.connections) * orders;
+
+    std::printf("Async: %d connections on %zu thread(s), %d in flight each, %s matching\n",
+                cfg.connections, loops.size(), cfg.inflight, cfg.fifo ? "FIFO ACK" : "tag");
+    std::printf("Completed %lld of %lld orders in %.2f s: %.0f orders/s\n",
+                completed, total, wall_s, static_cast<double>(completed) / wall_s);
+    if (cfg.flow) print_flow_stats(flow);
+    if (!completed) { std::cout << "No samples collected.\n"; return 1; }
+
+    const double pcts[] = {50, 90, 99, 99.9, 99.99};
+    std::printf("%-16s %9s %9s %9s %9s %9s %9s %9s\n", "latency (us)", "p50", "p90", "p99", "p99.9", "p99.99", "max", "mean");
+    auto row = [&](const char* name, const LatencyHistogram& h) {
+        std::printf("%-16s", name);
+        for (double p : pcts) std::printf(" %9.1f", static_cast<double>(h.percentile(p)) / 1000.0);
+        std::printf(" %9.1f %9.1f\n", static_cast<double>(h.max()) / 1000.0, h.mean() / 1000.0);
+    };
+    row("ack", ack);
+    if (!cfg.fifo) row("engine reply", done);
+
+    if (!cfg.hist_path.empty()) {
+        std::ofstream out(cfg.hist_path);
+        done.writePercentiles(out, 1000.0);
+        std::cout << "Wrote " << cfg.hist_path << " (" << (cfg.fifo ? "ack" : "engine reply") << " time, us)\n";
+    }
+    if (!cfg.csv_path.empty()) {
+        std::ofstream csv(cfg.csv_path);
+        csv << "percentile,value_us\n";
+        for (double p : pcts) csv << "p" << p << "," << static_cast<double>(done.percentile(p)) / 1000.0 << "\n";
+        csv << "max," << static_cast<double>(done.max()) / 1000.0 << "\n";
+        std::cout << "Wrote " << cfg.csv_path << "\n";
     }
-    return true;
+    return completed == total ? 0 : 1;
 }
 
 int main(int argc, char** argv) {
@@ -90,17 +601,63 @@ int main(int argc, char** argv) {
     // NEW demo flags
     bool demoBuy  = false; // seed asks then lift them
     bool demoSell = false; // seed bids then hit them
+    bool binary   = false; // use the binary order-entry protocol
+    int  symbols  = 0;     // spread orders over SYM0..SYM<n-1> (0 = default book)
+    double rate   = 0;     // --rate N[/s]: open loop at N orders/s in total
+    bool poisson  = false; // --arrivals constant|poisson
+    std::string histPath;  // --hist file: histogram export (open loop / async)
+    bool async    = false; // --async: pipelined connections on epoll threads
+    int  threads  = 2;     // --threads N event-loop threads (async)
+    int  inflight = 8;     // --inflight K orders outstanding per connection (async)
+    bool fifo     = false; // --match tag|fifo (async)
+    bool useFlow  = false; // --flow / --scenario FILE: NEW/CXL/MOD order-flow model
+    FlowConfig flowCfg;
+    std::string scenario;
+    long long seed = -1;   // --seed N (order-flow model)
 
-    // Args: [clients] [orders] [--csv file] [--demo-buy] [--demo-sell]
+    // Args: [clients] [orders] [--csv file] [--demo-buy] [--demo-sell] [--binary] [--symbols N]
+    //       [--rate N[/s]] [--arrivals constant|poisson] [--hist file]
+    //       [--async] [--threads N] [--inflight K] [--match tag|fifo]
+    //       [--flow] [--scenario file] [--seed N]
     for (int i=1; i<argc; ++i) {
         std::string a = argv[i];
         if (a == "--csv" && i+1 < argc) csvPath = argv[++i];
         else if (a == "--demo-buy")  demoBuy  = true;
         else if (a == "--demo-sell") demoSell = true;
+        else if (a == "--binary")    binary   = true;
+        else if (a == "--symbols" && i+1 < argc) symbols = std::atoi(argv[++i]);
+        else if (a == "--rate" && i+1 < argc) rate = std::atof(argv[++i]);
+        else if (a == "--arrivals" && i+1 < argc) {
+            std::string m = argv[++i];
+            if (m == "poisson")       poisson = true;
+            else if (m == "constant") poisson = false;
+            else { std::cerr << "Unknown --arrivals " << m << " (use constant|poisson)\n"; return 1; }
+        }
+        else if (a == "--hist" && i+1 < argc) histPath = argv[++i];
+        else if (a == "--async") async = true;
+        else if (a == "--threads" && i+1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--inflight" && i+1 < argc) inflight = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--match" && i+1 < argc) {
+            std::string m = argv[++i];
+            if (m == "fifo")     fifo = true;
+            else if (m == "tag") fifo = false;
+            else { std::cerr << "Unknown --match " << m << " (use tag|fifo)\n"; return 1; }
+        }
+        else if (a == "--flow") useFlow = true;
+        else if (a == "--scenario" && i+1 < argc) { scenario = argv[++i]; useFlow = true; }
+        else if (a == "--seed" && i+1 < argc) seed = std::atoll(argv[++i]);
         else if (i == 1 && a.rfind("--",0) != 0) { clients = std::atoi(argv[i]); }
         else if (i == 2 && a.rfind("--",0) != 0) { orders  = std::atoi(argv[i]); }
     }
 
+    if (!scenario.empty()) {
+        std::string err;
+        if (!loadFlowConfig(scenario, flowCfg, err)) { std::cerr << err << "\n"; return 1; }
+    }
+    if (seed >= 0) flowCfg.seed = static_cast<uint64_t>(seed);
+    if (symbols > 0) flowCfg.symbols = symbols;
+    const FlowConfig* flow = useFlow ? &flowCfg : nullptr;
+
     // --- OPTIONAL DEMO PRELUDE ---
     if (demoBuy || demoSell) {
         int s = socket(AF_INET, SOCK_STREAM, 0);
@@ -111,17 +668,18 @@ int main(int argc, char** argv) {
             sockaddr_in a{}; a.sin_family = AF_INET; a.sin_port = htons(port);
             inet_pton(AF_INET, host.c_str(), &a.sin_addr);
             if (connect(s, (sockaddr*)&a, sizeof(a)) == 0) {
+                LineReader reader;
                 // BUY demo: create resting asks, then send BUY that crosses
                 if (demoBuy) {
-                    send_and_wait_ack(s, "NEW SELL 200 @ 50.30\n");
-                    send_and_wait_ack(s, "NEW SELL 200 @ 50.28\n");
-                    send_and_wait_ack(s, "NEW BUY  350 @ 50.35\n");   // ⇒ TRADE BUY ...
+                    send_and_wait_ack(s, reader, "NEW SELL 200 @ 50.30\n");
+                    send_and_wait_ack(s, reader, "NEW SELL 200 @ 50.28\n");
+                    send_and_wait_ack(s, reader, "NEW BUY  350 @ 50.35\n");   // ⇒ TRADE BUY ...
                 }
                 // SELL demo: create resting bids, then send SELL that crosses
                 if (demoSell) {
-                    send_and_wait_ack(s, "NEW BUY  200 @ 50.20\n");
-                    send_and_wait_ack(s, "NEW BUY  200 @ 50.18\n");
-                    send_and_wait_ack(s, "NEW SELL 350 @ 50.15\n");   // ⇒ TRADE SELL ...
+                    send_and_wait_ack(s, reader, "NEW BUY  200 @ 50.20\n");
+                    send_and_wait_ack(s, reader, "NEW BUY  200 @ 50.18\n");
+                    send_and_wait_ack(s, reader, "NEW SELL 350 @ 50.15\n");   // ⇒ TRADE SELL ...
                 }
                 const char* bye = "QUIT\n"; (void)send(s, bye, strlen(bye), 0);
             }
@@ -130,9 +688,20 @@ int main(int argc, char** argv) {
         return 0; // exit after demo; remove this 'return' if you want to run load test too
     }
 
-    // --- NORMAL LOAD TEST BELOW (unchanged) ---
+    if (async) {
+        return run_async(AsyncConfig{host, port, clients, orders, threads, inflight, fifo, binary, symbols,
+                                     csvPath, histPath, flow});
+    }
+    if (rate > 0) {
+        return run_open_loop(OpenLoopConfig{host, port, clients, orders, rate, poisson, binary, symbols,
+                                            csvPath, histPath, flow});
+    }
+
+    // --- NORMAL LOAD TEST BELOW (closed loop) ---
     std::vector<std::thread> ts;
     std::vector<std::vector<long long>> perThread(clients);
+    FlowStats flowStats;
+    std::mutex flowMu;
 
     auto worker_collect = [&](int id){
         int s = socket(AF_INET, SOCK_STREAM, 0);
@@ -144,23 +713,25 @@ int main(int argc, char** argv) {
         inet_pton(AF_INET, host.c_str(), &a.sin_addr);
         if (connect(s, (sockaddr*)&a, sizeof(a)) < 0) { close(s); return; }
 
-        std::mt19937_64 rng(id * 1337ULL);
-        std::uniform_int_distribution<int> side_dist(0,1);
-        std::uniform_int_distribution<int> qty_dist(1, 200);
-        std::uniform_int_distribution<int> pips_dist(-20, 20);
+        OrderGen gen(id * 1337ULL, symbols, flow);
         perThread[id].reserve(orders);
+        LineReader reader;
+
+        if (binary) {
+            const char magic = static_cast<char>(kBinaryMagic);
+            if (send(s, &magic, 1, 0) < 0) { close(s); return; }
+        }
 
         for (int i=0; i<orders; ++i) {
-            double px = 50.25 + pips_dist(rng) * 0.01;
-            int qty = qty_dist(rng);
-            std::string side = side_dist(rng) ? "BUY" : "SELL";
-            std::string line = "NEW " + side + " " + std::to_string(qty) + " @ " + std::to_string(px) + "\n";
+            std::string line;
+            gen.next(i, binary, line);
 
             auto t0 = std::chrono::high_resolution_clock::now();
-            if (send(s, line.c_str(), line.size(), 0) < 0) break;
+            if (send(s, line.data(), line.size(), 0) < 0) break;
 
-            std::string resp;
-            if (!read_line_fd(s, resp, false)) { close(s); return; }
+            std::string_view resp;
+            const bool got = binary ? read_frame_fd(s, reader, resp) : read_line_fd(s, reader, resp);
+            if (!got) { close(s); return; }
             auto t1 = std::chrono::high_resolution_clock::now();
             long long rtt = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
             perThread[id].push_back(rtt);
@@ -169,13 +740,27 @@ int main(int argc, char** argv) {
             send_udp("RTT " + std::to_string(rtt) + "\n", "127.0.0.1", 9001);
 
             struct timeval tv{0, 2000}; setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-            std::string tmp; while (true) { if (!read_line_fd(s, tmp, true)) break; if (tmp.empty()) break; }
+            std::string_view tmp;
+            if (binary) { while (read_frame_fd(s, reader, tmp)) gen.observe_frame(tmp); }
+            else { while (true) { if (!read_line_fd(s, reader, tmp)) break; if (tmp.empty()) break; gen.observe_line(tmp); } }
+        }
+        {
+            std::lock_guard<std::mutex> lk(flowMu);
+            flowStats.merge(gen.flow_stats());
+        }
+        if (binary) {
+            BinQuit q; binInit(q, BinType::Quit);
+            (void)send(s, &q, sizeof(q), 0);
+        } else {
+            const char* bye = "QUIT\n"; (void)send(s, bye, strlen(bye), 0);
         }
-        const char* bye = "QUIT\n"; (void)send(s, bye, strlen(bye), 0); close(s);
+        close(s);
     };
 
+    const auto wall0 = std::chrono::steady_clock::now();
     for (int i=0; i<clients; ++i) ts.emplace_back(worker_collect, i);
     for (auto& t : ts) t.join();
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
 
     // Merge all RTT samples
     std::vector<long long> samples;
@@ -183,6 +768,7 @@ int main(int argc, char** argv) {
     samples.reserve(total);
     for (auto& v : perThread) { samples.insert(samples.end(), v.begin(), v.end()); }
 
+    if (flow) print_flow_stats(flowStats);
     if (samples.empty()) { std::cout << "No samples collected.\n"; return 1; }
 
     // Percentiles
@@ -195,7 +781,8 @@ int main(int argc, char** argv) {
               << "p50: " << p50 << " us\n"
               << "p95: " << p95 << " us\n"
               << "p99: " << p99 << " us\n"
-              << "max: " << pmax << " us\n";
+              << "max: " << pmax << " us\n"
+              << "Throughput: " << static_cast<long long>(samples.size() / wall_s) << " orders/s\n";
 
     if (!csvPath.empty()) {
         std::ofstream csv(csvPath);
@@ -1,3 +1,5 @@
+#include "line_reader.hpp"
+
 #include <arpa/inet.h>
 #include <chrono>
 #include <cerrno>
@@ -13,21 +15,17 @@ static void set_recv_timeout(int sock, int millis) {
     setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 }
 
-static int read_line(int fd, std::string& line) {
-    line.clear();
-    char ch = 0;
-    while (true) {
-        ssize_t n = recv(fd, &ch, 1, 0);
-        if (n == 0)  return -1; // EOF
-        if (n < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0; // timeout
-            perror("recv"); return -1;
-        }
-        if (ch == '\n') break;
-        line.push_back(ch);
-        if (line.size() > 8192) { std::cerr << "Line too long\n"; return -1; }
+// 1 = got a line, 0 = timeout, -1 = EOF/error
+static int read_line(int fd, LineReader& reader, std::string& line) {
+    std::string_view sv;
+    switch (reader.readLine(fd, sv)) {
+        case LineReader::Status::Line:    line.assign(sv.data(), sv.size()); return 1;
+        case LineReader::Status::Again:   return 0; // timeout
+        case LineReader::Status::Closed:  return -1; // EOF
+        case LineReader::Status::TooLong: std::cerr << "Line too long\n"; return -1;
+        case LineReader::Status::Error:   perror("recv"); return -1;
     }
-    return 1;
+    return -1;
 }
 
 static long long parse_ack_ts(const std::string& s) {
@@ -50,9 +48,10 @@ int main() {
     if (connect(sock, (sockaddr*)&serv, sizeof(serv)) < 0) { perror("connect"); return 1; }
 
     set_recv_timeout(sock, 100); // to drain trailing lines without blocking forever
+    LineReader reader;
 
     std::cout << "Connected. Type orders like:\n";
-    std::cout << "  NEW BUY 100 @ 50.25\n  NEW SELL 60 @ 50.10\n  QUIT\n\n";
+    std::cout << "  NEW BUY 100 @ 50.25\n  NEW SELL 60 @ 50.10\n  NEW AAPL BUY 10 @ 190.00\n  QUIT\n\n";
 
     std::string user;
     while (true) {
@@ -69,7 +68,7 @@ int main() {
         // Wait for first line (ACK …)
         std::string line;
         while (true) {
-            int rc = read_line(sock, line);
+            int rc = read_line(sock, reader, line);
             if (rc == -1) { std::cout << "Server closed.\n"; close(sock); return 0; }
             if (rc ==  1) break; // got a line
             // rc == 0 -> timeout, keep waiting for ACK
@@ -85,7 +84,7 @@ int main() {
 
         // Drain any extra lines from server for this order
         while (true) {
-            int rc = read_line(sock, line);
+            int rc = read_line(sock, reader, line);
             if (rc == 1) {
                 if (!line.empty()) std::cout << line << "\n";
                 if (line == "BYE") { close(sock); return 0; }
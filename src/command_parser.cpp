@@ -0,0 +1,201 @@
+#include "command_parser.hpp"
+
+#include <charconv>
+#include <climits>
+
+static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Cursor over the line. A word runs to the next space; a number stops early
+// at '@' so "10@50.25" reads like "10 @ 50.25".
+struct CmdScanner {
+    std::string_view s;
+    size_t i = 0;
+
+    void skipSpace() { while (i < s.size() && isSpace(s[i])) ++i; }
+    bool atEnd() { skipSpace(); return i == s.size(); }
+    std::string_view word() {
+        skipSpace();
+        const size_t b = i;
+        while (i < s.size() && !isSpace(s[i])) ++i;
+        return s.substr(b, i - b);
+    }
+    std::string_view number() {
+        skipSpace();
+        const size_t b = i;
+        while (i < s.size() && !isSpace(s[i]) && s[i] != '@') ++i;
+        return s.substr(b, i - b);
+    }
+    bool at() {
+        skipSpace();
+        if (i == s.size() || s[i] != '@') return false;
+        ++i;
+        return true;
+    }
+};
+
+// Strictly digits, no sign, and within [1, max].
+template <class T>
+static bool parsePositive(std::string_view t, T& out) {
+    if (t.empty() || !isDigit(t[0])) return false;
+    const auto r = std::from_chars(t.data(), t.data() + t.size(), out);
+    return r.ec == std::errc() && r.ptr == t.data() + t.size() && out > 0;
+}
+
+PriceStatus parsePriceTicks(std::string_view text, int64_t tick_factor, int64_t& ticks) {
+    size_t i = 0;
+    int64_t whole = 0;
+    bool digits = false;
+    for (; i < text.size() && isDigit(text[i]); ++i, digits = true) {
+        if (__builtin_mul_overflow(whole, 10, &whole) || __builtin_add_overflow(whole, text[i] - '0', &whole))
+            return PriceStatus::OutOfRange;
+    }
+    std::string_view frac;
+    if (i < text.size() && text[i] == '.') {
+        const size_t b = ++i;
+        while (i < text.size() && isDigit(text[i])) ++i;
+        frac = text.substr(b, i - b);
+        digits |= !frac.empty();
+    }
+    if (!digits || i != text.size()) return PriceStatus::Bad;
+
+    while (!frac.empty() && frac.back() == '0') frac.remove_suffix(1);
+    if (frac.size() > 18) return PriceStatus::TooFine;
+    int64_t f = 0, scale = 1;
+    for (char c : frac) { f = f * 10 + (c - '0'); scale *= 10; }
+    // frac / scale of a unit must be a whole number of 1/tick_factor ticks.
+    const __int128 num = static_cast<__int128>(f) * tick_factor;
+    if (num % scale) return PriceStatus::TooFine;
+
+    int64_t t = 0;
+    if (__builtin_mul_overflow(whole, tick_factor, &t) ||
+        __builtin_add_overflow(t, static_cast<int64_t>(num / scale), &t))
+        return PriceStatus::OutOfRange;
+    if (t <= 0) return PriceStatus::Bad;
+    ticks = t;
+    return PriceStatus::Ok;
+}
+
+static CmdStatus priceStatus(PriceStatus p) {
+    switch (p) {
+        case PriceStatus::Ok:         return CmdStatus::Ok;
+        case PriceStatus::TooFine:    return CmdStatus::PriceTooFine;
+        case PriceStatus::OutOfRange: return CmdStatus::PriceOutOfRange;
+        case PriceStatus::Bad:        break;
+    }
+    return CmdStatus::BadPrice;
+}
+
+CmdStatus parseCommand(std::string_view line, int64_t tick_factor, Command& cmd, std::string_view& bad) {
+    CmdScanner s{line};
+    bad = {};
+    const std::string_view verb = s.word();
+    cmd = Command{};
+    if (verb == "QUIT") {
+        cmd.type = CmdType::Quit;
+        if (!s.atEnd()) { bad = s.word(); return CmdStatus::TrailingInput; }
+        return CmdStatus::Ok;
+    }
+    CmdStatus usage;
+    if (verb == "NEW")      { cmd.type = CmdType::New;    usage = CmdStatus::BadNew; }
+    else if (verb == "CXL") { cmd.type = CmdType::Cancel; usage = CmdStatus::BadCancel; }
+    else if (verb == "MOD") { cmd.type = CmdType::Modify; usage = CmdStatus::BadModify; }
+    else return CmdStatus::UnknownCommand;
+
+    // The optional symbol sits where the side / order id would be; it is
+    // told apart by starting with a letter.
+    std::string_view tok = s.word();
+    if (!tok.empty() && tok != "BUY" && tok != "SELL" && tok[0] >= 'A' && tok[0] <= 'Z') {
+        if (!encodeSymbol(tok, cmd.symbol)) { bad = tok; return CmdStatus::BadSymbol; }
+        tok = s.word();
+    }
+    if (tok.empty()) return usage;
+
+    if (cmd.type == CmdType::New) {
+        if (tok == "BUY") cmd.side = Side::Buy;
+        else if (tok == "SELL") cmd.side = Side::Sell;
+        else { bad = tok; return usage; }
+    } else if (!parsePositive(tok, cmd.order_id)) {
+        bad = tok;
+        return CmdStatus::BadOrderId;
+    }
+
+    if (cmd.type != CmdType::Cancel) {
+        const std::string_view qty = s.number();
+        if (qty.empty()) return usage;
+        if (!parsePositive(qty, cmd.qty)) { bad = qty; return CmdStatus::BadQty; }
+        if (!s.at()) return usage;
+        const std::string_view px = s.word();
+        if (px.empty()) return usage;
+        const CmdStatus st = priceStatus(parsePriceTicks(px, tick_factor, cmd.price_ticks));
+        if (st != CmdStatus::Ok) { bad = px; return st; }
+    }
+    if (!s.atEnd()) { bad = s.word(); return CmdStatus::TrailingInput; }
+    return CmdStatus::Ok;
+}
+
+// "0.01" for a power-of-ten tick factor, else "1/<factor>".
+static void appendTick(int64_t tick_factor, std::string& out) {
+    int64_t p = 1;
+    int decimals = 0;
+    while (p < tick_factor && p <= INT64_MAX / 10) { p *= 10; ++decimals; }
+    if (p != tick_factor) { out += "1/"; out += std::to_string(tick_factor); return; }
+    if (decimals == 0) { out += '1'; return; }
+    out += "0.";
+    out.append(static_cast<size_t>(decimals - 1), '0');
+    out += '1';
+}
+
+void appendCommandError(CmdStatus st, std::string_view bad, int64_t tick_factor, std::string& out) {
+    switch (st) {
+        case CmdStatus::Ok:
+            break;
+        case CmdStatus::UnknownCommand:
+            out += "ERROR Unknown command. Use NEW/CXL/MOD/QUIT.";
+            break;
+        case CmdStatus::BadSymbol:
+            out += "ERROR Invalid symbol ";
+            out += bad;
+            break;
+        case CmdStatus::BadNew:
+            out += "ERROR Invalid NEW. Expected: NEW [SYMBOL] BUY|SELL <qty> @ <price>";
+            break;
+        case CmdStatus::BadCancel:
+            out += "ERROR Invalid CXL. Expected: CXL [SYMBOL] <order_id>";
+            break;
+        case CmdStatus::BadModify:
+            out += "ERROR Invalid MOD. Expected: MOD [SYMBOL] <order_id> <new_qty> @ <new_price>";
+            break;
+        case CmdStatus::BadQty:
+            out += "ERROR Invalid quantity ";
+            out += bad;
+            out += ": expected a whole number from 1 to 2147483647";
+            break;
+        case CmdStatus::BadOrderId:
+            out += "ERROR Invalid order id ";
+            out += bad;
+            out += ": expected a positive whole number";
+            break;
+        case CmdStatus::BadPrice:
+            out += "ERROR Invalid price ";
+            out += bad;
+            out += ": expected a positive decimal";
+            break;
+        case CmdStatus::PriceTooFine:
+            out += "ERROR Invalid price ";
+            out += bad;
+            out += ": finer than the tick size ";
+            appendTick(tick_factor, out);
+            break;
+        case CmdStatus::PriceOutOfRange:
+            out += "ERROR Invalid price ";
+            out += bad;
+            out += ": out of range";
+            break;
+        case CmdStatus::TrailingInput:
+            out += "ERROR Unexpected ";
+            out += bad;
+            out += " at end of command";
+            break;
+    }
+}
@@ -0,0 +1,94 @@
+#include "cpu_affinity.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+bool parseCpuList(std::string_view text, std::vector<int>& cpus) {
+    cpus.clear();
+    while (!text.empty()) {
+        const size_t comma = text.find(',');
+        const std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+        if (comma != std::string_view::npos && text.empty()) return false;   // trailing ','
+
+        int lo = 0, hi = 0;
+        const char* end = item.data() + item.size();
+        auto r = std::from_chars(item.data(), end, lo);
+        if (r.ec != std::errc() || lo < 0) return false;
+        hi = lo;
+        if (r.ptr != end) {
+            if (*r.ptr != '-') return false;
+            r = std::from_chars(r.ptr + 1, end, hi);
+            if (r.ec != std::errc() || r.ptr != end || hi < lo) return false;
+        }
+        if (hi >= 4096) return false;
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    return !cpus.empty();
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    std::string s;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        if (i) s += ',';
+        s += std::to_string(cpus[i]);
+    }
+    return s;
+}
+
+#if defined(__linux__)
+
+std::vector<int> allowedCpus() {
+    std::vector<int> out;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return out;
+    for (int c = 0; c < CPU_SETSIZE; ++c)
+        if (CPU_ISSET(c, &set)) out.push_back(c);
+    return out;
+}
+
+std::string placeThisThread(const char* name, const ThreadPlacement& p) {
+    const pthread_t self = pthread_self();
+    if (name) {
+        char n[16];
+        std::strncpy(n, name, sizeof(n) - 1);
+        n[sizeof(n) - 1] = '\0';
+        pthread_setname_np(self, n);
+    }
+    std::string err;
+    if (p.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(p.cpu, &set);
+        if (const int e = pthread_setaffinity_np(self, sizeof(set), &set))
+            err = "pinning to CPU " + std::to_string(p.cpu) + " failed (" + std::strerror(e) + "), not pinned";
+    }
+    if (p.fifo_priority > 0) {
+        sched_param sp{};
+        sp.sched_priority = p.fifo_priority;
+        if (const int e = pthread_setschedparam(self, SCHED_FIFO, &sp)) {
+            if (!err.empty()) err += "; ";
+            err += "SCHED_FIFO " + std::to_string(p.fifo_priority) + " refused (" + std::strerror(e) +
+                   "), running SCHED_OTHER";
+        }
+    }
+    return err;
+}
+
+#else
+
+std::vector<int> allowedCpus() { return {}; }
+
+std::string placeThisThread(const char*, const ThreadPlacement& p) {
+    if (p.cpu < 0 && p.fifo_priority <= 0) return {};
+    return "thread placement is only supported on Linux, running unpinned SCHED_OTHER";
+}
+
+#endif
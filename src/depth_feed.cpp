@@ -0,0 +1,159 @@
+#include "depth_feed.hpp"
+#include "line_reader.hpp"
+#include "wall_clock.hpp"
+
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static MdLevelMsg levelRecord(MdType type, Side side, SymbolId symbol, uint64_t ts_ns,
+                              const LevelInfo& l) {
+    MdLevelMsg r;
+    std::memset(&r, 0, sizeof(r));
+    r.type        = static_cast<uint8_t>(type);
+    r.side        = side == Side::Buy ? 0 : 1;
+    r.count       = static_cast<uint32_t>(l.count);
+    r.ts_ns       = ts_ns;
+    r.symbol      = symbol;
+    r.price_ticks = l.price_ticks;
+    r.qty         = l.qty;
+    return r;
+}
+
+size_t DepthTracker::update(const OrderBook& book, SymbolId symbol, uint64_t ts_ns,
+                            std::vector<MdLevelMsg>& out) {
+    const size_t before = out.size();
+    for (int s = 0; s < 2; ++s) {
+        const Side side = s == 0 ? Side::Buy : Side::Sell;
+        std::vector<LevelInfo>& last = last_[s];
+        cur_.clear();
+        book.depth(side, depth_, cur_);
+
+        // Both lists are short (<= depth_) and best-first.
+        for (const LevelInfo& c : cur_) {
+            const LevelInfo* prev = nullptr;
+            for (const LevelInfo& l : last) if (l.price_ticks == c.price_ticks) { prev = &l; break; }
+            if (!prev)
+                out.push_back(levelRecord(MdType::LevelNew, side, symbol, ts_ns, c));
+            else if (prev->qty != c.qty || prev->count != c.count)
+                out.push_back(levelRecord(MdType::LevelUpdate, side, symbol, ts_ns, c));
+        }
+        for (const LevelInfo& l : last) {
+            bool kept = false;
+            for (const LevelInfo& c : cur_) if (c.price_ticks == l.price_ticks) { kept = true; break; }
+            if (!kept)
+                out.push_back(levelRecord(MdType::LevelDelete, side, symbol, ts_ns,
+                                          LevelInfo{l.price_ticks, 0, 0}));
+        }
+        last.swap(cur_);
+    }
+    return out.size() - before;
+}
+
+void mdSnapshotRecords(SymbolId symbol, uint64_t ts_ns, uint16_t channel, uint64_t ref_seq,
+                       size_t depth, const std::vector<LevelInfo>& bids, const std::vector<LevelInfo>& asks,
+                       std::vector<MdLevelMsg>& out) {
+    MdLevelMsg begin = levelRecord(MdType::SnapshotBegin, Side::Buy, symbol, ts_ns, LevelInfo{});
+    begin.channel = channel;
+    begin.count   = static_cast<uint32_t>(bids.size() + asks.size());
+    begin.ref_seq = ref_seq;
+    begin.qty     = static_cast<int64_t>(depth);
+    out.push_back(begin);
+    for (const LevelInfo& l : bids) out.push_back(levelRecord(MdType::SnapshotLevel, Side::Buy, symbol, ts_ns, l));
+    for (const LevelInfo& l : asks) out.push_back(levelRecord(MdType::SnapshotLevel, Side::Sell, symbol, ts_ns, l));
+    out.push_back(levelRecord(MdType::SnapshotEnd, Side::Buy, symbol, ts_ns, LevelInfo{}));
+}
+
+void DepthCache::store(SymbolId symbol, uint16_t channel, uint64_t seq, size_t depth,
+                       const std::vector<LevelInfo>& bids, const std::vector<LevelInfo>& asks) {
+    std::lock_guard<std::mutex> lk(m_);
+    Entry& e = books_[symbol];
+    e.channel = channel;
+    e.seq = seq;
+    e.depth = depth;
+    e.bids.assign(bids.begin(), bids.end());
+    e.asks.assign(asks.begin(), asks.end());
+}
+
+size_t DepthCache::snapshot(bool all, SymbolId symbol, uint64_t ts_ns, std::vector<MdLevelMsg>& out) const {
+    std::lock_guard<std::mutex> lk(m_);
+    if (!all) {
+        auto it = books_.find(symbol);
+        if (it == books_.end()) return 0;
+        const Entry& e = it->second;
+        mdSnapshotRecords(symbol, ts_ns, e.channel, e.seq, e.depth, e.bids, e.asks, out);
+        return 1;
+    }
+    for (const auto& kv : books_)
+        mdSnapshotRecords(kv.first, ts_ns, kv.second.channel, kv.second.seq, kv.second.depth,
+                          kv.second.bids, kv.second.asks, out);
+    return books_.size();
+}
+
+bool SnapshotServer::start() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) { perror("socket"); return false; }
+    int yes = 1; setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr{}; addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port_);
+    if (bind(listen_fd_, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 16) < 0) {
+        perror("snapshot server");
+        close(listen_fd_); listen_fd_ = -1;
+        return false;
+    }
+    running_ = true;
+    thr_ = std::thread(&SnapshotServer::run, this);
+    return true;
+}
+
+void SnapshotServer::stop() {
+    if (!running_.exchange(false)) return;
+    shutdown(listen_fd_, SHUT_RDWR);   // wakes accept()
+    if (thr_.joinable()) thr_.join();
+    close(listen_fd_); listen_fd_ = -1;
+}
+
+void SnapshotServer::run() {
+    while (running_) {
+        const int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) { if (!running_) break; continue; }
+        serve(fd);
+        close(fd);
+    }
+}
+
+void SnapshotServer::serve(int fd) {
+    timeval tv{1, 0};   // one slow client must not stall the others for long
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    LineReader in(256);
+    std::string_view line;
+    if (in.readLine(fd, line) != LineReader::Status::Line) return;
+
+    const std::string_view cmd = "SNAPSHOT";
+    if (line.substr(0, cmd.size()) != cmd) return;
+    std::string_view arg = line.substr(cmd.size());
+    while (!arg.empty() && arg.front() == ' ') arg.remove_prefix(1);
+    while (!arg.empty() && (arg.back() == ' ' || arg.back() == '\r')) arg.remove_suffix(1);
+
+    SymbolId symbol = kDefaultSymbol;
+    if (!arg.empty() && arg != "-" && !encodeSymbol(arg, symbol)) return;
+
+    std::vector<MdLevelMsg> recs;
+    cache_.snapshot(arg.empty(), symbol, wall_ns(), recs);
+
+    const char* p = reinterpret_cast<const char*>(recs.data());
+    size_t left = recs.size() * sizeof(MdLevelMsg);
+    while (left) {
+        const ssize_t w = send(fd, p, left, MSG_NOSIGNAL);
+        if (w <= 0) return;
+        p += w; left -= static_cast<size_t>(w);
+    }
+}
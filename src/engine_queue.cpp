@@ -1,8 +1,11 @@
 #include "engine_queue.hpp"
 
-OrderQueue::OrderQueue(size_t capacity) : capacity_(capacity) {}
+OrderQueue::OrderQueue(size_t capacity, QueueKind kind, WaitPolicy wait) : capacity_(capacity) {
+    if (kind == QueueKind::Mpsc) ring_ = std::make_unique<MpscRing<OrderMsg>>(capacity, wait);
+}
 
 bool OrderQueue::push(const OrderMsg& msg) {
+    if (ring_) return ring_->push(msg);
     std::unique_lock<std::mutex> lk(m_);
     cv_not_full_.wait(lk, [&]{ return stop_ || q_.size() < capacity_; });
     if (stop_) return false;
@@ -12,6 +15,7 @@ bool OrderQueue::push(const OrderMsg& msg) {
 }
 
 std::optional<OrderMsg> OrderQueue::pop() {
+    if (ring_) return ring_->pop();
     std::unique_lock<std::mutex> lk(m_);
     cv_not_empty_.wait(lk, [&]{ return stop_ || !q_.empty(); });
     if (q_.empty()) return std::nullopt; // stopped and drained
@@ -21,9 +25,23 @@ std::optional<OrderMsg> OrderQueue::pop() {
     return m;
 }
 
+size_t OrderQueue::popBatch(OrderMsg* out, size_t max) {
+    if (ring_) return ring_->popBatch(out, max);
+    std::unique_lock<std::mutex> lk(m_);
+    cv_not_empty_.wait(lk, [&]{ return stop_ || !q_.empty(); });
+    size_t n = 0;
+    while (n < max && !q_.empty()) {
+        out[n++] = q_.front();
+        q_.pop();
+    }
+    if (n) cv_not_full_.notify_all();
+    return n;
+}
+
 void OrderQueue::stop() {
+    if (ring_) { ring_->stop(); return; }
     std::lock_guard<std::mutex> lk(m_);
     stop_ = true;
     cv_not_empty_.notify_all();
     cv_not_full_.notify_all();
-}
\ No newline at end of file
+}
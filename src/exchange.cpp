@@ -2,181 +2,619 @@
 #include "protocol.hpp"
 #include "engine_queue.hpp"
 #include "market_data.hpp"
+#include "reactor.hpp"
+#include "line_reader.hpp"
+#include "binary_protocol.hpp"
+#include "depth_feed.hpp"
+#include "md_publisher.hpp"
+#include "session.hpp"
+#include "journal.hpp"
+#include "latency_histogram.hpp"
+#include "stage_stats.hpp"
+#include "command_parser.hpp"
+#include "cpu_affinity.hpp"
+#include "wall_clock.hpp"
 
 #include <arpa/inet.h>
+#include <charconv>
 #include <chrono>
 #include <csignal>
-#include <cmath>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
+#include <memory>
 #include <atomic>
+#include <algorithm>
 #include <unistd.h>
 
 static std::atomic<bool> g_running{true};
 static int g_server_fd = -1;
 static std::atomic<int64_t> g_order_id{1};
+static Reactor* g_reactor = nullptr;
+static SessionTable* g_sessions = nullptr;
 
 static void handle_sigint(int) {
     g_running = false;
+    if (g_reactor) g_reactor->stop();
     if (g_server_fd >= 0) { close(g_server_fd); g_server_fd = -1; }
     std::cerr << "\n[Signal] SIGINT received. Shutting down server...\n";
 }
 
-static ssize_t safe_send(int fd, const void* buf, size_t len) {
-#ifdef MSG_NOSIGNAL
-    return send(fd, buf, len, MSG_NOSIGNAL);
-#elif defined(SO_NOSIGPIPE)
-    int one = 1; setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
-    return send(fd, buf, len, 0);
-#else
-    return send(fd, buf, len, 0);
-#endif
+// Queues bytes for a client; the session writer thread sends them. Replies to
+// a session that has since closed are dropped.
+static void reply(SessionId session, std::string_view data) {
+    if (g_sessions) (void)g_sessions->send(session, data);
 }
 
-// '\n'-terminated line reader; false on EOF/error
-static bool read_line(int fd, std::string& line) {
-    line.clear();
-    char ch = 0;
-    while (true) {
-        ssize_t n = recv(fd, &ch, 1, 0);
-        if (n == 0)  return false;
-        if (n < 0)  { perror("recv"); return false; }
-        if (ch == '\n') break;
-        line.push_back(ch);
-        if (line.size() > 8192) { line.clear(); return false; }
-    }
-    return true;
+// Engine thread settings (fixed at startup)
+struct EngineConfig {
+    int64_t    tick_factor = 100;
+    BookConfig book;
+    size_t     batch = 64;   // max messages taken from the queue per wake-up
+    bool       md_binary = false;      // sequenced binary feed instead of text lines
+    uint64_t   md_flush_ns = 100000;   // max time a binary MD message waits in a batch
+    size_t     md_depth = 0;           // >0: binary feed carries top-N level changes, not order events
+    uint64_t   md_snapshot_ns = 1000000000ULL;   // top-N snapshot interval (depth feed)
+    uint64_t   md_conflate_ns = 0;     // >0: BBO updates conflated per symbol (publisher thread)
+    size_t     shards = 1;             // engine threads; symbols are hashed across them
+    uint64_t   stage_dump_ns = 0;      // >0: each shard prints its stage histograms this often
+};
+
+// A book plus the depth last published for it (depth feed only).
+struct ShardBook {
+    OrderBook    book;
+    DepthTracker depth;
+    bool         dirty = false;   // depth changed since it was last stored in the cache
+    ShardBook(const BookConfig& cfg, size_t levels) : book(cfg), depth(levels) {}
+};
+
+// One inbound queue per engine shard; a symbol always maps to the same shard.
+using EngineQueues = std::vector<std::unique_ptr<OrderQueue>>;
+
+static MdWriterConfig mdWriterConfig(const EngineConfig& cfg) {
+    MdWriterConfig w;
+    w.binary      = cfg.md_binary;
+    w.flush_ns    = cfg.md_flush_ns;
+    w.conflate_ns = cfg.md_conflate_ns;
+    w.price       = PriceFormat(cfg.tick_factor);
+    return w;
 }
 
-// Engine loop: handle NEW / CANCEL / MODIFY; send TCP reply lines and UDP market‑data lines.
+// Engine loop (one per shard): handle NEW / CANCEL / MODIFY for every symbol
+// hashed to this shard; send TCP reply lines and hand market data to the
+// shard's MdWriter, either directly or through the publisher thread ('stage').
+// With the depth feed, 'cache' receives each changed book's levels per batch.
+// With a journal, the shard first replays its symbols' records, then journals
+// every batch before applying it. 'stages' gets every client message's
+// per-stage times and 'stats' every message's service time (STAGE_TIMING
+// builds; with it off neither is stamped).
 static void engine_loop(OrderQueue& q, std::atomic<bool>& running,
-                        int64_t tick_factor, const MarketDataPublisher* md) {
-    OrderBook book;
-
-    auto fmt_price = [tick_factor](int64_t ticks) -> std::string {
-        std::ostringstream oss;
-        oss.setf(std::ios::fixed); oss.precision(2);
-        oss << (static_cast<double>(ticks) / static_cast<double>(tick_factor));
-        return oss.str();
+                        const EngineConfig& cfg, const MarketDataPublisher* md, uint16_t shard,
+                        DepthCache* cache, MdPublisherThread* stage, LatencyHistogram* stats,
+                        Journal* journal, StageStats* stages) {
+    // Books are created on the first NEW for a symbol and owned by this thread.
+    std::unordered_map<SymbolId, std::unique_ptr<ShardBook>> books;
+    SymbolId   last_sym  = kDefaultSymbol;
+    ShardBook* last_book = nullptr;
+    auto book_for = [&](SymbolId sym, bool create) -> ShardBook* {
+        if (last_book && sym == last_sym) return last_book;
+        auto it = books.find(sym);
+        if (it == books.end()) {
+            if (!create) return nullptr;
+            it = books.emplace(sym, std::make_unique<ShardBook>(cfg.book, cfg.md_depth)).first;
+        }
+        last_sym = sym;
+        last_book = it->second.get();
+        return last_book;
+    };
+    const PriceFormat px(cfg.tick_factor);
+
+    BookEvents events;
+    events.reserve(256);
+    std::string payload, suffix;   // reused for every reply
+    std::vector<OrderMsg> batch(cfg.batch ? cfg.batch : 1);
+    const bool md_on = md && md->enabled();
+    const bool depth_feed = md_on && cfg.md_binary && cfg.md_depth > 0;
+    std::unique_ptr<MdWriter> writer;   // inline publishing when there is no stage
+    if (md_on && !stage) writer = std::make_unique<MdWriter>(*md, shard, mdWriterConfig(cfg));
+    std::vector<MdLevelMsg> levels;
+    std::vector<std::pair<SymbolId, ShardBook*>> dirty;
+    uint64_t last_snapshot = wall_ns();
+    uint64_t feed_seq = 0;   // binary feed: sequence number of the last item posted
+    uint64_t snap_seq = 0;   // snapshot channel, likewise
+
+    // Items are numbered here, whether or not the stage takes them, so a
+    // full ring leaves a gap on the wire instead of a silent hole.
+    MdItem item;
+    auto emit = [&](MdItem::Kind kind) {
+        item.kind = kind;
+        if (kind == MdItem::Kind::Event || kind == MdItem::Kind::Level) item.seq = ++feed_seq;
+        else if (kind == MdItem::Kind::Snapshot) item.seq = ++snap_seq;
+        if (stage) stage->post(shard, item);
+        else writer->handle(item);
+    };
+
+    // End of batch: publish, then record what subscribers have been sent.
+    auto end_batch = [&]() {
+        if (!md_on) return;
+        item.ts_ns = wall_ns();
+        emit(MdItem::Kind::Flush);
+        if (!depth_feed) return;
+        for (auto& d : dirty) {
+            const DepthTracker& dt = d.second->depth;
+            if (cache) cache->store(d.first, shard, feed_seq, dt.depth(), dt.levels(Side::Buy), dt.levels(Side::Sell));
+            d.second->dirty = false;
+        }
+        dirty.clear();
+
+        const uint64_t now = item.ts_ns;
+        if (now - last_snapshot < cfg.md_snapshot_ns) return;
+        last_snapshot = now;
+        for (const auto& kv : books) {
+            levels.clear();
+            const DepthTracker& dt = kv.second->depth;
+            mdSnapshotRecords(kv.first, now, shard, feed_seq, dt.depth(), dt.levels(Side::Buy),
+                              dt.levels(Side::Sell), levels);
+            for (const auto& r : levels) { item.rec = r; emit(MdItem::Kind::Snapshot); }
+        }
+        emit(MdItem::Kind::Flush);
+    };
+
+    // Depth feed: diff a book's top levels and queue them for the next end_batch().
+    auto track_depth = [&](SymbolId sym, ShardBook* sb, uint64_t ts) {
+        levels.clear();
+        if (sb->depth.update(sb->book, sym, ts, levels) && !sb->dirty) {
+            sb->dirty = true;
+            dirty.emplace_back(sym, sb);
+        }
     };
 
+    // Rebuild this shard's books from the journal. Replies and market data
+    // went out the first time; subscribers only get the resulting depth.
+    if (journal && journal->recovered()) {
+        size_t replayed = 0;
+        for (size_t i = 0; i < journal->recovered(); ++i) {
+            const JournalRecord& r = journal->record(i);
+            if (symbolShard(r.symbol, cfg.shards) != shard) continue;
+            ShardBook* sb = book_for(r.symbol, static_cast<JournalOp>(r.op) == JournalOp::New);
+            if (!sb) continue;
+            events.clear();
+            journalApply(sb->book, r, events);
+            ++replayed;
+        }
+        events.clear();
+        if (depth_feed) {
+            const uint64_t now = wall_ns();
+            for (auto& kv : books) {
+                track_depth(kv.first, kv.second.get(), now);
+                for (const auto& rec : levels) { item.rec = rec; emit(MdItem::Kind::Level); }
+            }
+        }
+        end_batch();
+        std::cout << "Shard " << shard << ": replayed " << replayed << " journal records into "
+                  << books.size() << " book(s)\n";
+    }
+
+    std::vector<uint8_t> journaled(batch.size(), 1);
+    bool journal_full = false;
+#if STAGE_TIMING
+    StageStats::Stamps st{};
+    uint64_t last_dump = stageNow();
+#else
+    (void)stages;
+    (void)stats;
+#endif
+
     while (running) {
-        auto mo = q.pop();
-        if (!mo.has_value()) break;
-        const OrderMsg& m = *mo;
-
-        std::vector<std::string> lines;
-        switch (m.type) {
-            case MsgType::New:
-                lines = book.processOrder(m.side, m.qty, m.price_ticks, m.order_id, fmt_price);
-                break;
-            case MsgType::Cancel:
-                lines = book.cancel(m.order_id, fmt_price);
-                break;
-            case MsgType::Modify:
-                // For modify, we re-use m.qty / m.price_ticks as new params, and generate new id now.
-                // Engine assigns new id so replacements are unique in the book history.
-                lines = book.replace(m.order_id, m.qty, m.price_ticks,
-                                     /*new_id*/ m.order_id, fmt_price);
-                break;
-        }
-
-        if (lines.empty()) continue;
-
-        std::ostringstream out;
-        for (auto& l : lines) {
-            out << l << "\n";
-            if (md && md->enabled()) md->sendLine(l);
-        }
-        const std::string payload = out.str();
-        (void)safe_send(m.client_fd, payload.c_str(), payload.size());
+        const size_t n = q.popBatch(batch.data(), batch.size());
+        if (n == 0) break; // stopped and drained
+#if STAGE_TIMING
+        st.dequeue = stageNow();
+#endif
+
+        // Write-ahead: the whole batch is journaled (and, with group commit,
+        // made durable) before any of it reaches a book or a client.
+        if (journal) {
+            uint64_t first = 0, last = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const OrderMsg& m = batch[i];
+                JournalRecord r{};
+                r.op          = static_cast<uint8_t>(m.type == MsgType::New    ? JournalOp::New
+                                                   : m.type == MsgType::Cancel ? JournalOp::Cancel
+                                                                               : JournalOp::Modify);
+                r.side        = m.side == Side::Buy ? 0 : 1;
+                r.shard       = shard;
+                r.qty         = static_cast<uint32_t>(m.qty);
+                r.ts_ns       = wall_ns();
+                r.symbol      = m.symbol;
+                r.price_ticks = m.price_ticks;
+                r.order_id    = m.order_id;
+                const uint64_t seq = journal->append(r);
+                journaled[i] = seq != 0;
+                if (!seq) continue;
+                if (!first) first = seq;
+                last = seq;
+            }
+            journal->commit(first, last);
+            if (!journal_full && !journaled[n - 1]) {
+                journal_full = true;
+                std::cerr << "Journal full: rejecting orders on shard " << shard << "\n";
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            const OrderMsg& m = batch[i];
+
+#if STAGE_TIMING
+            st.start = stageNow();
+#endif
+            events.clear();
+            ShardBook* sb = journaled[i] ? book_for(m.symbol, m.type == MsgType::New) : nullptr;
+            OrderBook* book = sb ? &sb->book : nullptr;
+            if (!journaled[i]) {
+                BookEvent ev;
+                ev.type = BookEventType::Reject;
+                ev.order_id = m.order_id;
+                ev.reason = RejectReason::JournalFull;
+                events.push_back(ev);
+            } else if (!book) {
+                // CXL / MOD for a symbol that has never traded here.
+                BookEvent ev;
+                ev.type = BookEventType::Reject;
+                ev.order_id = m.order_id;
+                ev.reason = RejectReason::UnknownOrderId;
+                events.push_back(ev);
+            } else switch (m.type) {
+                case MsgType::New:
+                    book->processOrder(m.side, m.qty, m.price_ticks, m.order_id, events);
+                    break;
+                case MsgType::Cancel:
+                    book->cancel(m.order_id, events);
+                    break;
+                case MsgType::Modify:
+                    // For modify, we re-use m.qty / m.price_ticks as new params, and generate new id now.
+                    // Engine assigns new id so replacements are unique in the book history.
+                    book->replace(m.order_id, m.qty, m.price_ticks,
+                                  /*new_id*/ m.order_id, events);
+                    break;
+            }
+#if STAGE_TIMING
+            st.matched = stageNow();
+#endif
+
+            if (events.empty()) continue;
+
+            // Market data leaves the engine as typed items; the MdWriter
+            // renders them. Depth records are computed here, next to the book.
+            const uint64_t ts = (m.binary || (md_on && cfg.md_binary)) ? wall_ns() : 0;
+            levels.clear();
+            if (depth_feed && sb) track_depth(m.symbol, sb, ts);
+            if (md_on) {
+                item.symbol = m.symbol;
+                item.ts_ns = ts;
+                for (const auto& ev : events) {
+                    // The depth feed carries trades; order events and the
+                    // touch are covered by the level records.
+                    if (depth_feed && ev.type != BookEventType::Trade) continue;
+                    if (cfg.md_binary && !mdPublishes(ev.type)) continue;
+                    item.ev = ev;
+                    emit(MdItem::Kind::Event);
+                }
+                for (const auto& r : levels) {
+                    item.rec = r;
+                    emit(MdItem::Kind::Level);
+                }
+            }
+#if STAGE_TIMING
+            st.md = stageNow();
+            if (stats) stats->record(st.md - st.start);
+#endif
+
+            // Client replies: text is produced only here, at the edge of the engine.
+            // Lines for named symbols end in " sym <SYMBOL>", then " tag <N>"
+            // if the command carried a client tag.
+            payload.clear();
+            suffix.clear();
+            if (m.symbol != kDefaultSymbol) { suffix += " sym "; suffix += symbolName(m.symbol); }
+            if (m.client_tag && !m.binary) { suffix += " tag "; appendInt(suffix, m.client_tag); }
+            for (const auto& ev : events) {
+                if (m.binary) { binAppendEvent(payload, ev, m.client_tag, ts); continue; }
+                appendEvent(payload, ev, px);
+                payload += suffix;
+                payload += '\n';
+            }
+            if (!payload.empty()) reply(m.session, payload);
+#if STAGE_TIMING
+            if (stages && m.read_ns) {
+                st.replied = stageNow();
+                st.read = m.read_ns;
+                st.enqueue = m.enqueue_ns;
+                stages->record(st);
+            }
+#endif
+        }
+        end_batch();
+#if STAGE_TIMING
+        // Periodic dump of this shard's last interval, written in one piece
+        // so shards do not interleave.
+        if (stages && cfg.stage_dump_ns && stageNow() - last_dump >= cfg.stage_dump_ns) {
+            std::ostringstream out;
+            out << "Shard " << shard << " stage latency, last "
+                << static_cast<double>(stageNow() - last_dump) / 1e9 << " s:\n";
+            stages->writeInterval(out);
+            if (stages->rollInterval()) std::cout << out.str() << std::flush;
+            last_dump = stageNow();
+        }
+#endif
     }
+    end_batch();
 }
 
-static void enqueue_or_error(OrderQueue& q, const OrderMsg& msg, int client_fd) {
+static void send_bin_reject(SessionId session, uint64_t client_id, int64_t order_id, BinReject reason) {
+    std::string out;
+    binAppendReject(out, client_id, wall_ns(), order_id, reason);
+    reply(session, out);
+}
+
+static void enqueue_or_error(EngineQueues& qs, OrderMsg& msg, SessionId session) {
+    OrderQueue& q = *qs[symbolShard(msg.symbol, qs.size())];
+#if STAGE_TIMING
+    msg.enqueue_ns = stageNow();
+#endif
     if (!q.push(msg)) {
-        const char* err = "ERROR Engine offline\n";
-        (void)safe_send(client_fd, err, std::strlen(err));
+        if (msg.binary) {
+            send_bin_reject(session, msg.client_tag, msg.order_id, BinReject::EngineOffline);
+            return;
+        }
+        std::string err = "ERROR Engine offline";
+        if (msg.client_tag) err += " tag " + std::to_string(msg.client_tag);
+        err += '\n';
+        reply(session, err);
     }
 }
 
-static void serve_client(int client_fd, OrderQueue& q, int64_t tick_factor) {
-    std::string line;
-    while (g_running) {
-        if (!read_line(client_fd, line)) { std::cout << "Client disconnected.\n"; break; }
-        if (line.empty()) { std::cout << "Empty line -> close.\n"; break; }
-
-        // ACK timestamp (for client RTT)
-        auto now = std::chrono::high_resolution_clock::now();
-        long long ts_us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
-        {
-            std::ostringstream wire; wire << "ACK " << ts_us << "\n";
-            const std::string w = wire.str();
-            (void)safe_send(client_fd, w.c_str(), w.size());
-        }
-
-        if (line == "QUIT") {
-            std::ostringstream bye; bye << "BYE\n";
-            const std::string payload = bye.str();
-            (void)safe_send(client_fd, payload.c_str(), payload.size());
-            std::cout << "Client requested QUIT.\n";
+// Handles one complete command line from a client (ACK, parse, enqueue).
+// 'read_ns' is when it came off the socket (STAGE_TIMING builds).
+// Returns false when the connection should be closed.
+static bool handle_line(SessionId session, std::string_view line, EngineQueues& q, int64_t tick_factor,
+                        [[maybe_unused]] uint64_t read_ns) {
+    if (line.empty()) { std::cout << "Empty line -> close.\n"; return false; }
+
+    // Optional client tag: a trailing " tag <N>" (N > 0), echoed on the ACK and
+    // at the end of every reply line for this command, so a client with many
+    // orders in flight can match replies to requests. Every line carries the
+    // tag as the engine prints it (decimal, no leading zeros), not as sent.
+    uint64_t tag = 0;
+    thread_local std::string tag_suffix;   // reused by this reader thread
+    tag_suffix.clear();
+    if (const size_t p = line.rfind(" tag "); p != std::string_view::npos) {
+        const std::string_view digits = line.substr(p + 5);
+        const auto r = std::from_chars(digits.data(), digits.data() + digits.size(), tag);
+        if (r.ec == std::errc() && r.ptr == digits.data() + digits.size() && tag > 0) {
+            tag_suffix = " tag ";
+            appendInt(tag_suffix, tag);
+            line = line.substr(0, p);
+        } else {
+            tag = 0;
+        }
+    }
+    auto reply_error = [&](std::string_view text) {
+        std::string err(text);
+        err += tag_suffix;
+        err += '\n';
+        reply(session, err);
+    };
+
+    // ACK timestamp (for client RTT)
+    auto now = std::chrono::high_resolution_clock::now();
+    long long ts_us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+    {
+        thread_local std::string wire;   // reused by this reader thread
+        wire.assign("ACK ");
+        appendInt(wire, ts_us);
+        wire += tag_suffix;
+        wire += '\n';
+        reply(session, wire);
+    }
+
+    // NEW / CXL / MOD / QUIT, grammar in command_parser.hpp.
+    Command cmd;
+    std::string_view bad;
+    const CmdStatus st = parseCommand(line, tick_factor, cmd, bad);
+    if (st != CmdStatus::Ok) {
+        std::string err;
+        appendCommandError(st, bad, tick_factor, err);
+        reply_error(err);
+        return true;
+    }
+    if (cmd.type == CmdType::Quit) {
+        reply(session, "BYE\n");
+        std::cout << "Client requested QUIT.\n";
+        return false;
+    }
+
+    OrderMsg msg;
+    msg.type        = cmd.type == CmdType::New    ? MsgType::New
+                    : cmd.type == CmdType::Cancel ? MsgType::Cancel
+                                                  : MsgType::Modify;
+    msg.symbol      = cmd.symbol;
+    msg.side        = cmd.side;
+    msg.qty         = cmd.qty;
+    msg.price_ticks = cmd.price_ticks;
+    msg.order_id    = cmd.type == CmdType::New ? g_order_id.fetch_add(1, std::memory_order_relaxed)
+                                               : cmd.order_id;
+    msg.session     = session;
+    msg.client_tag  = tag;
+#if STAGE_TIMING
+    msg.read_ns     = read_ns;
+#endif
+    enqueue_or_error(q, msg, session);
+    return true;
+}
+
+static_assert(sizeof(BinNew::symbol) == sizeof(SymbolId), "binary symbol field is a packed SymbolId");
+
+// Handles one complete binary frame (Ack, decode, enqueue).
+// Returns false when the connection should be closed.
+static bool handle_frame(SessionId session, std::string_view frame, EngineQueues& q,
+                         [[maybe_unused]] uint64_t read_ns) {
+    BinHeader h;
+    std::memcpy(&h, frame.data(), sizeof(h));
+    uint64_t client_id = 0;
+    if (frame.size() >= sizeof(BinHeader) + sizeof(client_id))
+        std::memcpy(&client_id, frame.data() + sizeof(BinHeader), sizeof(client_id));
+
+    OrderMsg msg;
+    msg.session    = session;
+    msg.binary     = true;
+    msg.client_tag = client_id;
+#if STAGE_TIMING
+    msg.read_ns    = read_ns;
+#endif
+    bool valid = false;
+    bool quit  = false;
+
+    switch (binType(frame)) {
+        case BinType::New: {
+            BinNew m;
+            if (!binDecode(frame, m)) break;
+            std::memcpy(&msg.symbol, m.symbol, sizeof(msg.symbol));
+            valid = validSymbol(msg.symbol) &&
+                    m.side <= 1 && m.qty > 0 && m.qty <= INT32_MAX && m.price_ticks > 0;
+            msg.type        = MsgType::New;
+            msg.side        = (m.side == 0 ? Side::Buy : Side::Sell);
+            msg.qty         = static_cast<int>(m.qty);
+            msg.price_ticks = m.price_ticks;
+            if (valid) msg.order_id = g_order_id.fetch_add(1, std::memory_order_relaxed);
             break;
         }
+        case BinType::Cancel: {
+            BinCancel m;
+            if (!binDecode(frame, m)) break;
+            std::memcpy(&msg.symbol, m.symbol, sizeof(msg.symbol));
+            valid = validSymbol(msg.symbol) && m.order_id > 0;
+            msg.type     = MsgType::Cancel;
+            msg.order_id = m.order_id;
+            break;
+        }
+        case BinType::Modify: {
+            BinModify m;
+            if (!binDecode(frame, m)) break;
+            std::memcpy(&msg.symbol, m.symbol, sizeof(msg.symbol));
+            valid = validSymbol(msg.symbol) &&
+                    m.order_id > 0 && m.qty > 0 && m.qty <= INT32_MAX && m.price_ticks > 0;
+            msg.type        = MsgType::Modify;
+            msg.order_id    = m.order_id;
+            msg.qty         = static_cast<int>(m.qty);
+            msg.price_ticks = m.price_ticks;
+            break;
+        }
+        case BinType::Quit: {
+            BinQuit m;
+            valid = quit = binDecode(frame, m);
+            break;
+        }
+        default:
+            break;
+    }
 
-        // Parse commands:
-        // NEW BUY|SELL <qty> @ <price>
-        // CXL <order_id>
-        // MOD <order_id> <new_qty> @ <new_price>
-        std::istringstream iss(line);
-        std::string cmd; iss >> cmd;
-        if (cmd == "NEW") {
-            std::string sideStr; int qty=0; char at=0; double price=0.0;
-            iss >> sideStr >> qty >> at >> price;
-            if ((sideStr != "BUY" && sideStr != "SELL") || at != '@' || qty <= 0 || price <= 0.0) {
-                const char* err = "ERROR Invalid NEW. Expected: NEW BUY|SELL <qty> @ <price>\n";
-                (void)safe_send(client_fd, err, std::strlen(err));
-                continue;
-            }
-            int64_t price_ticks = static_cast<int64_t>(std::llround(price * static_cast<double>(tick_factor)));
-            OrderMsg msg;
-            msg.type       = MsgType::New;
-            msg.side       = (sideStr == "BUY" ? Side::Buy : Side::Sell);
-            msg.qty        = qty;
-            msg.price_ticks= price_ticks;
-            msg.order_id   = g_order_id.fetch_add(1, std::memory_order_relaxed);
-            msg.client_fd  = client_fd;
-            enqueue_or_error(q, msg, client_fd);
-        } else if (cmd == "CXL") {
-            int64_t id=0; iss >> id;
-            if (id <= 0) {
-                const char* err = "ERROR Invalid CXL. Expected: CXL <order_id>\n";
-                (void)safe_send(client_fd, err, std::strlen(err));
-                continue;
-            }
-            OrderMsg msg; msg.type = MsgType::Cancel; msg.order_id = id; msg.client_fd = client_fd;
-            enqueue_or_error(q, msg, client_fd);
-        } else if (cmd == "MOD") {
-            int64_t id=0; int new_qty=0; char at=0; double new_px=0.0;
-            iss >> id >> new_qty >> at >> new_px;
-            if (id <= 0 || new_qty <= 0 || at != '@' || new_px <= 0.0) {
-                const char* err = "ERROR Invalid MOD. Expected: MOD <order_id> <new_qty> @ <new_price>\n";
-                (void)safe_send(client_fd, err, std::strlen(err));
-                continue;
-            }
-            int64_t price_ticks = static_cast<int64_t>(std::llround(new_px * static_cast<double>(tick_factor)));
-            OrderMsg msg; msg.type = MsgType::Modify;
-            msg.order_id = id; msg.qty = new_qty; msg.price_ticks = price_ticks; msg.client_fd = client_fd;
-            enqueue_or_error(q, msg, client_fd);
+    // Every request is acknowledged first, as in the text protocol.
+    std::string out;
+    const uint64_t ts = wall_ns();
+    binAppendAck(out, client_id, ts, msg.order_id);
+    if (!valid) {
+        const bool known = h.type >= static_cast<uint8_t>(BinType::New) &&
+                           h.type <= static_cast<uint8_t>(BinType::Quit);
+        binAppendReject(out, client_id, ts, msg.order_id,
+                        known && frame.size() > sizeof(BinHeader) + sizeof(client_id)
+                            ? BinReject::InvalidOrder : BinReject::BadMessage);
+    }
+    reply(session, out);
+
+    if (quit) { std::cout << "Client requested QUIT.\n"; return false; }
+    if (valid) enqueue_or_error(q, msg, session);
+    return true;
+}
+
+// Connection protocol, fixed by the first byte a client sends.
+enum ConnProto : int { ProtoUnknown = 0, ProtoText = 1, ProtoBinary = 2 };
+
+// Consumes every complete command buffered in 'in'.
+// Returns false when the connection should be closed.
+static bool process_input(SessionId session, LineReader& in, int& proto,
+                          EngineQueues& q, int64_t tick_factor) {
+    // Called right after a read: one stamp covers everything it delivered.
+#if STAGE_TIMING
+    const uint64_t read_ns = stageNow();
+#else
+    const uint64_t read_ns = 0;
+#endif
+    if (proto == ProtoUnknown) {
+        const std::string_view p = in.pending();
+        if (p.empty()) return true;
+        if (static_cast<uint8_t>(p[0]) == kBinaryMagic) {
+            in.consume(1);
+            proto = ProtoBinary;
+            std::cout << "Binary session.\n";
         } else {
-            const char* err = "ERROR Unknown command. Use NEW/CXL/MOD/QUIT.\n";
-            (void)safe_send(client_fd, err, std::strlen(err));
+            proto = ProtoText;
+        }
+    }
+
+    if (proto == ProtoText) {
+        std::string_view line;
+        while (in.nextLine(line))
+            if (!handle_line(session, line, q, tick_factor, read_ns)) return false;
+        return !in.overflow();
+    }
+
+    while (true) {
+        const std::string_view p = in.pending();
+        const size_t len = binFrameLength(p);
+        if (len == kBinBadFrame) { std::cout << "Bad binary frame -> close.\n"; return false; }
+        if (len == 0) return true;
+        if (!handle_frame(session, p.substr(0, len), q, read_ns)) return false;
+        in.consume(len);
+    }
+}
+
+// Ends a client's session and prints its output counters.
+static void close_session(SessionId session) {
+    const SessionStats st = g_sessions->close(session);
+    if (st.overflowed) std::cout << "Client dropped: output backlog over limit.\n";
+    std::cout << "Session closed: " << st.replies << " replies, " << st.writes
+              << " writes, peak backlog " << st.peak_backlog << " bytes\n";
+}
+
+static void serve_client(int client_fd, EngineQueues& q, int64_t tick_factor) {
+    const SessionId session = g_sessions->open(client_fd);
+    if (session == kNoSession) {
+        std::cout << "Session table full -> close.\n";
+        close(client_fd);
+        return;
+    }
+    LineReader reader;
+    int proto = ProtoUnknown;
+    while (g_running) {
+        const ssize_t r = reader.fill(client_fd);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) {
+            if (r < 0) perror("recv");
+            std::cout << "Client disconnected.\n";
+            break;
         }
+        if (!process_input(session, reader, proto, q, tick_factor)) break;
     }
 
+    close_session(session);
     close(client_fd);
 }
 
@@ -191,12 +629,110 @@ int main(int argc, char** argv) {
     std::string md_host = "127.0.0.1";   // UDP publish target
     uint16_t    md_port = 9001;
     bool        md_on   = true;
+    EngineConfig engine_cfg;
+    engine_cfg.tick_factor = TICK_FACTOR;
+    BookConfig&  book_cfg = engine_cfg.book;   // --book map|dense
+    QueueKind    queue_kind = QueueKind::Mutex; // --queue mutex|mpsc
+    WaitPolicy   engine_wait = WaitPolicy::Block;
+    bool         io_epoll = false;              // --io threads|epoll
+    int          io_threads = 2;                // --io-threads N (epoll mode)
+    int          shards = 1;                    // --shards N engine threads
+    uint16_t     snapshot_port = 9002;          // depth-feed snapshot server (TCP)
+    bool         md_thread = true;              // --md-thread on|off
+    size_t       max_sessions = 16384;          // --max-sessions N
+    size_t       out_buffer = 4u << 20;         // --out-buffer-kb N per session
+    std::string  journal_path;                  // --journal PATH (off when empty)
+    JournalSync  journal_sync = JournalSync::Batch;
+    uint64_t     journal_sync_ns = 10000000;    // --journal-sync-ms N (periodic)
+    size_t       journal_records = 4u << 20;    // --journal-mb N (new files only)
+    double       stage_dump_s = 0;              // --stage-stats-s N: periodic stage dumps
+    std::vector<int> engine_cpus, io_cpus;      // --engine-cpu / --io-cpus LIST (empty: unpinned)
+    int          md_cpu = -1;                   // --md-cpu N
+    int          rt_priority = 0;               // --rt-priority N: SCHED_FIFO for engine threads
 
     for (int i = 1; i < argc; ++i) {
         std::string a = argv[i];
         if (a == "--no-md") md_on = false;
         else if (a == "--md-host" && i+1 < argc) md_host = argv[++i];
         else if (a == "--md-port" && i+1 < argc) md_port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (a == "--md-format" && i+1 < argc) {
+            std::string f = argv[++i];
+            if (f == "binary")    engine_cfg.md_binary = true;
+            else if (f == "text") engine_cfg.md_binary = false;
+            else { std::cerr << "Unknown --md-format " << f << " (use text|binary)\n"; return 1; }
+        }
+        else if (a == "--md-flush-us" && i+1 < argc) engine_cfg.md_flush_ns = static_cast<uint64_t>(std::atoll(argv[++i])) * 1000;
+        else if (a == "--md-depth" && i+1 < argc) engine_cfg.md_depth = static_cast<size_t>(std::atoi(argv[++i]));
+        else if (a == "--md-snapshot-ms" && i+1 < argc) engine_cfg.md_snapshot_ns = static_cast<uint64_t>(std::atoll(argv[++i])) * 1000000;
+        else if (a == "--snapshot-port" && i+1 < argc) snapshot_port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (a == "--md-thread" && i+1 < argc) {
+            std::string t = argv[++i];
+            if (t == "on")       md_thread = true;
+            else if (t == "off") md_thread = false;
+            else { std::cerr << "Unknown --md-thread " << t << " (use on|off)\n"; return 1; }
+        }
+        else if (a == "--md-conflate-us" && i+1 < argc) engine_cfg.md_conflate_ns = static_cast<uint64_t>(std::atoll(argv[++i])) * 1000;
+        else if (a == "--book" && i+1 < argc) {
+            std::string kind = argv[++i];
+            if (kind == "dense")    book_cfg.ladder = LadderKind::Dense;
+            else if (kind == "map") book_cfg.ladder = LadderKind::Map;
+            else { std::cerr << "Unknown --book " << kind << " (use map|dense)\n"; return 1; }
+        }
+        else if (a == "--dense-span" && i+1 < argc) book_cfg.dense_span = std::atoll(argv[++i]);
+        else if (a == "--queue" && i+1 < argc) {
+            std::string kind = argv[++i];
+            if (kind == "mpsc")       queue_kind = QueueKind::Mpsc;
+            else if (kind == "mutex") queue_kind = QueueKind::Mutex;
+            else { std::cerr << "Unknown --queue " << kind << " (use mutex|mpsc)\n"; return 1; }
+        }
+        else if (a == "--engine-wait" && i+1 < argc) {
+            std::string w = argv[++i];
+            if (w == "spin")       engine_wait = WaitPolicy::Spin;
+            else if (w == "yield") engine_wait = WaitPolicy::SpinYield;
+            else if (w == "block") engine_wait = WaitPolicy::Block;
+            else { std::cerr << "Unknown --engine-wait " << w << " (use spin|yield|block)\n"; return 1; }
+        }
+        else if (a == "--batch" && i+1 < argc) engine_cfg.batch = static_cast<size_t>(std::atoi(argv[++i]));
+        else if (a == "--io" && i+1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "epoll")        io_epoll = true;
+            else if (mode == "threads") io_epoll = false;
+            else { std::cerr << "Unknown --io " << mode << " (use threads|epoll)\n"; return 1; }
+        }
+        else if (a == "--io-threads" && i+1 < argc) io_threads = std::atoi(argv[++i]);
+        else if (a == "--shards" && i+1 < argc) shards = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--max-sessions" && i+1 < argc) max_sessions = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (a == "--out-buffer-kb" && i+1 < argc) out_buffer = static_cast<size_t>(std::atoll(argv[++i])) * 1024;
+        else if (a == "--journal" && i+1 < argc) journal_path = argv[++i];
+        else if (a == "--journal-sync" && i+1 < argc) {
+            std::string m = argv[++i];
+            if (m == "none")          journal_sync = JournalSync::None;
+            else if (m == "periodic") journal_sync = JournalSync::Periodic;
+            else if (m == "batch")    journal_sync = JournalSync::Batch;
+            else { std::cerr << "Unknown --journal-sync " << m << " (use none|periodic|batch)\n"; return 1; }
+        }
+        else if (a == "--journal-sync-ms" && i+1 < argc) journal_sync_ns = static_cast<uint64_t>(std::atoll(argv[++i])) * 1000000;
+        else if (a == "--journal-mb" && i+1 < argc) journal_records = static_cast<size_t>(std::atoll(argv[++i])) * (1u << 20) / sizeof(JournalRecord);
+        else if (a == "--book-pool" && i+1 < argc) book_cfg.pool_capacity = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (a == "--book-alloc" && i+1 < argc) {
+            std::string kind = argv[++i];
+            if (kind == "arena")     book_cfg.alloc = BookAlloc::Arena;
+            else if (kind == "heap") book_cfg.alloc = BookAlloc::Heap;
+            else { std::cerr << "Unknown --book-alloc " << kind << " (use arena|heap)\n"; return 1; }
+        }
+        else if (a == "--stage-stats-s" && i+1 < argc) stage_dump_s = std::atof(argv[++i]);
+        else if ((a == "--engine-cpu" || a == "--io-cpus") && i+1 < argc) {
+            if (!parseCpuList(argv[++i], a == "--engine-cpu" ? engine_cpus : io_cpus)) {
+                std::cerr << "Bad " << a << " " << argv[i] << " (use e.g. 3, 2,3 or 0-3)\n";
+                return 1;
+            }
+        }
+        else if (a == "--md-cpu" && i+1 < argc) md_cpu = std::atoi(argv[++i]);
+        else if (a == "--busy-poll") { queue_kind = QueueKind::Mpsc; engine_wait = WaitPolicy::Spin; }
+        else if (a == "--rt-priority" && i+1 < argc) {
+            rt_priority = std::atoi(argv[++i]);
+            if (rt_priority < 1 || rt_priority > 99) { std::cerr << "--rt-priority must be 1..99\n"; return 1; }
+        }
     }
 
     g_server_fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -207,29 +743,226 @@ int main(int argc, char** argv) {
     addr.sin_addr.s_addr = INADDR_ANY;
     addr.sin_port = htons(8080);
     if (bind(g_server_fd, (sockaddr*)&addr, sizeof(addr)) < 0) { perror("bind"); close(g_server_fd); return 1; }
-    if (listen(g_server_fd, 64) < 0) { perror("listen"); close(g_server_fd); return 1; }
+    if (listen(g_server_fd, SOMAXCONN) < 0) { perror("listen"); close(g_server_fd); return 1; }
 
     std::cout << "Exchange waiting for connections... (Ctrl-C to quit)\n";
-    if (md_on) std::cout << "Publishing market-data UDP to " << md_host << ":" << md_port << "\n";
+    if (md_on) std::cout << "Publishing " << (engine_cfg.md_binary ? "binary" : "text")
+                         << " market-data UDP to " << md_host << ":" << md_port << "\n";
+    std::cout << "Order book levels: "
+              << (book_cfg.ladder == LadderKind::Dense ? "dense" : "map") << ", ";
+    if (book_cfg.alloc == BookAlloc::Arena)
+        std::cout << "arena memory (" << arenaEstimate(book_cfg) / (1u << 20) << " MB reserved per book)\n";
+    else
+        std::cout << "heap memory\n";
+    std::cout << "Engine queue: " << (queue_kind == QueueKind::Mpsc ? "mpsc" : "mutex")
+              << ", batch " << engine_cfg.batch << "\n";
+    std::cout << "Engine shards: " << shards << "\n";
+    if (io_epoll) std::cout << "Network I/O: epoll, " << io_threads << " thread(s)\n";
+    else          std::cout << "Network I/O: thread per client\n";
+
+    if (engine_cfg.md_depth && !engine_cfg.md_binary) {
+        std::cerr << "--md-depth needs --md-format binary\n";
+        return 1;
+    }
+    if (engine_cfg.md_conflate_ns && !md_thread) {
+        std::cerr << "--md-conflate-us needs --md-thread on\n";
+        return 1;
+    }
+    if (md_on) {
+        std::cout << "Market-data publishing: " << (md_thread ? "publisher thread" : "engine thread");
+        if (engine_cfg.md_conflate_ns) std::cout << ", BBO conflated every " << engine_cfg.md_conflate_ns / 1000 << " us";
+        std::cout << "\n";
+    }
+    if (md_on && engine_cfg.md_depth)
+        std::cout << "Depth feed: top " << engine_cfg.md_depth << " levels, snapshots every "
+                  << engine_cfg.md_snapshot_ns / 1000000 << " ms, TCP snapshots on port " << snapshot_port << "\n";
+
+    engine_cfg.shards = static_cast<size_t>(shards);
+    engine_cfg.stage_dump_ns = static_cast<uint64_t>(stage_dump_s * 1e9);
+#if STAGE_TIMING
+    std::cout << "Stage timing: on";
+    if (engine_cfg.stage_dump_ns) std::cout << ", per-shard dumps every " << stage_dump_s << " s";
+    std::cout << "\n";
+#else
+    if (stage_dump_s > 0) std::cerr << "--stage-stats-s ignored: built with STAGE_TIMING=OFF\n";
+#endif
+
+    // Thread layout. Threads pin themselves as they start; a shard whose
+    // SCHED_FIFO request is refused says so and runs SCHED_OTHER.
+    const std::vector<int> allowed = allowedCpus();
+    if (md_cpu >= 0 && !(md_on && md_thread)) { std::cerr << "--md-cpu needs the market-data thread\n"; return 1; }
+    const std::vector<int> md_cpus = md_cpu >= 0 ? std::vector<int>{md_cpu} : std::vector<int>{};
+    for (const auto& [flag, cpus] : {std::pair<const char*, const std::vector<int>*>{"--engine-cpu", &engine_cpus},
+                                     {"--io-cpus", &io_cpus}, {"--md-cpu", &md_cpus}}) {
+        for (int c : *cpus) {
+            if (std::find(allowed.begin(), allowed.end(), c) != allowed.end()) continue;
+            std::cerr << flag << ": CPU " << c << " is not available to this process (allowed: "
+                      << formatCpuList(allowed) << ")\n";
+            return 1;
+        }
+    }
+    const bool busy_poll = engine_wait != WaitPolicy::Block;
+    if (busy_poll && queue_kind == QueueKind::Mutex)
+        std::cerr << "--engine-wait applies to the mpsc queue only; the mutex queue blocks (use --busy-poll)\n";
+    const bool polling = busy_poll && queue_kind == QueueKind::Mpsc;
+    auto shares = [](const std::vector<int>& a, const std::vector<int>& b) {
+        for (int c : a) if (std::find(b.begin(), b.end(), c) != b.end()) return true;
+        return false;
+    };
+    if (polling && rt_priority) {
+        // A polling SCHED_FIFO thread never gives its CPU up: only allow it
+        // where nothing else of ours can be scheduled on that CPU.
+        const bool own_cpus = !engine_cpus.empty() && !io_cpus.empty() && !shares(engine_cpus, io_cpus) &&
+                              !shares(engine_cpus, md_cpus) && (md_cpu >= 0 || !(md_on && md_thread));
+        if (!own_cpus) {
+            std::cerr << "SCHED_FIFO with busy-poll needs --engine-cpu on CPUs no other exchange thread uses "
+                         "(pin --io-cpus and --md-cpu elsewhere); running SCHED_OTHER\n";
+            rt_priority = 0;
+        }
+    }
+    if (polling && (allowed.size() <= static_cast<size_t>(shards) || shares(engine_cpus, io_cpus)))
+        std::cerr << "Warning: busy-polling engine threads share CPUs with the I/O threads and will slow them down\n";
+
+    std::cout << "CPUs available: " << formatCpuList(allowed) << "\n";
+    std::cout << "Engine threads: ";
+    if (engine_cpus.empty()) std::cout << "unpinned";
+    for (int i = 0; i < shards; ++i)
+        if (!engine_cpus.empty())
+            std::cout << (i ? ", " : "") << "shard " << i << " on CPU " << engine_cpus[static_cast<size_t>(i) % engine_cpus.size()];
+    std::cout << "; " << (polling ? (engine_wait == WaitPolicy::Spin ? "busy-poll" : "poll and yield") : "blocking wait")
+              << "; " << (rt_priority ? "SCHED_FIFO " + std::to_string(rt_priority) : std::string("SCHED_OTHER")) << "\n";
+    std::cout << "I/O threads: " << (io_cpus.empty() ? "unpinned" : "CPUs " + formatCpuList(io_cpus) + ", round robin") << "\n";
+    if (md_on && md_thread)
+        std::cout << "Market-data thread: " << (md_cpu >= 0 ? "CPU " + std::to_string(md_cpu) : std::string("unpinned")) << "\n";
+
+    // Recover before accepting orders: the engines replay the journal, and
+    // new order ids continue after the highest one it holds.
+    Journal journal;
+    if (!journal_path.empty()) {
+        if (!journal.open(journal_path, journal_records, journal_sync, journal_sync_ns)) return 1;
+        int64_t max_id = 0;
+        for (size_t i = 0; i < journal.recovered(); ++i) max_id = std::max(max_id, journal.record(i).order_id);
+        g_order_id = max_id + 1;
+        static const char* kSyncName[] = {"none", "periodic", "batch"};
+        std::cout << "Journal: " << journal_path << " (" << journal.recovered() << " of "
+                  << journal.capacity() << " records used, sync " << kSyncName[static_cast<int>(journal_sync)]
+                  << "), next order id " << max_id + 1 << "\n";
+    }
 
     MarketDataPublisher md(md_host, md_port, md_on);
-    OrderQueue queue(4096);
+    DepthCache depth_cache;
+    SnapshotServer snapshot_server(snapshot_port, depth_cache);
+    if (md_on && engine_cfg.md_depth && !snapshot_server.start())
+        std::cerr << "Snapshot server disabled\n";
+    SessionTable sessions(max_sessions, out_buffer);
+    // I/O threads take --io-cpus in turn: the epoll threads (or one thread
+    // per client), then the session writer.
+    std::atomic<size_t> io_next{0};
+    auto place_io = [&io_cpus, &io_next](const char* name) {
+        ThreadPlacement pl;
+        if (!io_cpus.empty()) pl.cpu = io_cpus[io_next.fetch_add(1) % io_cpus.size()];
+        const std::string err = placeThisThread(name, pl);
+        if (!err.empty()) std::cerr << name << ": " << err << "\n";
+    };
+    sessions.start([&] { place_io("session-writer"); });
+    g_sessions = &sessions;
+    std::unique_ptr<MdPublisherThread> md_stage;
+    if (md_on && md_thread) {
+        md_stage = std::make_unique<MdPublisherThread>(md, static_cast<size_t>(shards), mdWriterConfig(engine_cfg));
+        md_stage->start([md_cpu] {
+            ThreadPlacement pl;
+            pl.cpu = md_cpu;
+            const std::string err = placeThisThread("md-publisher", pl);
+            if (!err.empty()) std::cerr << "Market-data thread: " << err << "\n";
+        });
+    }
+    EngineQueues queues;
+    std::vector<std::thread> engine_thrs;
+    // Engine service time per message (book update + market-data hand-off,
+    // not the client reply), per shard; STAGE_TIMING builds only.
+    std::vector<LatencyHistogram> engine_stats(STAGE_TIMING ? static_cast<size_t>(shards) : 0);
+    std::vector<StageStats> stage_stats(STAGE_TIMING ? static_cast<size_t>(shards) : 0);
     std::atomic<bool> engine_running{true};
-    std::thread engine_thr(engine_loop, std::ref(queue), std::ref(engine_running), TICK_FACTOR, &md);
+    for (int i = 0; i < shards; ++i) queues.push_back(std::make_unique<OrderQueue>(4096, queue_kind, engine_wait));
+    for (int i = 0; i < shards; ++i) {
+        ThreadPlacement pl;
+        if (!engine_cpus.empty()) pl.cpu = engine_cpus[static_cast<size_t>(i) % engine_cpus.size()];
+        pl.fifo_priority = rt_priority;
+        engine_thrs.emplace_back([&, i, pl] {
+            const std::string name = "engine-" + std::to_string(i);
+            const std::string err = placeThisThread(name.c_str(), pl);
+            if (!err.empty()) std::cerr << "Shard " << i << ": " << err << "\n";
+            const size_t s = static_cast<size_t>(i);
+            engine_loop(*queues[s], engine_running, engine_cfg, &md, static_cast<uint16_t>(i), &depth_cache,
+                        md_stage.get(), engine_stats.empty() ? nullptr : &engine_stats[s], journal.isOpen() ? &journal : nullptr,
+                        stage_stats.empty() ? nullptr : &stage_stats[s]);
+        });
+    }
 
-    while (g_running) {
+    if (io_epoll) {
+        Reactor reactor(g_server_fd, io_threads,
+            [&](int, LineReader& in, Reactor::ConnState& st) {
+                if (st.id == kNoSession) { std::cout << "Session table full -> close.\n"; return false; }
+                return process_input(st.id, in, st.mode, queues, TICK_FACTOR);
+            },
+            [](int fd, Reactor::ConnState& st) {
+                st.id = g_sessions->open(fd);
+                std::cout << "Client connected!\n";
+            },
+            [](int, Reactor::ConnState& st) {
+                std::cout << "Client disconnected.\n";
+                if (st.id != kNoSession) close_session(st.id);
+            });
+        g_reactor = &reactor;
+        if (g_running && !reactor.run([&](int) { place_io("io"); })) g_running = false;
+        g_reactor = nullptr;
+    }
+
+    while (g_running && !io_epoll) {
         socklen_t len = sizeof(addr);
         int client_fd = accept(g_server_fd, (sockaddr*)&addr, &len);
         if (client_fd < 0) { if (!g_running) break; perror("accept"); continue; }
         std::cout << "Client connected!\n";
-        std::thread(serve_client, client_fd, std::ref(queue), TICK_FACTOR).detach();
+        std::thread([&, client_fd] {
+            if (!io_cpus.empty()) place_io("client");
+            serve_client(client_fd, queues, TICK_FACTOR);
+        }).detach();
     }
 
     if (g_server_fd >= 0) close(g_server_fd);
+    snapshot_server.stop();
     engine_running = false;
-    queue.stop();
-    if (engine_thr.joinable()) engine_thr.join();
+    for (auto& q : queues) q->stop();
+    for (auto& t : engine_thrs) if (t.joinable()) t.join();
+    if (md_stage) md_stage->stop();
+    sessions.stop();
+    if (journal.isOpen())
+        std::cout << "Journal: " << journal.appended() << " records appended, " << journal.syncs() << " syncs\n";
+    journal.close();
 
+    LatencyHistogram total;
+    for (const auto& st : engine_stats) total.merge(st);
+    if (total.count())
+        std::cout << "Engine time per message: mean " << static_cast<uint64_t>(total.mean())
+                  << " ns, p50 " << total.percentile(50) << " ns, p99 " << total.percentile(99)
+                  << " ns, max " << total.max() << " ns (" << total.count() << " messages)\n";
+    if (!stage_stats.empty()) {
+        StageStats all;
+        for (auto& st : stage_stats) { st.rollInterval(); all.merge(st); }
+        if (const uint64_t msgs = all.total(Stage::Total).count()) {
+            std::cout << "Stage latency, " << msgs << " client messages:\n";
+            all.writeTotal(std::cout);
+        }
+    }
+    const SessionStats out = sessions.totals();
+    std::cout << "Sessions: " << sessions.opened() << " opened, " << sessions.slowDisconnects()
+              << " dropped for backlog; " << out.replies << " replies in " << out.writes
+              << " writes, peak backlog " << out.peak_backlog << " bytes\n";
+    if (md_stage)
+        std::cout << "Market-data stage: " << md_stage->dropped() << " dropped, "
+                  << md_stage->conflated() << " conflated\n";
+    if (md_on) std::cout << "Market data sent: " << md.datagramsSent() << " datagrams, "
+                         << md.bytesSent() << " bytes\n";
     std::cout << "Server shut down.\n";
     return 0;
 }
\ No newline at end of file
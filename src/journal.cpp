@@ -0,0 +1,180 @@
+#include "journal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint32_t journalChecksum(const JournalRecord& r) {
+    const auto* p = reinterpret_cast<const unsigned char*>(&r);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(JournalRecord, check); ++i) { h ^= p[i]; h *= 16777619u; }
+    return h;
+}
+
+void journalApply(OrderBook& book, const JournalRecord& r, BookEvents& out) {
+    switch (static_cast<JournalOp>(r.op)) {
+        case JournalOp::New:
+            book.processOrder(r.side == 0 ? Side::Buy : Side::Sell, static_cast<int>(r.qty),
+                              r.price_ticks, r.order_id, out);
+            break;
+        case JournalOp::Cancel:
+            book.cancel(r.order_id, out);
+            break;
+        case JournalOp::Modify:
+            book.replace(r.order_id, static_cast<int>(r.qty), r.price_ticks, r.order_id, out);
+            break;
+    }
+}
+
+static size_t pageSize() {
+    static const size_t p = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return p;
+}
+
+bool Journal::map(int fd, size_t bytes, bool writable) {
+    void* p = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) { perror("journal mmap"); return false; }
+    fd_ = fd;
+    base_ = static_cast<char*>(p);
+    bytes_ = bytes;
+    records_ = reinterpret_cast<JournalRecord*>(base_ + kJournalHeaderBytes);
+
+    // Recover: a record is good if it carries its own position as seq and a
+    // matching checksum. Bad slots are holes left by a shard that reserved
+    // them but crashed before writing (or syncing); records past a hole may
+    // still be committed, so keep looking until a long run of bad slots.
+    valid_.clear();
+    end_ = 0;
+    for (size_t i = 0, bad = 0; i < capacity_ && bad < kJournalMaxGap; ++i) {
+        if (records_[i].seq == i + 1 && records_[i].check == journalChecksum(records_[i])) {
+            valid_.push_back(i);
+            end_ = i + 1;
+            bad = 0;
+        } else {
+            ++bad;
+        }
+    }
+    next_.store(end_, std::memory_order_relaxed);
+    return true;
+}
+
+bool Journal::openReadOnly(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { perror(path.c_str()); return false; }
+    struct stat st{};
+    JournalHeader h{};
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < kJournalHeaderBytes ||
+        pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+        std::memcmp(h.magic, kJournalMagic, sizeof(h.magic)) != 0 || h.record_size != sizeof(JournalRecord)) {
+        std::fprintf(stderr, "%s: not a journal\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    capacity_ = std::min<size_t>(h.capacity, (static_cast<size_t>(st.st_size) - kJournalHeaderBytes) / sizeof(JournalRecord));
+    if (!map(fd, static_cast<size_t>(st.st_size), false)) { ::close(fd); return false; }
+    return true;
+}
+
+bool Journal::open(const std::string& path, size_t capacity, JournalSync sync, uint64_t sync_interval_ns) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) { perror(path.c_str()); return false; }
+
+    struct stat st{};
+    if (fstat(fd, &st) < 0) { perror("journal fstat"); ::close(fd); return false; }
+    JournalHeader h{};
+    if (st.st_size == 0) {
+        // New file: write the header and preallocate every record up front,
+        // so appends never extend the file.
+        std::memcpy(h.magic, kJournalMagic, sizeof(h.magic));
+        h.version = 1;
+        h.record_size = sizeof(JournalRecord);
+        h.capacity = capacity;
+        const off_t total = static_cast<off_t>(kJournalHeaderBytes + capacity * sizeof(JournalRecord));
+#if defined(__linux__)
+        // Reserve the blocks now; fall back to a sparse file where unsupported.
+        const bool sized = posix_fallocate(fd, 0, total) == 0 || ftruncate(fd, total) == 0;
+#else
+        const bool sized = ftruncate(fd, total) == 0;
+#endif
+        if (!sized || pwrite(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))) {
+            perror("journal preallocate");
+            ::close(fd);
+            return false;
+        }
+        st.st_size = total;
+    } else if (pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+               std::memcmp(h.magic, kJournalMagic, sizeof(h.magic)) != 0 ||
+               h.record_size != sizeof(JournalRecord) ||
+               static_cast<size_t>(st.st_size) < kJournalHeaderBytes + h.capacity * sizeof(JournalRecord)) {
+        std::fprintf(stderr, "%s: not a journal\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    capacity_ = h.capacity;   // an existing file keeps its own size
+    if (!map(fd, static_cast<size_t>(st.st_size), true)) { ::close(fd); return false; }
+
+    sync_ = sync;
+    sync_interval_ns_ = sync_interval_ns;
+    stop_ = false;
+    if (sync_ == JournalSync::Periodic) syncer_ = std::thread(&Journal::syncLoop, this);
+    return true;
+}
+
+void Journal::close() {
+    if (syncer_.joinable()) {
+        { std::lock_guard<std::mutex> lk(stop_m_); stop_ = true; }
+        stop_cv_.notify_all();
+        syncer_.join();
+    }
+    if (base_) {
+        if (sync_ != JournalSync::None) syncRange(0, next_.load(std::memory_order_relaxed));
+        munmap(base_, bytes_);
+        base_ = nullptr;
+        records_ = nullptr;
+    }
+    if (fd_ >= 0) { ::close(fd_); fd_ = -1; }
+}
+
+uint64_t Journal::append(JournalRecord r) {
+    const uint64_t i = next_.fetch_add(1, std::memory_order_relaxed);
+    if (i >= capacity_) { next_.store(capacity_, std::memory_order_relaxed); return 0; }
+    r.seq = i + 1;
+    std::memset(r.reserved, 0, sizeof(r.reserved));
+    r.check = journalChecksum(r);
+    std::memcpy(&records_[i], &r, sizeof(r));
+    return r.seq;
+}
+
+void Journal::commit(uint64_t first_seq, uint64_t last_seq) {
+    if (sync_ != JournalSync::Batch || first_seq == 0 || last_seq < first_seq) return;
+    syncRange(first_seq - 1, last_seq);
+}
+
+void Journal::syncRange(size_t first, size_t end) {
+    if (end > capacity_) end = capacity_;
+    if (end <= first) return;
+    const size_t page = pageSize();
+    const size_t lo = (kJournalHeaderBytes + first * sizeof(JournalRecord)) / page * page;
+    const size_t hi = kJournalHeaderBytes + end * sizeof(JournalRecord);
+    if (msync(base_ + lo, hi - lo, MS_SYNC) < 0) perror("journal msync");
+    syncs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Journal::syncLoop() {
+    std::unique_lock<std::mutex> lk(stop_m_);
+    while (!stop_) {
+        stop_cv_.wait_for(lk, std::chrono::nanoseconds(sync_interval_ns_));
+        if (stop_) break;
+        lk.unlock();
+        // The kernel only writes pages that are dirty, so syncing everything
+        // written so far costs no more than syncing the newest records.
+        syncRange(0, next_.load(std::memory_order_relaxed));
+        lk.lock();
+    }
+}
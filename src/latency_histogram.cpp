@@ -0,0 +1,64 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+
+void LatencyHistogram::merge(const LatencyHistogram& o) {
+    for (size_t i = 0; i < kBuckets; ++i) counts_[i] += o.counts_[i];
+    count_ += o.count_;
+    sum_ += o.sum_;
+    min_ = std::min(min_, o.min_);
+    max_ = std::max(max_, o.max_);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    count_ = 0;
+    sum_ = 0.0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) return 0;
+    // Rank of the sample at p, 1-based and rounded to nearest (as HdrHistogram
+    // does), so p50 of 10 samples is the 5th.
+    const double want = p / 100.0 * static_cast<double>(count_) + 0.5;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(want));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) return std::min(highest(i), max_);
+    }
+    return max_;
+}
+
+void LatencyHistogram::writePercentiles(std::ostream& out, double unit) const {
+    char line[128];
+    out << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+    uint64_t seen = 0;
+    double sq = 0.0;   // for the standard deviation
+    const double mu = mean();
+    for (size_t i = 0; i < kBuckets; ++i) {
+        if (!counts_[i]) continue;
+        seen += counts_[i];
+        const double v = static_cast<double>(std::min(highest(i), max_));
+        sq += static_cast<double>(counts_[i]) * (v - mu) * (v - mu);
+        const double q = static_cast<double>(seen) / static_cast<double>(count_);
+        if (q < 1.0) std::snprintf(line, sizeof(line), "%12.3f %14.12f %10llu %14.2f\n", v / unit, q,
+                                   static_cast<unsigned long long>(seen), 1.0 / (1.0 - q));
+        else         std::snprintf(line, sizeof(line), "%12.3f %14.12f %10llu\n", v / unit, q,
+                                   static_cast<unsigned long long>(seen));
+        out << line;
+    }
+    const double sd = count_ ? std::sqrt(sq / static_cast<double>(count_)) : 0.0;
+    std::snprintf(line, sizeof(line), "#[Mean    = %12.3f, StdDeviation   = %12.3f]\n", mu / unit, sd / unit);
+    out << line;
+    std::snprintf(line, sizeof(line), "#[Max     = %12.3f, Total count    = %12llu]\n",
+                  static_cast<double>(max_) / unit, static_cast<unsigned long long>(count_));
+    out << line;
+    std::snprintf(line, sizeof(line), "#[Buckets = %12zu, SubBuckets     = %12zu]\n", kBuckets, kSub);
+    out << line;
+}
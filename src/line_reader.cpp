@@ -0,0 +1,51 @@
+#include "line_reader.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+
+LineReader::LineReader(size_t max_line, size_t chunk)
+: max_line_(max_line), chunk_(chunk ? chunk : 4096), buf_(max_line + chunk_ + 1) {}
+
+bool LineReader::nextLine(std::string_view& line) {
+    if (scan_ >= end_) return false;
+    const char* base = buf_.data();
+    const void* nl = std::memchr(base + scan_, '\n', end_ - scan_);
+    if (!nl) { scan_ = end_; return false; }
+    const size_t pos = static_cast<size_t>(static_cast<const char*>(nl) - base);
+    line = std::string_view(base + begin_, pos - begin_);
+    begin_ = scan_ = pos + 1;
+    return true;
+}
+
+ssize_t LineReader::fill(int fd, int recv_flags) {
+    // Slide the partial line to the front once the tail gets short.
+    if (begin_ == end_) {
+        begin_ = scan_ = end_ = 0;
+    } else if (buf_.size() - end_ < chunk_ && begin_ > 0) {
+        const size_t n = end_ - begin_;
+        std::memmove(buf_.data(), buf_.data() + begin_, n);
+        scan_ -= begin_;
+        begin_ = 0;
+        end_ = n;
+    }
+    if (end_ == buf_.size()) { errno = ENOBUFS; return -1; }
+
+    ++recv_calls_;
+    const ssize_t r = recv(fd, buf_.data() + end_, buf_.size() - end_, recv_flags);
+    if (r > 0) end_ += static_cast<size_t>(r);
+    return r;
+}
+
+LineReader::Status LineReader::readLine(int fd, std::string_view& line, int recv_flags) {
+    while (true) {
+        if (nextLine(line)) return Status::Line;
+        if (overflow()) return Status::TooLong;
+        const ssize_t r = fill(fd, recv_flags);
+        if (r > 0) continue;
+        if (r == 0) return Status::Closed;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return Status::Again;
+        return Status::Error;
+    }
+}
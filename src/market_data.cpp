@@ -1,4 +1,5 @@
 #include "market_data.hpp"
+#include <sys/socket.h>
 #include <unistd.h>
 #include <cstring>
 #include <iostream>
@@ -32,6 +33,86 @@ MarketDataPublisher::~MarketDataPublisher() {
 
 void MarketDataPublisher::sendLine(const std::string& line) const {
     if (!enabled_ || sock_ < 0) return;
-    (void)sendto(sock_, line.data(), line.size(), 0,
-                 reinterpret_cast<const sockaddr*>(&dest_), sizeof(dest_));
+    if (sendto(sock_, line.data(), line.size(), 0,
+               reinterpret_cast<const sockaddr*>(&dest_), sizeof(dest_)) >= 0) {
+        datagrams_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(line.size(), std::memory_order_relaxed);
+    }
+}
+
+void MarketDataPublisher::sendDatagrams(const struct iovec* dgrams, size_t n) const {
+    if (!enabled_ || sock_ < 0 || n == 0) return;
+    uint64_t sent = 0, bytes = 0;
+#ifdef __linux__
+    constexpr size_t kChunk = 64;
+    struct mmsghdr msgs[kChunk];
+    while (n) {
+        const size_t k = n < kChunk ? n : kChunk;
+        std::memset(msgs, 0, k * sizeof(msgs[0]));
+        for (size_t i = 0; i < k; ++i) {
+            msgs[i].msg_hdr.msg_name    = const_cast<sockaddr_in*>(&dest_);
+            msgs[i].msg_hdr.msg_namelen = sizeof(dest_);
+            msgs[i].msg_hdr.msg_iov     = const_cast<struct iovec*>(&dgrams[i]);
+            msgs[i].msg_hdr.msg_iovlen  = 1;
+        }
+        const int r = sendmmsg(sock_, msgs, static_cast<unsigned>(k), 0);
+        if (r <= 0) break;   // UDP: drop the rest, subscribers see the gap
+        for (int i = 0; i < r; ++i) bytes += dgrams[i].iov_len;
+        sent += static_cast<uint64_t>(r);
+        dgrams += r; n -= static_cast<size_t>(r);
+    }
+#else
+    for (size_t i = 0; i < n; ++i) {
+        if (sendto(sock_, dgrams[i].iov_base, dgrams[i].iov_len, 0,
+                   reinterpret_cast<const sockaddr*>(&dest_), sizeof(dest_)) < 0) continue;
+        ++sent; bytes += dgrams[i].iov_len;
+    }
+#endif
+    datagrams_.fetch_add(sent, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+MdChannel::MdChannel(const MarketDataPublisher& pub, uint16_t channel, uint64_t flush_ns)
+: pub_(pub), channel_(channel), flush_ns_(flush_ns), buf_(kMaxDatagrams * kMdMaxDatagram) {}
+
+void MdChannel::publish(const BookEvent& ev, SymbolId symbol, uint64_t ts_ns) {
+    if (!mdPublishes(ev.type)) return;
+    const MdMsg m = mdEncode(ev, symbol, ts_ns);
+    append(&m, ts_ns);
+}
+
+void MdChannel::publish(const MdLevelMsg& rec) {
+    append(&rec, rec.ts_ns);
+}
+
+void MdChannel::append(const void* rec, uint64_t ts_ns) {
+    MdPacketHeader* h = dgrams_ ? header(dgrams_ - 1) : nullptr;
+    if (!h || h->count == kMdMsgsPerDatagram || h->first_seq + h->count != next_seq_) {
+        if (dgrams_ == kMaxDatagrams) flush();
+        h = header(dgrams_++);
+        h->magic     = kMdMagic;
+        h->version   = kMdVersion;
+        h->channel   = channel_;
+        h->count     = 0;
+        h->reserved  = 0;
+        h->first_seq = next_seq_;
+    }
+    if (next_seq_ == h->first_seq && dgrams_ == 1) oldest_ts_ = ts_ns;
+
+    std::memcpy(reinterpret_cast<char*>(h + 1) + h->count * sizeof(MdMsg), rec, sizeof(MdMsg));
+    ++h->count;
+    ++next_seq_;
+
+    if (ts_ns - oldest_ts_ >= flush_ns_) flush();
+}
+
+void MdChannel::flush() {
+    if (!dgrams_) return;
+    struct iovec iov[kMaxDatagrams];
+    for (size_t d = 0; d < dgrams_; ++d) {
+        iov[d].iov_base = header(d);
+        iov[d].iov_len  = sizeof(MdPacketHeader) + header(d)->count * sizeof(MdMsg);
+    }
+    pub_.sendDatagrams(iov, dgrams_);
+    dgrams_ = 0;
 }
\ No newline at end of file
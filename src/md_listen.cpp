@@ -1,19 +1,144 @@
+#include "md_feed.hpp"
+
 #include <arpa/inet.h>
 #include <unistd.h>
-#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <iostream>
 #include <string>
+#include <sys/time.h>
+#include <unordered_map>
+
+static volatile std::sig_atomic_t g_stop = 0;
+static void handle_sigint(int) { g_stop = 1; }
+
+static std::string fmt_price(int64_t ticks) {
+    static const PriceFormat px(100);   // the exchange's tick factor
+    return px(ticks);
+}
+
+static std::string sym_tag(SymbolId sym) {
+    return sym == kDefaultSymbol ? std::string() : " sym " + symbolName(sym);
+}
+
+// One depth or snapshot record as text.
+static std::string format_level(const MdLevelMsg& r) {
+    const char* side = r.side == 0 ? "BID" : "ASK";
+    std::string s;
+    switch (static_cast<MdType>(r.type)) {
+        case MdType::LevelNew:      s = std::string("L2 NEW ") + side; break;
+        case MdType::LevelUpdate:   s = std::string("L2 UPDATE ") + side; break;
+        case MdType::LevelDelete:   return std::string("L2 DELETE ") + side + " " + fmt_price(r.price_ticks) + sym_tag(r.symbol);
+        case MdType::SnapshotBegin:
+            return "SNAPSHOT BEGIN channel " + std::to_string(r.channel) + " seq " + std::to_string(r.ref_seq) +
+                   " top " + std::to_string(r.qty) + " levels " + std::to_string(r.count) + sym_tag(r.symbol);
+        case MdType::SnapshotLevel: s = std::string("SNAPSHOT ") + side; break;
+        case MdType::SnapshotEnd:   return "SNAPSHOT END" + sym_tag(r.symbol);
+        default:                    return "UNKNOWN record type " + std::to_string(r.type);
+    }
+    return s + " " + fmt_price(r.price_ticks) + " x " + std::to_string(r.qty) +
+           " (" + std::to_string(r.count) + " orders)" + sym_tag(r.symbol);
+}
+
+// Late / gapped subscriber recovery: fetch every book from the exchange's
+// snapshot server. Increments after each book's 'seq' apply on top.
+static void fetch_snapshot(uint16_t port) {
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s < 0) { perror("socket"); return; }
+    sockaddr_in a{}; a.sin_family = AF_INET; a.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &a.sin_addr);
+    if (connect(s, (sockaddr*)&a, sizeof(a)) < 0) { perror("snapshot connect"); close(s); return; }
+    const char req[] = "SNAPSHOT\n";
+    (void)send(s, req, sizeof(req) - 1, MSG_NOSIGNAL);
+
+    std::string buf;
+    char tmp[4096];
+    ssize_t n;
+    while ((n = recv(s, tmp, sizeof(tmp), 0)) > 0) buf.append(tmp, static_cast<size_t>(n));
+    close(s);
+    std::cout << "RECOVERY snapshot: " << buf.size() / sizeof(MdLevelMsg) << " records\n";
+    for (size_t off = 0; off + sizeof(MdLevelMsg) <= buf.size(); off += sizeof(MdLevelMsg)) {
+        MdLevelMsg r;
+        std::memcpy(&r, buf.data() + off, sizeof(r));
+        std::cout << "  " << format_level(r) << "\n";
+    }
+}
+
+struct Counters {
+    uint64_t datagrams = 0, bytes = 0, msgs = 0, gaps = 0, lost = 0, stale = 0;
+};
+
+// Decodes one binary datagram; checks its sequence against the channel's
+// next expected number and prints the messages unless 'quiet'.
+static void on_binary(const char* buf, size_t n, std::unordered_map<uint16_t, uint64_t>& expected,
+                      Counters& c, bool quiet, uint16_t snapshot_port) {
+    MdPacketHeader h;
+    if (n < sizeof(h)) { std::cerr << "short datagram (" << n << " bytes)\n"; return; }
+    std::memcpy(&h, buf, sizeof(h));
+    if (h.version != kMdVersion || n != sizeof(h) + h.count * sizeof(MdMsg)) {
+        std::cerr << "malformed datagram (version " << int(h.version) << ", " << n << " bytes)\n";
+        return;
+    }
+
+    auto it = expected.find(h.channel);
+    const uint64_t want = it == expected.end() ? 1 : it->second;
+    if (h.first_seq + h.count <= want) { ++c.stale; return; }   // duplicate / reordered
+    if (h.first_seq > want) {
+        ++c.gaps;
+        c.lost += h.first_seq - want;
+        std::cout << "GAP channel " << h.channel << ": expected " << want
+                  << ", got " << h.first_seq << " (" << (h.first_seq - want) << " lost)\n";
+        if (snapshot_port && !(h.channel & kMdSnapshotChannel)) fetch_snapshot(snapshot_port);
+    }
+    expected[h.channel] = h.first_seq + h.count;
+    c.msgs += h.count;
+
+    if (quiet) return;
+    for (uint16_t i = 0; i < h.count; ++i) {
+        if (h.first_seq + i < want) continue;   // overlap with what we already have
+        const char* rec = buf + sizeof(h) + i * sizeof(MdMsg);
+        std::cout << h.channel << ":" << (h.first_seq + i) << " ";
+        if (mdIsLevelRecord(static_cast<uint8_t>(rec[0]))) {
+            MdLevelMsg r;
+            std::memcpy(&r, rec, sizeof(r));
+            std::cout << format_level(r) << "\n";
+        } else {
+            MdMsg m;
+            std::memcpy(&m, rec, sizeof(m));
+            std::cout << formatEvent(mdDecode(m), fmt_price) << sym_tag(m.symbol) << "\n";
+        }
+    }
+}
 
 int main(int argc, char** argv) {
     std::string host = "0.0.0.0"; // bind all
     uint16_t port = 9001;
-    if (argc >= 2) port = static_cast<uint16_t>(std::atoi(argv[1]));
+    bool stats = false;   // --stats: print per-second rates instead of messages
+    uint16_t snapshot_port = 0;   // --snapshot-port P: recover from the exchange on a gap
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--stats") stats = true;
+        else if (a == "--snapshot-port" && i+1 < argc) snapshot_port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else port = static_cast<uint16_t>(std::atoi(argv[i]));
+    }
+
+    struct sigaction sa{};
+    sa.sa_handler = handle_sigint;   // no SA_RESTART: interrupt recvfrom
+    sigaction(SIGINT, &sa, nullptr);
 
     int s = socket(AF_INET, SOCK_DGRAM, 0);
     if (s < 0) { perror("socket"); return 1; }
 
     int yes = 1;
     setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    int rcvbuf = 4 << 20;
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv{1, 0};
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
     sockaddr_in addr{}; addr.sin_family = AF_INET;
     addr.sin_port = htons(port);
@@ -23,14 +148,44 @@ int main(int argc, char** argv) {
         perror("bind"); close(s); return 1;
     }
 
-    std::cout << "UDP MD listener on " << host << ":" << port << "\n";
+    std::cout << "UDP MD listener on " << host << ":" << port << " (text or binary feed)\n";
+    std::unordered_map<uint16_t, uint64_t> expected;   // channel -> next sequence
+    Counters total, window;
+    auto window_start = std::chrono::steady_clock::now();
     char buf[2048];
-    while (true) {
+    while (!g_stop) {
         ssize_t n = recvfrom(s, buf, sizeof(buf)-1, 0, nullptr, nullptr);
-        if (n <= 0) break;
-        buf[n] = '\0';
-        std::cout << buf << std::endl;
+        if (n > 0) {
+            ++window.datagrams; window.bytes += static_cast<uint64_t>(n);
+            if (static_cast<uint8_t>(buf[0]) == kMdMagic) {
+                on_binary(buf, static_cast<size_t>(n), expected, window, stats, snapshot_port);
+            } else {
+                ++window.msgs;
+                buf[n] = '\0';
+                if (!stats) std::cout << buf << std::endl;
+            }
+        } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            break;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const double secs = std::chrono::duration<double>(now - window_start).count();
+        if (secs >= 1.0 || g_stop) {
+            if (stats && window.datagrams)
+                std::cout << "datagrams/s " << static_cast<uint64_t>(window.datagrams / secs)
+                          << "  bytes/s " << static_cast<uint64_t>(window.bytes / secs)
+                          << "  msgs/s " << static_cast<uint64_t>(window.msgs / secs)
+                          << "  gaps " << window.gaps << " (" << window.lost << " lost)\n";
+            total.datagrams += window.datagrams; total.bytes += window.bytes;
+            total.msgs += window.msgs; total.gaps += window.gaps;
+            total.lost += window.lost; total.stale += window.stale;
+            window = Counters{};
+            window_start = now;
+        }
     }
+    std::cout << "Total: " << total.datagrams << " datagrams, " << total.bytes << " bytes, "
+              << total.msgs << " messages, " << total.gaps << " gaps (" << total.lost << " lost), "
+              << total.stale << " stale\n";
     close(s);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,120 @@
+#include "md_publisher.hpp"
+#include "wall_clock.hpp"
+
+#include <chrono>
+
+MdWriter::MdWriter(const MarketDataPublisher& pub, uint16_t shard, const MdWriterConfig& cfg)
+: pub_(pub), cfg_(cfg),
+  feed_(pub, shard, cfg.flush_ns),
+  snapshots_(pub, static_cast<uint16_t>(shard | kMdSnapshotChannel), cfg.flush_ns) {}
+
+void MdWriter::publish(const BookEvent& ev, SymbolId symbol, uint64_t ts_ns) {
+    if (cfg_.binary) { feed_.publish(ev, symbol, ts_ns); return; }
+    line_.clear();
+    appendEvent(line_, ev, cfg_.price);
+    if (symbol != kDefaultSymbol) { line_ += " sym "; line_ += symbolName(symbol); }
+    pub_.sendLine(line_);
+}
+
+void MdWriter::sequence(MdChannel& ch, uint64_t& last, uint64_t seq) {
+    if (seq > last + 1) ch.skip(seq - last - 1);
+    last = seq;
+}
+
+void MdWriter::handle(const MdItem& item) {
+    switch (item.kind) {
+        case MdItem::Kind::Event: {
+            if (cfg_.binary) sequence(feed_, feed_in_, item.seq);
+            const BookEventType t = item.ev.type;
+            if (cfg_.conflate_ns && (t == BookEventType::BestBid || t == BookEventType::BestAsk)) {
+                // Keep only the latest; trades and order events are never held back.
+                Bbo& b = bbo_[item.symbol];
+                const int s = t == BookEventType::BestBid ? 0 : 1;
+                if (b.pending[s]) ++conflated_;
+                b.ev[s] = item.ev;
+                b.ts[s] = item.ts_ns;
+                b.pending[s] = true;
+                bbo_pending_ = true;
+                return;
+            }
+            publish(item.ev, item.symbol, item.ts_ns);
+            return;
+        }
+        case MdItem::Kind::Level:
+            sequence(feed_, feed_in_, item.seq);
+            feed_.publish(item.rec);
+            return;
+        case MdItem::Kind::Snapshot:
+            sequence(snapshots_, snap_in_, item.seq);
+            snapshots_.publish(item.rec);
+            return;
+        case MdItem::Kind::Flush:    flush(item.ts_ns); return;
+    }
+}
+
+void MdWriter::flush(uint64_t now_ns) {
+    if (bbo_pending_ && now_ns - window_start_ >= cfg_.conflate_ns) {
+        for (auto& kv : bbo_) {
+            for (int s = 0; s < 2; ++s) {
+                if (!kv.second.pending[s]) continue;
+                publish(kv.second.ev[s], kv.first, kv.second.ts[s]);
+                kv.second.pending[s] = false;
+            }
+        }
+        bbo_pending_ = false;
+        window_start_ = now_ns;
+    }
+    feed_.flush();
+    snapshots_.flush();
+}
+
+MdPublisherThread::MdPublisherThread(const MarketDataPublisher& pub, size_t shards,
+                                     const MdWriterConfig& cfg, size_t ring_capacity) {
+    for (size_t s = 0; s < shards; ++s) {
+        rings_.push_back(std::make_unique<SpscRing<MdItem>>(ring_capacity));
+        writers_.push_back(std::make_unique<MdWriter>(pub, static_cast<uint16_t>(s), cfg));
+    }
+}
+
+void MdPublisherThread::start(std::function<void()> on_start) {
+    thr_ = std::thread([this, on_start = std::move(on_start)] {
+        if (on_start) on_start();
+        run();
+    });
+}
+
+void MdPublisherThread::stop() {
+    if (!thr_.joinable()) return;
+    stop_.store(true, std::memory_order_release);
+    thr_.join();
+}
+
+uint64_t MdPublisherThread::conflated() const {
+    uint64_t n = 0;
+    for (const auto& w : writers_) n += w->conflated();
+    return n;
+}
+
+void MdPublisherThread::run() {
+    std::vector<MdItem> buf(256);
+    unsigned idle = 0;
+    while (true) {
+        const bool stopping = stop_.load(std::memory_order_acquire);
+        size_t got = 0;
+        for (size_t s = 0; s < rings_.size(); ++s) {
+            const size_t n = rings_[s]->popBatch(buf.data(), buf.size());
+            for (size_t i = 0; i < n; ++i) writers_[s]->handle(buf[i]);
+            got += n;
+        }
+        if (got) { idle = 0; continue; }
+
+        // Every ring is empty: send what is batched, then back off.
+        const uint64_t now = wall_ns();
+        for (auto& w : writers_) w->flush(now);
+        if (stopping) break;   // rings were empty after stop was requested
+        if (++idle < 16) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    // Conflated BBOs still pending go out now.
+    for (auto& w : writers_) w->flush(UINT64_MAX);
+}
@@ -1,193 +1,298 @@
 #include "order_book.hpp"
 #include <algorithm>
-#include <sstream>
+
+static const char* sideName(Side s) { return s == Side::Buy ? "BUY" : "SELL"; }
+
+// One writer for both entry points; 'price' appends a price to 'out'.
+template <class AppendPrice>
+static void writeEvent(std::string& out, const BookEvent& ev, const AppendPrice& price) {
+    switch (ev.type) {
+        case BookEventType::Added:
+            out += "ORDER_ADDED "; out += sideName(ev.side); out += ' ';
+            appendInt(out, ev.qty); out += " @ "; price(ev.price_ticks);
+            out += " id "; appendInt(out, ev.order_id);
+            break;
+        case BookEventType::Trade:
+            // Aggressor side first
+            out += "TRADE "; out += sideName(ev.side); out += ' ';
+            appendInt(out, ev.qty); out += " @ "; price(ev.price_ticks);
+            out += " against id "; appendInt(out, ev.order_id);
+            break;
+        case BookEventType::Canceled:
+            out += "CANCELED id "; appendInt(out, ev.order_id);
+            break;
+        case BookEventType::Replaced:
+            out += "REPLACED "; appendInt(out, ev.order_id);
+            out += " -> "; appendInt(out, ev.new_id);
+            break;
+        case BookEventType::BestBid:
+            out += "BEST_BID "; price(ev.price_ticks); out += " x "; appendInt(out, ev.qty);
+            break;
+        case BookEventType::BestAsk:
+            out += "BEST_ASK "; price(ev.price_ticks); out += " x "; appendInt(out, ev.qty);
+            break;
+        case BookEventType::Reject:
+            switch (ev.reason) {
+                case RejectReason::InvalidOrder:   out += "ERROR Invalid order"; break;
+                case RejectReason::InvalidSeed:    out += "ERROR Invalid seed"; break;
+                case RejectReason::UnknownOrderId: out += "ERROR Unknown order id "; appendInt(out, ev.order_id); break;
+                case RejectReason::CancelFailed:   out += "ERROR Unable to cancel id "; appendInt(out, ev.order_id); break;
+                case RejectReason::InvalidReplace: out += "ERROR Invalid replace parameters"; break;
+                case RejectReason::JournalFull:    out += "ERROR Journal full"; break;
+            }
+            break;
+    }
+}
+
+void appendEvent(std::string& out, const BookEvent& ev, const PriceFormat& px) {
+    writeEvent(out, ev, [&](int64_t t) { px.append(out, t); });
+}
+
+std::string formatEvent(const BookEvent& ev, const std::function<std::string(int64_t)>& fmt_price) {
+    std::string out;
+    writeEvent(out, ev, [&](int64_t t) { out += fmt_price(t); });
+    return out;
+}
+
+static std::vector<std::string> formatEvents(const BookEvents& evs,
+                                             const std::function<std::string(int64_t)>& fmt_price) {
+    std::vector<std::string> out;
+    out.reserve(evs.size());
+    for (const auto& ev : evs) out.push_back(formatEvent(ev, fmt_price));
+    return out;
+}
+
+static BookEvent reject(RejectReason reason, int64_t order_id = 0) {
+    BookEvent ev;
+    ev.type = BookEventType::Reject;
+    ev.reason = reason;
+    ev.order_id = order_id;
+    return ev;
+}
+
+static BookEvent added(Side side, int qty, int64_t price_ticks, int64_t order_id) {
+    BookEvent ev;
+    ev.type = BookEventType::Added;
+    ev.side = side;
+    ev.qty = qty;
+    ev.price_ticks = price_ticks;
+    ev.order_id = order_id;
+    return ev;
+}
+
+size_t arenaEstimate(const BookConfig& cfg) {
+    if (cfg.arena_bytes) return cfg.arena_bytes;
+    const size_t n = cfg.pool_capacity;
+    const size_t span = cfg.ladder == LadderKind::Dense ? static_cast<size_t>(std::max<int64_t>(cfg.dense_span, 64)) + 64 : 0;
+    // Nodes; id index pages for twice as many ids (live ids are spread out);
+    // two dense windows and their bitmaps; 1 MB for sparse levels.
+    const size_t index_pages = 2 * n / OrderIndex<OrderNode>::kPageSlots + 2;
+    return n * sizeof(OrderNode) + index_pages * (OrderIndex<OrderNode>::kPageSlots + 2) * sizeof(void*) +
+           2 * span * (sizeof(OrderLevel) + 1) + (size_t{1} << 20);
+}
+
+OrderBook::OrderBook(const BookConfig& cfg)
+: mem_(cfg.alloc, arenaEstimate(cfg)),
+  pool_(cfg.pool_capacity, 4096, mem_.resource()),
+  index_(mem_.resource()),
+  bids_(true,  cfg.ladder, cfg.dense_span, mem_.resource()),
+  asks_(false, cfg.ladder, cfg.dense_span, mem_.resource()) {}
 
 void OrderBook::clear() {
     bids_.clear();
     asks_.clear();
     index_.clear();
+    pool_.reset();
 }
 
-std::vector<std::string> OrderBook::seed(Side side,
-                                         int qty,
-                                         int64_t price_ticks,
-                                         int64_t order_id,
-                                         const std::function<std::string(int64_t)>& fmt_price) {
-    std::vector<std::string> out;
+OrderNode* OrderBook::rest(Side side, int qty, int64_t price_ticks, int64_t order_id) {
+    OrderNode* n = pool_.acquire();
+    n->id = order_id;
+    n->price_ticks = price_ticks;
+    n->qty = qty;
+    n->side = side;
+    (side == Side::Buy ? bids_ : asks_).getOrCreate(price_ticks).push_back(n);
+    index_.insert(order_id, n);
+    return n;
+}
+
+// Unlinks a resting node from its level and returns it to the pool.
+// The caller is responsible for the index entry.
+void OrderBook::removeResting(OrderNode* n) {
+    Ladder& ladder = (n->side == Side::Buy) ? bids_ : asks_;
+    Level* lvl = ladder.find(n->price_ticks);
+    lvl->unlink(n);
+    if (lvl->empty()) ladder.erase(n->price_ticks);
+    pool_.release(n);
+}
+
+void OrderBook::seed(Side side, int qty, int64_t price_ticks, int64_t order_id, BookEvents& out) {
     if (qty <= 0 || price_ticks <= 0) {
-        out.emplace_back("ERROR Invalid seed");
-        return out;
+        out.push_back(reject(RejectReason::InvalidSeed));
+        return;
     }
-    if (side == Side::Buy) {
-        auto& lvl = bids_[price_ticks];
-        lvl.push_back(RestingOrder{order_id, qty});
-        index_[order_id] = {Side::Buy, price_ticks};
-        std::ostringstream oss;
-        oss << "ORDER_ADDED BUY " << qty << " @ " << fmt_price(price_ticks) << " id " << order_id;
-        out.push_back(oss.str());
-    } else {
-        auto& lvl = asks_[price_ticks];
-        lvl.push_back(RestingOrder{order_id, qty});
-        index_[order_id] = {Side::Sell, price_ticks};
-        std::ostringstream oss;
-        oss << "ORDER_ADDED SELL " << qty << " @ " << fmt_price(price_ticks) << " id " << order_id;
-        out.push_back(oss.str());
-    }
-    refreshSnapshots(out, fmt_price);
-    return out;
+    rest(side, qty, price_ticks, order_id);
+    out.push_back(added(side, qty, price_ticks, order_id));
+    refreshSnapshots(out);
 }
 
-void OrderBook::refreshSnapshots(std::vector<std::string>& out,
-                                 const std::function<std::string(int64_t)>& fmt_price) const {
+void OrderBook::refreshSnapshots(BookEvents& out) const {
     if (!bids_.empty()) {
-        std::ostringstream oss; oss << "BEST_BID " << fmt_price(bids_.begin()->first)
-                                    << " x " << levelQty(bids_.begin()->second);
-        out.push_back(oss.str());
+        BookEvent ev;
+        ev.type = BookEventType::BestBid;
+        ev.side = Side::Buy;
+        ev.price_ticks = bids_.bestPrice();
+        ev.qty = bids_.find(ev.price_ticks)->qty;
+        out.push_back(ev);
     }
     if (!asks_.empty()) {
-        std::ostringstream oss; oss << "BEST_ASK " << fmt_price(asks_.begin()->first)
-                                    << " x " << levelQty(asks_.begin()->second);
-        out.push_back(oss.str());
+        BookEvent ev;
+        ev.type = BookEventType::BestAsk;
+        ev.side = Side::Sell;
+        ev.price_ticks = asks_.bestPrice();
+        ev.qty = asks_.find(ev.price_ticks)->qty;
+        out.push_back(ev);
     }
 }
 
-std::vector<std::string> OrderBook::processOrder(Side side,
-                                                 int qty,
-                                                 int64_t price_ticks,
-                                                 int64_t order_id,
-                                                 const std::function<std::string(int64_t)>& fmt_price) {
-    std::vector<std::string> out;
+void OrderBook::processOrder(Side side, int qty, int64_t price_ticks, int64_t order_id, BookEvents& out) {
     if (qty <= 0 || price_ticks <= 0) {
-        out.emplace_back("ERROR Invalid order");
-        return out;
+        out.push_back(reject(RejectReason::InvalidOrder));
+        return;
     }
 
     int remaining = qty;
+    BookEvent trade;
+    trade.type = BookEventType::Trade;
+    trade.side = side; // incoming order is the aggressor when trades occur
 
-    if (side == Side::Buy) {
-        // BUY incoming => BUY is the aggressor when trades occur
-        while (remaining > 0 && !asks_.empty() && asks_.begin()->first <= price_ticks) {
-            auto lvl_it = asks_.begin();
-            auto& lvl = lvl_it->second;
-            while (remaining > 0 && !lvl.empty()) {
-                auto& resting = lvl.front();
-                int trade_qty = std::min(remaining, resting.qty);
-                {
-                    std::ostringstream oss;
-                    // Add BUY as aggressor
-                    oss << "TRADE BUY " << trade_qty << " @ " << fmt_price(lvl_it->first)
-                        << " against id " << resting.id;
-                    out.push_back(oss.str());
-                }
-                remaining  -= trade_qty;
-                resting.qty -= trade_qty;
-                if (resting.qty == 0) {
-                    index_.erase(resting.id);
-                    lvl.pop_front();
-                }
-            }
-            if (lvl.empty()) asks_.erase(lvl_it);
-        }
-        if (remaining > 0) {
-            auto& lvl = bids_[price_ticks];
-            lvl.push_back(RestingOrder{order_id, remaining});
-            index_[order_id] = {Side::Buy, price_ticks};
-            std::ostringstream oss;
-            oss << "ORDER_ADDED BUY " << remaining << " @ " << fmt_price(price_ticks)
-                << " id " << order_id;
-            out.push_back(oss.str());
-        }
-    } else { // Sell
-        // SELL incoming => SELL is the aggressor when trades occur
-        while (remaining > 0 && !bids_.empty() && bids_.begin()->first >= price_ticks) {
-            auto lvl_it = bids_.begin();
-            auto& lvl = lvl_it->second;
-            while (remaining > 0 && !lvl.empty()) {
-                auto& resting = lvl.front();
-                int trade_qty = std::min(remaining, resting.qty);
-                {
-                    std::ostringstream oss;
-                    // Add SELL as aggressor
-                    oss << "TRADE SELL " << trade_qty << " @ " << fmt_price(lvl_it->first)
-                        << " against id " << resting.id;
-                    out.push_back(oss.str());
-                }
-                remaining  -= trade_qty;
-                resting.qty -= trade_qty;
-                if (resting.qty == 0) {
-                    index_.erase(resting.id);
-                    lvl.pop_front();
-                }
+    Ladder& opp = (side == Side::Buy) ? asks_ : bids_;
+    auto crosses = [&](int64_t best) {
+        return side == Side::Buy ? best <= price_ticks : best >= price_ticks;
+    };
+
+    while (remaining > 0 && !opp.empty() && crosses(opp.bestPrice())) {
+        const int64_t lvl_px = opp.bestPrice();
+        Level& lvl = *opp.find(lvl_px);
+        while (remaining > 0 && !lvl.empty()) {
+            OrderNode* resting = lvl.head;
+            int trade_qty = std::min(remaining, resting->qty);
+            trade.qty = trade_qty;
+            trade.price_ticks = lvl_px;
+            trade.order_id = resting->id;
+            out.push_back(trade);
+            remaining -= trade_qty;
+            lvl.reduce(resting, trade_qty);
+            if (resting->qty == 0) {
+                index_.erase(resting->id);
+                lvl.unlink(resting);
+                pool_.release(resting);
             }
-            if (lvl.empty()) bids_.erase(lvl_it);
-        }
-        if (remaining > 0) {
-            auto& lvl = asks_[price_ticks];
-            lvl.push_back(RestingOrder{order_id, remaining});
-            index_[order_id] = {Side::Sell, price_ticks};
-            std::ostringstream oss;
-            oss << "ORDER_ADDED SELL " << remaining << " @ " << fmt_price(price_ticks)
-                << " id " << order_id;
-            out.push_back(oss.str());
         }
+        if (lvl.empty()) opp.erase(lvl_px);
+    }
+    if (remaining > 0) {
+        rest(side, remaining, price_ticks, order_id);
+        out.push_back(added(side, remaining, price_ticks, order_id));
     }
 
-    refreshSnapshots(out, fmt_price);
-    return out;
+    refreshSnapshots(out);
 }
 
-bool OrderBook::eraseFromBidsLevel(std::map<int64_t, Level, std::greater<int64_t>>::iterator lvl_it, int64_t id) {
-    auto& lvl = lvl_it->second;
-    for (auto it = lvl.begin(); it != lvl.end(); ++it) {
-        if (it->id == id) {
-            lvl.erase(it);
-            if (lvl.empty()) bids_.erase(lvl_it);
-            return true;
-        }
+bool OrderBook::depthAt(Side side, size_t level, LevelInfo& out) const {
+    bool found = false;
+    size_t i = 0;
+    ladder(side).forEach([&](int64_t px, const Level& lvl) {
+        if (i++ < level) return true;
+        out.price_ticks = px;
+        out.qty = lvl.qty;
+        out.count = lvl.count;
+        found = true;
+        return false;
+    }, level + 1);
+    return found;
+}
+
+size_t OrderBook::depth(Side side, size_t max_levels, std::vector<LevelInfo>& out) const {
+    size_t n = 0;
+    ladder(side).forEach([&](int64_t px, const Level& lvl) {
+        out.push_back(LevelInfo{px, lvl.qty, lvl.count});
+        ++n;
+        return true;
+    }, max_levels);
+    return n;
+}
+
+void OrderBook::cancel(int64_t order_id, BookEvents& out) {
+    OrderNode* n = index_.erase(order_id);
+    if (!n) {
+        out.push_back(reject(RejectReason::UnknownOrderId, order_id));
+        refreshSnapshots(out);
+        return;
     }
-    return false;
+    const Side side = n->side;
+    removeResting(n);
+
+    BookEvent ev;
+    ev.type = BookEventType::Canceled;
+    ev.side = side;
+    ev.order_id = order_id;
+    out.push_back(ev);
+    refreshSnapshots(out);
 }
 
-bool OrderBook::eraseFromAsksLevel(std::map<int64_t, Level>::iterator lvl_it, int64_t id) {
-    auto& lvl = lvl_it->second;
-    for (auto it = lvl.begin(); it != lvl.end(); ++it) {
-        if (it->id == id) {
-            lvl.erase(it);
-            if (lvl.empty()) asks_.erase(lvl_it);
-            return true;
-        }
+void OrderBook::replace(int64_t old_id, int new_qty, int64_t new_price_ticks, int64_t new_id, BookEvents& out) {
+    const OrderNode* n = index_.find(old_id);
+    if (!n) {
+        out.push_back(reject(RejectReason::UnknownOrderId, old_id));
+        refreshSnapshots(out);
+        return;
+    }
+    const Side side = n->side;
+
+    cancel(old_id, out);
+    if (new_qty <= 0 || new_price_ticks <= 0) {
+        out.push_back(reject(RejectReason::InvalidReplace, old_id));
+        refreshSnapshots(out);
+        return;
     }
-    return false;
+    BookEvent ev;
+    ev.type = BookEventType::Replaced;
+    ev.side = side;
+    ev.order_id = old_id;
+    ev.new_id = new_id;
+    out.push_back(ev);
+
+    processOrder(side, new_qty, new_price_ticks, new_id, out);
+}
+
+// ---- String adapters --------------------------------------------------------
+
+std::vector<std::string> OrderBook::seed(Side side,
+                                         int qty,
+                                         int64_t price_ticks,
+                                         int64_t order_id,
+                                         const std::function<std::string(int64_t)>& fmt_price) {
+    BookEvents evs;
+    seed(side, qty, price_ticks, order_id, evs);
+    return formatEvents(evs, fmt_price);
+}
+
+std::vector<std::string> OrderBook::processOrder(Side side,
+                                                 int qty,
+                                                 int64_t price_ticks,
+                                                 int64_t order_id,
+                                                 const std::function<std::string(int64_t)>& fmt_price) {
+    BookEvents evs;
+    processOrder(side, qty, price_ticks, order_id, evs);
+    return formatEvents(evs, fmt_price);
 }
 
 std::vector<std::string> OrderBook::cancel(int64_t order_id,
                                            const std::function<std::string(int64_t)>& fmt_price) {
-    std::vector<std::string> out;
-    auto it = index_.find(order_id);
-    if (it == index_.end()) {
-        out.emplace_back("ERROR Unknown order id " + std::to_string(order_id));
-        refreshSnapshots(out, fmt_price);
-        return out;
-    }
-    Side side = it->second.first;
-    int64_t px = it->second.second;
-
-    bool removed = false;
-    if (side == Side::Buy) {
-        auto lvl_it = bids_.find(px);
-        if (lvl_it != bids_.end()) removed = eraseFromBidsLevel(lvl_it, order_id);
-    } else {
-        auto lvl_it = asks_.find(px);
-        if (lvl_it != asks_.end()) removed = eraseFromAsksLevel(lvl_it, order_id);
-    }
-    if (removed) {
-        index_.erase(it);
-        out.emplace_back("CANCELED id " + std::to_string(order_id));
-    } else {
-        out.emplace_back("ERROR Unable to cancel id " + std::to_string(order_id));
-    }
-    refreshSnapshots(out, fmt_price);
-    return out;
+    BookEvents evs;
+    cancel(order_id, evs);
+    return formatEvents(evs, fmt_price);
 }
 
 std::vector<std::string> OrderBook::replace(int64_t old_id,
@@ -195,26 +300,7 @@ std::vector<std::string> OrderBook::replace(int64_t old_id,
                                             int64_t new_price_ticks,
                                             int64_t new_id,
                                             const std::function<std::string(int64_t)>& fmt_price) {
-    std::vector<std::string> out;
-
-    auto it = index_.find(old_id);
-    if (it == index_.end()) {
-        out.emplace_back("ERROR Unknown order id " + std::to_string(old_id));
-        refreshSnapshots(out, fmt_price);
-        return out;
-    }
-    Side side = it->second.first;
-
-    auto canc = cancel(old_id, fmt_price);
-    out.insert(out.end(), canc.begin(), canc.end());
-    if (new_qty <= 0 || new_price_ticks <= 0) {
-        out.emplace_back("ERROR Invalid replace parameters");
-        refreshSnapshots(out, fmt_price);
-        return out;
-    }
-    out.emplace_back("REPLACED " + std::to_string(old_id) + " -> " + std::to_string(new_id));
-
-    auto add = processOrder(side, new_qty, new_price_ticks, new_id, fmt_price);
-    out.insert(out.end(), add.begin(), add.end());
-    return out;
-}
\ No newline at end of file
+    BookEvents evs;
+    replace(old_id, new_qty, new_price_ticks, new_id, evs);
+    return formatEvents(evs, fmt_price);
+}
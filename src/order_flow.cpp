@@ -0,0 +1,260 @@
+#include "order_flow.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+template <class T>
+static bool parseNumber(std::string_view v, T& out) {
+    if constexpr (std::is_floating_point_v<T>) {
+        // from_chars for double is not available everywhere yet.
+        std::string tmp(v);
+        char* end = nullptr;
+        const double d = std::strtod(tmp.c_str(), &end);
+        if (tmp.empty() || *end) return false;
+        out = static_cast<T>(d);
+        return true;
+    } else {
+        const auto r = std::from_chars(v.data(), v.data() + v.size(), out);
+        return r.ec == std::errc() && r.ptr == v.data() + v.size();
+    }
+}
+
+bool setFlowOption(FlowConfig& cfg, std::string_view key, std::string_view value, std::string& err) {
+    bool ok = true;
+    if      (key == "seed")          ok = parseNumber(value, cfg.seed);
+    else if (key == "new_weight")    ok = parseNumber(value, cfg.new_weight) && cfg.new_weight >= 0;
+    else if (key == "cancel_weight") ok = parseNumber(value, cfg.cancel_weight) && cfg.cancel_weight >= 0;
+    else if (key == "modify_weight") ok = parseNumber(value, cfg.modify_weight) && cfg.modify_weight >= 0;
+    else if (key == "marketable")    ok = parseNumber(value, cfg.marketable) && cfg.marketable >= 0 && cfg.marketable <= 1;
+    else if (key == "mid_ticks")     ok = parseNumber(value, cfg.mid_ticks) && cfg.mid_ticks > 0;
+    else if (key == "walk_ticks")    ok = parseNumber(value, cfg.walk_ticks) && cfg.walk_ticks >= 0;
+    else if (key == "half_spread")   ok = parseNumber(value, cfg.half_spread) && cfg.half_spread >= 1;
+    else if (key == "depth_ticks")   ok = parseNumber(value, cfg.depth_ticks) && cfg.depth_ticks >= 0;
+    else if (key == "cross_ticks")   ok = parseNumber(value, cfg.cross_ticks) && cfg.cross_ticks >= 0;
+    else if (key == "qty_min")       ok = parseNumber(value, cfg.qty_min) && cfg.qty_min > 0;
+    else if (key == "qty_max")       ok = parseNumber(value, cfg.qty_max) && cfg.qty_max > 0;
+    else if (key == "qty_median")    ok = parseNumber(value, cfg.qty_median) && cfg.qty_median > 0;
+    else if (key == "qty_sigma")     ok = parseNumber(value, cfg.qty_sigma) && cfg.qty_sigma >= 0;
+    else if (key == "symbols")       ok = parseNumber(value, cfg.symbols) && cfg.symbols >= 0;
+    else if (key == "max_live")      ok = parseNumber(value, cfg.max_live);
+    else if (key == "qty_dist") {
+        if (value == "uniform")        cfg.qty_dist = QtyDist::Uniform;
+        else if (value == "lognormal") cfg.qty_dist = QtyDist::LogNormal;
+        else if (value == "fixed")     cfg.qty_dist = QtyDist::Fixed;
+        else ok = false;
+    } else {
+        err = "unknown setting '" + std::string(key) + "'";
+        return false;
+    }
+    if (!ok) err = "bad value '" + std::string(value) + "' for " + std::string(key);
+    return ok;
+}
+
+bool loadFlowConfig(const std::string& path, FlowConfig& cfg, std::string& err) {
+    std::ifstream in(path);
+    if (!in) { err = path + ": cannot open"; return false; }
+    std::string line;
+    size_t lineno = 0;
+    while (std::getline(in, line)) {
+        ++lineno;
+        std::string_view l = line;
+        if (const size_t hash = l.find('#'); hash != std::string_view::npos) l = l.substr(0, hash);
+        l = trim(l);
+        if (l.empty()) continue;
+        const size_t eq = l.find('=');
+        std::string e;
+        if (eq == std::string_view::npos) e = "expected key = value";
+        else if (setFlowOption(cfg, trim(l.substr(0, eq)), trim(l.substr(eq + 1)), e)) continue;
+        err = path + ":" + std::to_string(lineno) + ": " + e;
+        return false;
+    }
+    if (cfg.qty_min > cfg.qty_max) { err = path + ": qty_min > qty_max"; return false; }
+    if (cfg.new_weight <= 0) { err = path + ": new_weight must be > 0"; return false; }
+    return true;
+}
+
+FlowModel::FlowModel(const FlowConfig& cfg, uint64_t stream)
+: cfg_(cfg), rng_(cfg.seed * 0x9e3779b97f4a7c15ULL + stream), mid_(static_cast<double>(cfg.mid_ticks)) {
+    for (int i = 0; i < cfg_.symbols; ++i) {
+        SymbolId id = kDefaultSymbol;
+        encodeSymbol("SYM" + std::to_string(i), id);
+        symbols_.push_back(id);
+    }
+    if (symbols_.empty()) symbols_.push_back(kDefaultSymbol);
+}
+
+int FlowModel::drawQty() {
+    double q = 0;
+    switch (cfg_.qty_dist) {
+        case QtyDist::Fixed:     q = cfg_.qty_median; break;
+        case QtyDist::Uniform:   q = std::uniform_int_distribution<int>(cfg_.qty_min, cfg_.qty_max)(rng_); break;
+        case QtyDist::LogNormal: q = std::lognormal_distribution<double>(std::log(cfg_.qty_median), cfg_.qty_sigma)(rng_); break;
+    }
+    return std::clamp(static_cast<int>(std::lround(q)), cfg_.qty_min, cfg_.qty_max);
+}
+
+int64_t FlowModel::passivePrice(Side side) {
+    // Geometric distance behind the touch: most orders near it, a tail deeper.
+    int64_t behind = 0;
+    if (cfg_.depth_ticks > 0)
+        behind = std::geometric_distribution<int64_t>(1.0 / (1.0 + cfg_.depth_ticks))(rng_);
+    const int64_t m = mid();
+    const int64_t px = side == Side::Buy ? m - cfg_.half_spread - behind : m + cfg_.half_spread + behind;
+    return std::max<int64_t>(1, px);
+}
+
+size_t FlowModel::pickLive() {
+    return std::uniform_int_distribution<size_t>(0, live_.size() - 1)(rng_);
+}
+
+void FlowModel::removeAt(size_t i) {
+    where_.erase(live_[i].id);
+    if (i + 1 != live_.size()) {
+        live_[i] = live_.back();
+        where_[live_[i].id] = i;
+    }
+    live_.pop_back();
+}
+
+FlowOrder FlowModel::next() {
+    // Mid-price random walk, kept clear of zero.
+    if (cfg_.walk_ticks > 0) mid_ += std::normal_distribution<double>(0.0, cfg_.walk_ticks)(rng_);
+    const double floor = static_cast<double>(cfg_.half_spread + cfg_.cross_ticks + 1);
+    if (mid_ < floor) mid_ = floor;
+
+    const double total = cfg_.new_weight + cfg_.cancel_weight + cfg_.modify_weight;
+    const double u = std::uniform_real_distribution<double>(0.0, total)(rng_);
+    FlowAction action = u < cfg_.new_weight ? FlowAction::New
+                      : u < cfg_.new_weight + cfg_.cancel_weight ? FlowAction::Cancel
+                                                                 : FlowAction::Modify;
+    if (action != FlowAction::New && live_.empty()) action = FlowAction::New;
+    if (action == FlowAction::New && cfg_.max_live && live_.size() >= cfg_.max_live) action = FlowAction::Cancel;
+
+    FlowOrder o;
+    o.action = action;
+    switch (action) {
+        case FlowAction::New: {
+            o.side = std::uniform_int_distribution<int>(0, 1)(rng_) ? Side::Sell : Side::Buy;
+            o.symbol = symbols_[std::uniform_int_distribution<size_t>(0, symbols_.size() - 1)(rng_)];
+            o.qty = drawQty();
+            o.marketable = std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < cfg_.marketable;
+            if (o.marketable) {
+                const int64_t m = mid();
+                o.price_ticks = o.side == Side::Buy ? m + cfg_.cross_ticks : std::max<int64_t>(1, m - cfg_.cross_ticks);
+                ++stats_.marketable;
+            } else {
+                o.price_ticks = passivePrice(o.side);
+            }
+            ++stats_.news;
+            break;
+        }
+        case FlowAction::Cancel: {
+            const size_t i = pickLive();
+            o.order_id = live_[i].id;
+            o.side = live_[i].side;
+            o.symbol = live_[i].symbol;
+            removeAt(i);   // never cancel the same order twice
+            ++stats_.cancels;
+            break;
+        }
+        case FlowAction::Modify: {
+            // A replace always retires the old id; the new one comes back in
+            // the ORDER_ADDED that follows.
+            const size_t i = pickLive();
+            o.order_id = live_[i].id;
+            o.side = live_[i].side;
+            o.symbol = live_[i].symbol;
+            removeAt(i);
+            o.qty = drawQty();
+            o.price_ticks = passivePrice(o.side);
+            ++stats_.modifies;
+            break;
+        }
+    }
+    return o;
+}
+
+void FlowModel::onAdded(int64_t id, Side side, SymbolId symbol, int qty) {
+    ++stats_.added;
+    if (where_.count(id)) return;
+    where_[id] = live_.size();
+    live_.push_back(Live{id, side, symbol, qty});
+}
+
+void FlowModel::onFill(int64_t id, int qty) {
+    const auto it = where_.find(id);
+    if (it == where_.end()) return;
+    Live& l = live_[it->second];
+    l.qty -= qty;
+    if (l.qty <= 0) removeAt(it->second);
+}
+
+void FlowModel::onGone(int64_t id) {
+    const auto it = where_.find(id);
+    if (it != where_.end()) removeAt(it->second);
+}
+
+// Integer after 'key' in 'line', or 0.
+static int64_t fieldAfter(std::string_view line, std::string_view key) {
+    const size_t p = line.find(key);
+    if (p == std::string_view::npos) return 0;
+    const char* b = line.data() + p + key.size();
+    int64_t v = 0;
+    std::from_chars(b, line.data() + line.size(), v);
+    return v;
+}
+
+void FlowModel::observeLine(std::string_view line) {
+    if (line.compare(0, 12, "ORDER_ADDED ") == 0) {
+        const Side side = line.compare(12, 3, "BUY") == 0 ? Side::Buy : Side::Sell;
+        SymbolId sym = kDefaultSymbol;
+        if (const size_t p = line.find(" sym "); p != std::string_view::npos) {
+            std::string_view s = line.substr(p + 5);
+            s = s.substr(0, s.find(' '));
+            encodeSymbol(s, sym);
+        }
+        onAdded(fieldAfter(line, " id "), side, sym, static_cast<int>(fieldAfter(line, side == Side::Buy ? "BUY " : "SELL ")));
+    } else if (line.compare(0, 6, "TRADE ") == 0) {
+        // Only the aggressor hears of a trade, so this sees our own orders
+        // crossing our resting ones; fills by other clients turn up later as
+        // "Unknown order id" rejects.
+        const Side side = line.compare(6, 3, "BUY") == 0 ? Side::Buy : Side::Sell;
+        onFill(fieldAfter(line, " against id "), static_cast<int>(fieldAfter(line, side == Side::Buy ? "BUY " : "SELL ")));
+    } else if (line.compare(0, 12, "CANCELED id ") == 0) {
+        onGone(fieldAfter(line, "CANCELED id "));
+    } else if (line.compare(0, 6, "ERROR ") == 0) {
+        onReject();
+        // The order is gone (filled by someone else): stop targeting it.
+        if (line.compare(0, 23, "ERROR Unknown order id ") == 0) onGone(fieldAfter(line, "order id "));
+        else if (line.compare(0, 25, "ERROR Unable to cancel id") == 0) onGone(fieldAfter(line, "cancel id "));
+    }
+}
+
+void FlowModel::appendText(const FlowOrder& o, int64_t tick_factor, std::string& out) {
+    char buf[96];
+    const std::string sym = o.symbol == kDefaultSymbol ? std::string() : symbolName(o.symbol) + " ";
+    auto price = [&](int64_t t) { return static_cast<double>(t) / static_cast<double>(tick_factor); };
+    switch (o.action) {
+        case FlowAction::New:
+            std::snprintf(buf, sizeof(buf), "NEW %s%s %d @ %.2f\n", sym.c_str(),
+                          o.side == Side::Buy ? "BUY" : "SELL", o.qty, price(o.price_ticks));
+            break;
+        case FlowAction::Cancel:
+            std::snprintf(buf, sizeof(buf), "CXL %s%lld\n", sym.c_str(), static_cast<long long>(o.order_id));
+            break;
+        case FlowAction::Modify:
+            std::snprintf(buf, sizeof(buf), "MOD %s%lld %d @ %.2f\n", sym.c_str(),
+                          static_cast<long long>(o.order_id), o.qty, price(o.price_ticks));
+            break;
+    }
+    out += buf;
+}
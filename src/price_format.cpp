@@ -0,0 +1,29 @@
+#include "price_format.hpp"
+
+PriceFormat::PriceFormat(int64_t tick_factor)
+: tick_factor_(tick_factor > 0 ? tick_factor : 1), scale_(1), decimals_(0) {
+    while (scale_ < tick_factor_ && decimals_ < 18) { scale_ *= 10; ++decimals_; }
+}
+
+char* PriceFormat::write(char* p, int64_t ticks) const {
+    // Magnitude as unsigned so INT64_MIN is fine.
+    uint64_t mag = ticks < 0 ? 0 - static_cast<uint64_t>(ticks) : static_cast<uint64_t>(ticks);
+    if (ticks < 0) *p++ = '-';
+    const uint64_t tf = static_cast<uint64_t>(tick_factor_);
+    uint64_t whole = mag / tf;
+    uint64_t frac = mag % tf;
+    if (tf != static_cast<uint64_t>(scale_)) {
+        // Rescale the remainder to decimals_ digits, rounding half up.
+        const unsigned __int128 f = (static_cast<unsigned __int128>(frac) * static_cast<uint64_t>(scale_) + tf / 2) / tf;
+        frac = static_cast<uint64_t>(f);
+        if (frac == static_cast<uint64_t>(scale_)) { frac = 0; ++whole; }
+    }
+    p = std::to_chars(p, p + 20, whole).ptr;
+    if (decimals_ == 0) return p;
+    *p++ = '.';
+    for (int i = decimals_ - 1; i >= 0; --i) {
+        p[i] = static_cast<char>('0' + frac % 10);
+        frac /= 10;
+    }
+    return p + decimals_;
+}
@@ -0,0 +1,139 @@
+#include "reactor.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+Reactor::Reactor(int listen_fd, int threads, DataHandler on_data,
+                 ConnHandler on_open, ConnHandler on_close)
+: listen_fd_(listen_fd), threads_(threads > 0 ? threads : 1), on_data_(std::move(on_data)),
+  on_open_(std::move(on_open)), on_close_(std::move(on_close)) {}
+
+Reactor::~Reactor() {
+    for (int fd : epfds_) if (fd >= 0) close(fd);
+    if (wake_fd_ >= 0) close(wake_fd_);
+}
+
+#if defined(__linux__)
+
+bool Reactor::run(std::function<void(int idx)> on_start) {
+    on_start_ = std::move(on_start);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) { perror("eventfd"); return false; }
+
+    int fl = fcntl(listen_fd_, F_GETFL, 0);
+    fcntl(listen_fd_, F_SETFL, fl | O_NONBLOCK);
+
+    running_ = true;
+    for (int i = 0; i < threads_; ++i) {
+        int ep = epoll_create1(EPOLL_CLOEXEC);
+        if (ep < 0) { perror("epoll_create1"); running_ = false; return false; }
+        epfds_.push_back(ep);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.fd = listen_fd_;
+        if (epoll_ctl(ep, EPOLL_CTL_ADD, listen_fd_, &ev) < 0) { perror("epoll_ctl listen"); running_ = false; return false; }
+
+        epoll_event wev{};
+        wev.events = EPOLLIN;
+        wev.data.fd = wake_fd_;
+        epoll_ctl(ep, EPOLL_CTL_ADD, wake_fd_, &wev);
+    }
+    for (int i = 0; i < threads_; ++i) workers_.emplace_back(&Reactor::loop, this, i);
+    for (auto& t : workers_) t.join();
+    workers_.clear();
+    return true;
+}
+
+void Reactor::stop() {
+    running_ = false;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        (void)!write(wake_fd_, &one, sizeof(one));
+    }
+}
+
+void Reactor::loop(int idx) {
+    if (on_start_) on_start_(idx);
+    const int ep = epfds_[static_cast<size_t>(idx)];
+    struct Conn {
+        LineReader in;
+        ConnState state;
+    };
+    std::unordered_map<int, Conn> conns;
+    std::vector<epoll_event> events(256);
+
+    auto drop = [&](int fd) {
+        epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr);
+        auto it = conns.find(fd);
+        if (on_close_ && it != conns.end()) on_close_(fd, it->second.state);
+        conns.erase(fd);
+        close(fd);
+    };
+
+    while (running_) {
+        const int n = epoll_wait(ep, events.data(), static_cast<int>(events.size()), -1);
+        if (n < 0) { if (errno == EINTR) continue; perror("epoll_wait"); break; }
+
+        for (int i = 0; i < n; ++i) {
+            const int fd = events[static_cast<size_t>(i)].data.fd;
+            if (fd == wake_fd_) continue;   // left readable so every loop sees it
+
+            if (fd == listen_fd_) {
+                while (true) {
+                    int cfd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (cfd < 0) {
+                        if (errno != EAGAIN && errno != EWOULDBLOCK && running_) perror("accept");
+                        break;
+                    }
+                    epoll_event cev{};
+                    cev.events = EPOLLIN | EPOLLRDHUP;
+                    cev.data.fd = cfd;
+                    if (epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &cev) < 0) { perror("epoll_ctl add"); close(cfd); continue; }
+                    Conn& c = conns[cfd];
+                    if (on_open_) on_open_(cfd, c.state);
+                }
+                continue;
+            }
+
+            Conn& c = conns[fd];
+            bool keep = true;
+            while (keep) {
+                const ssize_t r = c.in.fill(fd, MSG_DONTWAIT);
+                if (r > 0) { keep = on_data_(fd, c.in, c.state); continue; }
+                if (r < 0 && errno == EINTR) continue;
+                if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) keep = false;
+                break;
+            }
+            if (!keep) drop(fd);
+        }
+    }
+
+    for (auto& kv : conns) {
+        if (on_close_) on_close_(kv.first, kv.second.state);
+        close(kv.first);
+    }
+}
+
+#else // !__linux__
+
+bool Reactor::run(std::function<void(int idx)>) {
+    std::cerr << "Reactor: epoll is only available on Linux\n";
+    return false;
+}
+
+void Reactor::stop() { running_ = false; }
+
+void Reactor::loop(int) {}
+
+#endif
@@ -0,0 +1,105 @@
+#include "replay_stream.hpp"
+#include "command_parser.hpp"
+
+#include <fstream>
+
+// Splits on spaces, tabs and commas; drops a lone '@'.
+static size_t tokenize(std::string_view line, std::string_view* tok, size_t max) {
+    size_t n = 0, i = 0;
+    while (i < line.size() && n < max) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == ',' || line[i] == '\r')) ++i;
+        const size_t b = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != ',' && line[i] != '\r') ++i;
+        if (i > b && line.substr(b, i - b) != "@") tok[n++] = line.substr(b, i - b);
+    }
+    return n;
+}
+
+static bool parseInt(std::string_view s, int64_t& out) {
+    if (s.empty() || s.size() > 19) return false;
+    int64_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    out = v;
+    return true;
+}
+
+// Same rules as the exchange: exact ticks or an error, never rounded.
+static bool parsePrice(std::string_view s, int64_t tick_factor, int64_t& ticks) {
+    return parsePriceTicks(s, tick_factor, ticks) == PriceStatus::Ok;
+}
+
+ReplayParse parseReplayLine(std::string_view line, int64_t tick_factor, int64_t& next_id, JournalRecord& out) {
+    std::string_view tok[8];
+    const size_t n = tokenize(line, tok, 8);
+    if (n == 0 || tok[0][0] == '#') return ReplayParse::Skip;
+
+    out = JournalRecord{};
+    size_t i = 1;
+    // Optional symbol, told apart from the side / id by starting with a letter.
+    if (i < n && tok[i] != "BUY" && tok[i] != "SELL" && tok[i][0] >= 'A' && tok[i][0] <= 'Z') {
+        if (!encodeSymbol(tok[i], out.symbol)) return ReplayParse::Error;
+        ++i;
+    }
+
+    int64_t qty = 0;
+    if (tok[0] == "NEW") {
+        if (n - i != 3 || (tok[i] != "BUY" && tok[i] != "SELL")) return ReplayParse::Error;
+        if (!parseInt(tok[i + 1], qty) || qty <= 0 || qty > INT32_MAX) return ReplayParse::Error;
+        if (!parsePrice(tok[i + 2], tick_factor, out.price_ticks)) return ReplayParse::Error;
+        out.op = static_cast<uint8_t>(JournalOp::New);
+        out.side = tok[i] == "BUY" ? 0 : 1;
+        out.order_id = next_id++;
+    } else if (tok[0] == "CXL") {
+        if (n - i != 1 || !parseInt(tok[i], out.order_id) || out.order_id <= 0) return ReplayParse::Error;
+        out.op = static_cast<uint8_t>(JournalOp::Cancel);
+    } else if (tok[0] == "MOD") {
+        if (n - i != 3 || !parseInt(tok[i], out.order_id) || out.order_id <= 0) return ReplayParse::Error;
+        if (!parseInt(tok[i + 1], qty) || qty <= 0 || qty > INT32_MAX) return ReplayParse::Error;
+        if (!parsePrice(tok[i + 2], tick_factor, out.price_ticks)) return ReplayParse::Error;
+        out.op = static_cast<uint8_t>(JournalOp::Modify);
+    } else {
+        return ReplayParse::Error;
+    }
+    out.qty = static_cast<uint32_t>(qty);
+    return ReplayParse::Ok;
+}
+
+static bool isJournal(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(kJournalMagic)] = {};
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, kJournalMagic, sizeof(magic)) == 0;
+}
+
+bool loadReplay(const std::string& path, ReplayFormat format, int64_t tick_factor,
+                std::vector<JournalRecord>& out, std::string& err) {
+    if (format == ReplayFormat::Auto) format = isJournal(path) ? ReplayFormat::Journal : ReplayFormat::Text;
+
+    if (format == ReplayFormat::Journal) {
+        Journal j;
+        if (!j.openReadOnly(path)) { err = path + ": cannot open journal"; return false; }
+        out.reserve(out.size() + j.recovered());
+        for (size_t i = 0; i < j.recovered(); ++i) out.push_back(j.record(i));
+        return true;
+    }
+
+    std::ifstream in(path);
+    if (!in) { err = path + ": cannot open"; return false; }
+    std::string line;
+    int64_t next_id = 1;
+    size_t lineno = 0;
+    JournalRecord r;
+    while (std::getline(in, line)) {
+        ++lineno;
+        switch (parseReplayLine(line, tick_factor, next_id, r)) {
+            case ReplayParse::Ok:   out.push_back(r); break;
+            case ReplayParse::Skip: break;
+            case ReplayParse::Error:
+                err = path + ":" + std::to_string(lineno) + ": bad command: " + line;
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,278 @@
+#include "session.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static constexpr size_t kChunkBytes = 16384;   // replies are appended to a chunk up to this size
+static constexpr size_t kMaxIov = 64;          // chunks per write
+#ifdef MSG_NOSIGNAL
+static constexpr int kSendFlags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+static constexpr int kSendFlags = MSG_DONTWAIT;
+#endif
+
+static uint32_t slotOf(SessionId id) { return static_cast<uint32_t>(id); }
+static uint32_t genOf(SessionId id)  { return static_cast<uint32_t>(id >> 32); }
+
+SessionTable::SessionTable(size_t capacity, size_t max_backlog)
+: capacity_(capacity ? capacity : 1), max_backlog_(max_backlog), slots_(new Slot[capacity_]) {
+    free_.reserve(capacity_);
+    for (size_t i = capacity_; i-- > 0;) free_.push_back(static_cast<uint32_t>(i));
+    if (pipe(wake_) == 0) {
+        for (int fd : wake_) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    } else {
+        perror("pipe");
+    }
+}
+
+SessionTable::~SessionTable() {
+    stop();
+    for (size_t i = 0; i < capacity_; ++i) if (slots_[i].fd >= 0) ::close(slots_[i].fd);
+    for (int fd : wake_) if (fd >= 0) ::close(fd);
+}
+
+void SessionTable::start(std::function<void()> on_start) {
+    thr_ = std::thread([this, on_start = std::move(on_start)] {
+        if (on_start) on_start();
+        run();
+    });
+}
+
+void SessionTable::stop() {
+    if (!thr_.joinable()) return;
+    stop_.store(true, std::memory_order_release);
+    const char b = 1;
+    (void)!write(wake_[1], &b, 1);
+    thr_.join();
+}
+
+SessionId SessionTable::open(int fd) {
+    uint32_t idx;
+    {
+        std::lock_guard<std::mutex> lk(free_m_);
+        if (free_.empty()) return kNoSession;
+        idx = free_.back();
+        free_.pop_back();
+    }
+    const int wfd = dup(fd);
+    if (wfd < 0) {
+        perror("dup");
+        std::lock_guard<std::mutex> lk(free_m_);
+        free_.push_back(idx);
+        return kNoSession;
+    }
+    // Replies are already coalesced per flush; Nagle would only delay them.
+    int nodelay = 1; setsockopt(wfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+    int one = 1; setsockopt(wfd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    Slot& s = slots_[idx];
+    std::lock_guard<std::mutex> lk(s.m);
+    s.fd = wfd;
+    s.open = true;
+    s.stats = SessionStats{};
+    opened_.fetch_add(1, std::memory_order_relaxed);
+    return (static_cast<SessionId>(s.gen) << 32) | idx;
+}
+
+SessionTable::Slot* SessionTable::find(SessionId id, std::unique_lock<std::mutex>& lk) const {
+    const uint32_t idx = slotOf(id);
+    if (id == kNoSession || idx >= capacity_) return nullptr;
+    Slot& s = slots_[idx];
+    lk = std::unique_lock<std::mutex>(s.m);
+    if (s.gen != genOf(id) || !s.open) return nullptr;
+    return &s;
+}
+
+bool SessionTable::send(SessionId id, std::string_view data) {
+    std::unique_lock<std::mutex> lk;
+    Slot* s = find(id, lk);
+    if (!s) return false;
+    if (s->backlog + data.size() > max_backlog_) {
+        // The client is not reading: drop it rather than buffer without bound.
+        // shutdown() wakes its reader, which then closes the session.
+        s->stats.overflowed = true;
+        s->open = false;
+        s->out.clear();
+        s->out_off = 0;
+        s->backlog = 0;
+        shutdown(s->fd, SHUT_RDWR);
+        slow_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ++s->stats.replies;
+    s->stats.bytes += data.size();
+
+    // Nothing queued: write straight through without waiting. Only what the
+    // socket does not take right away is left to the writer thread.
+    if (s->backlog == 0) {
+        const ssize_t w = ::send(s->fd, data.data(), data.size(), kSendFlags);
+        if (w > 0) {
+            ++s->stats.writes;
+            data.remove_prefix(static_cast<size_t>(w));
+        }
+        if (data.empty()) return true;
+    }
+
+    if (!s->out.empty() && s->out.back().size() + data.size() <= kChunkBytes) s->out.back().append(data);
+    else s->out.emplace_back(data);
+    s->backlog += data.size();
+    if (s->backlog > s->stats.peak_backlog) s->stats.peak_backlog = s->backlog;
+    const bool wake = !s->queued;
+    s->queued = true;
+    lk.unlock();
+    if (wake) markReady(slotOf(id));
+    return true;
+}
+
+SessionStats SessionTable::close(SessionId id) {
+    const uint32_t idx = slotOf(id);
+    if (id == kNoSession || idx >= capacity_) return {};
+    Slot& s = slots_[idx];
+    std::unique_lock<std::mutex> lk(s.m);
+    if (s.gen != genOf(id) || s.fd < 0) return {};
+    ++s.gen;   // every outstanding id for this session is now stale
+    if (s.gen == 0) s.gen = 1;
+    s.open = false;
+    s.closed = true;
+    const SessionStats st = s.stats;
+    const bool wake = !s.queued;
+    s.queued = true;
+    lk.unlock();
+    if (wake) markReady(idx);   // the writer flushes what is left and closes
+    return st;
+}
+
+size_t SessionTable::backlog(SessionId id) const {
+    std::unique_lock<std::mutex> lk;
+    const Slot* s = find(id, lk);
+    return s ? s->backlog : 0;
+}
+
+SessionStats SessionTable::totals() const {
+    std::lock_guard<std::mutex> lk(free_m_);
+    return totals_;
+}
+
+void SessionTable::markReady(uint32_t slot) {
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lk(ready_m_);
+        was_empty = ready_.empty();
+        ready_.push_back(slot);
+    }
+    if (was_empty) {
+        const char b = 1;
+        (void)!write(wake_[1], &b, 1);
+    }
+}
+
+void SessionTable::release(uint32_t slot, Slot& s) {
+    ::close(s.fd);
+    s.fd = -1;
+    s.closed = false;
+    s.out.clear();
+    s.out_off = 0;
+    s.backlog = 0;
+    std::lock_guard<std::mutex> lk(free_m_);
+    totals_.replies += s.stats.replies;
+    totals_.bytes += s.stats.bytes;
+    totals_.writes += s.stats.writes;
+    if (s.stats.peak_backlog > totals_.peak_backlog) totals_.peak_backlog = s.stats.peak_backlog;
+    free_.push_back(slot);
+}
+
+bool SessionTable::flush(uint32_t slot) {
+    Slot& s = slots_[slot];
+    std::lock_guard<std::mutex> lk(s.m);
+    s.queued = false;
+    if (s.fd < 0) return false;
+
+    bool blocked = false;
+    while (s.backlog) {
+        iovec iov[kMaxIov];
+        size_t n = 0;
+        for (size_t i = 0; i < s.out.size() && n < kMaxIov; ++i, ++n) {
+            const size_t off = i == 0 ? s.out_off : 0;
+            iov[n].iov_base = const_cast<char*>(s.out[i].data() + off);
+            iov[n].iov_len  = s.out[i].size() - off;
+        }
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        const ssize_t w = sendmsg(s.fd, &msg, kSendFlags);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) { blocked = true; break; }
+            // Peer gone: nothing queued can be delivered.
+            s.out.clear(); s.out_off = 0; s.backlog = 0;
+            break;
+        }
+        ++s.stats.writes;
+        size_t left = static_cast<size_t>(w);
+        s.backlog -= left;
+        size_t done = 0;
+        while (left) {
+            const size_t avail = s.out[done].size() - s.out_off;
+            if (left < avail) { s.out_off += left; break; }
+            left -= avail;
+            s.out_off = 0;
+            ++done;
+        }
+        s.out.erase(s.out.begin(), s.out.begin() + static_cast<std::ptrdiff_t>(done));
+    }
+
+    // A closed session gets one attempt; whatever did not fit is dropped.
+    if (s.closed) { release(slot, s); return false; }
+    return blocked;
+}
+
+void SessionTable::run() {
+    std::vector<uint32_t> ready, blocked, still;
+    std::vector<pollfd> pfds;
+    auto flushOrWait = [&](uint32_t slot, std::vector<uint32_t>& wait) {
+        Slot& s = slots_[slot];
+        if (!flush(slot)) return;
+        if (!s.waiting) { s.waiting = true; wait.push_back(slot); }
+    };
+    while (true) {
+        const bool stopping = stop_.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lk(ready_m_);
+            ready.swap(ready_);
+        }
+        for (uint32_t slot : ready) flushOrWait(slot, blocked);
+        ready.clear();
+        if (stopping) break;
+
+        // Sleep until new replies are queued or a full socket drains.
+        pfds.clear();
+        pfds.push_back(pollfd{wake_[0], POLLIN, 0});
+        for (uint32_t slot : blocked) {
+            std::lock_guard<std::mutex> lk(slots_[slot].m);
+            pfds.push_back(pollfd{slots_[slot].fd, POLLOUT, 0});   // fd -1 is ignored
+        }
+        if (poll(pfds.data(), static_cast<nfds_t>(pfds.size()), -1) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        char buf[256];
+        while (read(wake_[0], buf, sizeof(buf)) > 0) {}
+
+        still.clear();
+        for (size_t i = 1; i < pfds.size(); ++i) {
+            const uint32_t slot = blocked[i - 1];
+            if (!pfds[i].revents) { still.push_back(slot); continue; }
+            slots_[slot].waiting = false;
+            flushOrWait(slot, still);
+        }
+        blocked.swap(still);
+    }
+}
@@ -0,0 +1,60 @@
+#include "stage_stats.hpp"
+
+#include <cstdio>
+#include <ostream>
+
+const char* stageName(Stage s) {
+    switch (s) {
+        case Stage::Parse:      return "parse";
+        case Stage::Queue:      return "queue";
+        case Stage::Batch:      return "batch";
+        case Stage::Match:      return "match";
+        case Stage::MarketData: return "market data";
+        case Stage::Reply:      return "reply";
+        case Stage::Total:      return "total";
+        case Stage::Count:      break;
+    }
+    return "?";
+}
+
+// Clock reads on different threads can be a few ns out of order.
+static uint64_t span(uint64_t from, uint64_t to) { return to > from ? to - from : 0; }
+
+void StageStats::record(const Stamps& t) {
+    interval_[static_cast<size_t>(Stage::Parse)].record(span(t.read, t.enqueue));
+    interval_[static_cast<size_t>(Stage::Queue)].record(span(t.enqueue, t.dequeue));
+    interval_[static_cast<size_t>(Stage::Batch)].record(span(t.dequeue, t.start));
+    interval_[static_cast<size_t>(Stage::Match)].record(span(t.start, t.matched));
+    interval_[static_cast<size_t>(Stage::MarketData)].record(span(t.matched, t.md));
+    interval_[static_cast<size_t>(Stage::Reply)].record(span(t.md, t.replied));
+    interval_[static_cast<size_t>(Stage::Total)].record(span(t.read, t.replied));
+}
+
+bool StageStats::rollInterval() {
+    if (!interval_[static_cast<size_t>(Stage::Total)].count()) return false;
+    for (size_t i = 0; i < kStageCount; ++i) {
+        total_[i].merge(interval_[i]);
+        interval_[i].reset();
+    }
+    return true;
+}
+
+void StageStats::merge(const StageStats& o) {
+    for (size_t i = 0; i < kStageCount; ++i) total_[i].merge(o.total_[i]);
+}
+
+void StageStats::write(std::ostream& out, const LatencyHistogram (&h)[kStageCount]) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-12s %10s %9s %9s %9s %9s %9s %9s\n", "stage (us)",
+                  "count", "p50", "p90", "p99", "p99.9", "max", "mean");
+    out << line;
+    for (size_t i = 0; i < kStageCount; ++i) {
+        const LatencyHistogram& s = h[i];
+        std::snprintf(line, sizeof(line), "  %-12s %10llu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                      stageName(static_cast<Stage>(i)), static_cast<unsigned long long>(s.count()),
+                      static_cast<double>(s.percentile(50)) / 1000.0, static_cast<double>(s.percentile(90)) / 1000.0,
+                      static_cast<double>(s.percentile(99)) / 1000.0, static_cast<double>(s.percentile(99.9)) / 1000.0,
+                      static_cast<double>(s.max()) / 1000.0, s.mean() / 1000.0);
+        out << line;
+    }
+}
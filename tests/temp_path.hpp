@@ -0,0 +1,22 @@
+#pragma once
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+// Empty temporary file, removed when the test that made it ends.
+struct TempPath {
+    std::string path;
+    TempPath() {
+        char tmpl[] = "/tmp/trading_test_XXXXXX";
+        const int fd = mkstemp(tmpl);
+        EXPECT_GE(fd, 0);
+        close(fd);
+        path = tmpl;
+    }
+    ~TempPath() { unlink(path.c_str()); }
+
+    TempPath(const TempPath&) = delete;
+    TempPath& operator=(const TempPath&) = delete;
+};
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "binary_protocol.hpp"
+
+#include <string>
+
+TEST(BinaryProtocol, NewRoundTripsThroughFraming) {
+    BinNew m;
+    binInit(m, BinType::New);
+    m.client_id = 42; m.side = 1; m.qty = 300; m.price_ticks = 5025;
+
+    std::string wire;
+    binAppend(wire, m);
+    EXPECT_EQ(wire.size(), sizeof(BinNew));
+
+    // Incomplete prefixes ask for more bytes.
+    EXPECT_EQ(binFrameLength(std::string_view(wire).substr(0, 1)), 0u);
+    EXPECT_EQ(binFrameLength(std::string_view(wire).substr(0, 10)), 0u);
+
+    wire += "xyz";  // start of the next message
+    ASSERT_EQ(binFrameLength(wire), sizeof(BinNew));
+    const std::string_view frame = std::string_view(wire).substr(0, sizeof(BinNew));
+    EXPECT_EQ(binType(frame), BinType::New);
+
+    BinNew d;
+    ASSERT_TRUE(binDecode(frame, d));
+    EXPECT_EQ(d.client_id, 42u);
+    EXPECT_EQ(d.side, 1);
+    EXPECT_EQ(d.qty, 300u);
+    EXPECT_EQ(d.price_ticks, 5025);
+
+    BinCancel wrong;
+    EXPECT_FALSE(binDecode(frame, wrong));
+}
+
+TEST(BinaryProtocol, RejectsImpossibleLengths) {
+    std::string wire("\x01\x00\x01", 3);   // length 1 < header
+    EXPECT_EQ(binFrameLength(wire), kBinBadFrame);
+    wire.assign("\xff\xff\x01", 3);         // length 65535 > kBinMaxFrame
+    EXPECT_EQ(binFrameLength(wire), kBinBadFrame);
+}
+
+TEST(BinaryProtocol, EncodesBookEventsWithClientId) {
+    std::string out;
+    BookEvent trade{BookEventType::Trade, Side::Buy, 50, 5030, 7, 0, RejectReason::InvalidOrder};
+    ASSERT_TRUE(binAppendEvent(out, trade, 9, 123));
+    BookEvent best{BookEventType::BestAsk, Side::Sell, 150, 5030, 0, 0, RejectReason::InvalidOrder};
+    EXPECT_FALSE(binAppendEvent(out, best, 9, 123));
+    BookEvent rej{BookEventType::Reject, Side::Buy, 0, 0, 999, 0, RejectReason::UnknownOrderId};
+    ASSERT_TRUE(binAppendEvent(out, rej, 9, 124));
+
+    std::string_view rest(out);
+    ASSERT_EQ(binFrameLength(rest), sizeof(BinTrade));
+    BinTrade t;
+    ASSERT_TRUE(binDecode(rest.substr(0, sizeof(BinTrade)), t));
+    EXPECT_EQ(t.r.client_id, 9u);
+    EXPECT_EQ(t.r.server_ts_ns, 123u);
+    EXPECT_EQ(t.resting_id, 7);
+    EXPECT_EQ(t.side, 0);
+    EXPECT_EQ(t.qty, 50u);
+    EXPECT_EQ(t.price_ticks, 5030);
+
+    rest.remove_prefix(sizeof(BinTrade));
+    ASSERT_EQ(binFrameLength(rest), sizeof(BinRejectMsg));
+    BinRejectMsg r;
+    ASSERT_TRUE(binDecode(rest, r));
+    EXPECT_EQ(r.order_id, 999);
+    EXPECT_EQ(r.reason, static_cast<uint8_t>(BinReject::UnknownOrderId));
+}
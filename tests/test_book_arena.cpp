@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+#include "order_book.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Every global allocation in this binary goes through here.
+static std::atomic<long long> g_allocs{0};
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, std::align_val_t al) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t a = static_cast<std::size_t>(al);
+    if (void* p = std::aligned_alloc(a, (n + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+// Deterministic mix of resting orders, crosses, cancels and replaces over a
+// price range wider than the dense window, so map levels come and go too.
+// Each order id is cancelled once it is 'kLive' ids old, which caps the
+// book at kLive resting orders: a steady state. Returns the number of
+// global allocations made while it ran.
+constexpr int64_t kLive = 2000;
+
+long long runFlow(OrderBook& ob, int64_t& id, int ops, uint64_t seed) {
+    BookEvents ev;
+    ev.reserve(1024);
+    uint64_t x = seed;
+    auto rnd = [&](uint64_t n) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (x >> 33) % n;
+    };
+    const long long a0 = g_allocs.load();
+    for (int i = 0; i < ops; ++i) {
+        ev.clear();
+        if (id > kLive) ob.cancel(id - kLive, ev);
+        const int64_t px = 10000 + static_cast<int64_t>(rnd(400)) - 200;
+        const Side side = rnd(2) ? Side::Buy : Side::Sell;
+        const int64_t away = side == Side::Buy ? -250 : 250;   // passive, off the touch
+        switch (rnd(6)) {
+            case 0: case 1: case 2:
+                ob.processOrder(side, 1 + static_cast<int>(rnd(50)), px + away, id, ev);
+                break;
+            case 3:
+                ob.processOrder(side, 1 + static_cast<int>(rnd(200)), px, id, ev);
+                break;
+            case 4:
+                ob.cancel(id - 1 - static_cast<int64_t>(rnd(64)), ev);
+                break;
+            default:
+                ob.replace(id - 1 - static_cast<int64_t>(rnd(64)), 1 + static_cast<int>(rnd(50)),
+                           px + away, id, ev);
+                break;
+        }
+        ++id;
+    }
+    return g_allocs.load() - a0;
+}
+
+BookConfig config(LadderKind ladder, BookAlloc alloc) {
+    BookConfig cfg;
+    cfg.ladder = ladder;
+    cfg.dense_span = 256;
+    cfg.pool_capacity = 4096;
+    cfg.alloc = alloc;
+    return cfg;
+}
+
+} // namespace
+
+TEST(BookArena, SteadyStateMakesNoGlobalAllocations) {
+    for (LadderKind ladder : {LadderKind::Map, LadderKind::Dense}) {
+        OrderBook ob(config(ladder, BookAlloc::Arena));
+        int64_t id = 1;
+        runFlow(ob, id, 20000, 1);   // warm-up: pools reach their working size
+        ASSERT_GT(ob.restingOrders(), 100u);
+        EXPECT_EQ(runFlow(ob, id, 50000, 2), 0) << "ladder " << static_cast<int>(ladder);
+        EXPECT_EQ(ob.memory().overflowBytes(), 0u);
+    }
+}
+
+TEST(BookArena, HeapBookAllocatesPerOrder) {
+    OrderBook ob(config(LadderKind::Map, BookAlloc::Heap));
+    int64_t id = 1;
+    runFlow(ob, id, 20000, 1);
+    EXPECT_GT(runFlow(ob, id, 50000, 2), 1000);
+}
+
+TEST(BookArena, OutgrowsTheReserveWithoutLosingOrders) {
+    BookConfig cfg = config(LadderKind::Map, BookAlloc::Arena);
+    cfg.pool_capacity = 16;
+    cfg.arena_bytes = 4096;
+    OrderBook ob(cfg);
+    BookEvents ev;
+    for (int i = 0; i < 5000; ++i) ob.seed(Side::Sell, 1, 20000 + i, i + 1, ev);
+    EXPECT_EQ(ob.restingOrders(), 5000u);
+    EXPECT_EQ(ob.depthLevels(Side::Sell), 5000u);
+    EXPECT_GT(ob.memory().overflowBytes(), 0u);
+
+    ev.clear();
+    ob.processOrder(Side::Buy, 5000, 30000, 9000, ev);
+    EXPECT_EQ(ob.restingOrders(), 0u);
+    EXPECT_FALSE(ob.hasBestAsk());
+}
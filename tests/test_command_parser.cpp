@@ -0,0 +1,230 @@
+#include "gtest/gtest.h"
+#include "command_parser.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+// The exchange's parser before command_parser: istringstream tokens and
+// double prices rounded to ticks. False where it replied with an ERROR.
+bool legacyParse(const std::string& line, int64_t tick_factor, Command& c) {
+    c = Command{};
+    if (line == "QUIT") { c.type = CmdType::Quit; return true; }
+    std::istringstream iss{line};
+    std::string cmd; iss >> cmd;
+    std::string tok; iss >> tok;
+    if ((cmd == "NEW" || cmd == "CXL" || cmd == "MOD") && !tok.empty() &&
+        tok != "BUY" && tok != "SELL" && tok[0] >= 'A' && tok[0] <= 'Z') {
+        if (!encodeSymbol(tok, c.symbol)) return false;
+        tok.clear();
+        iss >> tok;
+    }
+    if (cmd == "NEW") {
+        int qty = 0; char at = 0; double price = 0.0;
+        iss >> qty >> at >> price;
+        if ((tok != "BUY" && tok != "SELL") || at != '@' || qty <= 0 || price <= 0.0) return false;
+        c.type = CmdType::New;
+        c.side = tok == "BUY" ? Side::Buy : Side::Sell;
+        c.qty = qty;
+        c.price_ticks = static_cast<int64_t>(std::llround(price * static_cast<double>(tick_factor)));
+        return true;
+    }
+    if (cmd == "CXL" || cmd == "MOD") {
+        char* end = nullptr;
+        int64_t id = std::strtoll(tok.c_str(), &end, 10);
+        if (tok.empty() || *end) id = 0;
+        c.order_id = id;
+        if (cmd == "CXL") { c.type = CmdType::Cancel; return id > 0; }
+        int qty = 0; char at = 0; double px = 0.0;
+        iss >> qty >> at >> px;
+        if (id <= 0 || qty <= 0 || at != '@' || px <= 0.0) return false;
+        c.type = CmdType::Modify;
+        c.qty = qty;
+        c.price_ticks = static_cast<int64_t>(std::llround(px * static_cast<double>(tick_factor)));
+        return true;
+    }
+    return false;
+}
+
+std::string errorFor(const std::string& line, int64_t tick_factor = 100) {
+    Command c;
+    std::string_view bad;
+    const CmdStatus st = parseCommand(line, tick_factor, c, bad);
+    std::string out;
+    appendCommandError(st, bad, tick_factor, out);
+    return out;
+}
+
+bool same(const Command& a, const Command& b) {
+    return a.type == b.type && a.symbol == b.symbol && a.qty == b.qty &&
+           a.price_ticks == b.price_ticks && a.order_id == b.order_id &&
+           (a.type != CmdType::New || a.side == b.side);
+}
+
+// A well-formed command with random spacing, symbol and values.
+std::string randomCommand(std::mt19937_64& rng) {
+    auto pick = [&](int n) { return static_cast<int>(rng() % static_cast<uint64_t>(n)); };
+    auto gap = [&]() { static const char* g[] = {" ", "  ", "\t", " \t "}; return std::string(g[pick(4)]); };
+    auto price = [&]() {
+        std::string p = std::to_string(1 + pick(99999));
+        switch (pick(4)) {
+            case 0: break;
+            case 1: p += "." + std::to_string(pick(10)); break;
+            case 2: { const int c = pick(100); p += (c < 10 ? ".0" : ".") + std::to_string(c); break; }
+            case 3: { const int c = pick(100); p += (c < 10 ? ".0" : ".") + std::to_string(c) + "0"; break; }
+        }
+        return p;
+    };
+    auto at = [&]() { static const char* a[] = {" @ ", "@", " @", "@ ", "\t@\t"}; return std::string(a[pick(5)]); };
+    std::string sym;
+    if (pick(2)) {
+        static const char first[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        static const char rest[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.";
+        sym += first[pick(26)];
+        for (int n = pick(8); n > 0; --n) sym += rest[pick(37)];
+        if (sym == "BUY" || sym == "SELL") sym.clear();
+        if (!sym.empty()) sym = gap() + sym;
+    }
+    std::string line = pick(3) ? "" : gap();
+    switch (pick(3)) {
+        case 0: line += "NEW" + sym + gap() + (pick(2) ? "BUY" : "SELL") + gap() +
+                        std::to_string(1 + pick(1000000)) + at() + price(); break;
+        case 1: line += "CXL" + sym + gap() + std::to_string(1 + pick(INT32_MAX)); break;
+        case 2: line += "MOD" + sym + gap() + std::to_string(1 + pick(INT32_MAX)) + gap() +
+                        std::to_string(1 + pick(1000000)) + at() + price(); break;
+    }
+    if (!pick(4)) line += gap();
+    return line;
+}
+}
+
+TEST(CommandParser, ParsesEachCommand) {
+    Command c;
+    std::string_view bad;
+    ASSERT_EQ(parseCommand("NEW BUY 100 @ 50.25", 100, c, bad), CmdStatus::Ok);
+    EXPECT_EQ(c.type, CmdType::New);
+    EXPECT_EQ(c.side, Side::Buy);
+    EXPECT_EQ(c.qty, 100);
+    EXPECT_EQ(c.price_ticks, 5025);
+    EXPECT_EQ(c.symbol, kDefaultSymbol);
+
+    ASSERT_EQ(parseCommand("NEW AAPL SELL 7@50.3", 100, c, bad), CmdStatus::Ok);
+    SymbolId aapl;
+    ASSERT_TRUE(encodeSymbol("AAPL", aapl));
+    EXPECT_EQ(c.symbol, aapl);
+    EXPECT_EQ(c.side, Side::Sell);
+    EXPECT_EQ(c.price_ticks, 5030);
+
+    ASSERT_EQ(parseCommand("CXL 123456", 100, c, bad), CmdStatus::Ok);
+    EXPECT_EQ(c.type, CmdType::Cancel);
+    EXPECT_EQ(c.order_id, 123456);
+
+    ASSERT_EQ(parseCommand("\tMOD AAPL 9 50 @ .5\r", 100, c, bad), CmdStatus::Ok);
+    EXPECT_EQ(c.type, CmdType::Modify);
+    EXPECT_EQ(c.order_id, 9);
+    EXPECT_EQ(c.qty, 50);
+    EXPECT_EQ(c.price_ticks, 50);
+
+    ASSERT_EQ(parseCommand("QUIT", 100, c, bad), CmdStatus::Ok);
+    EXPECT_EQ(c.type, CmdType::Quit);
+}
+
+TEST(CommandParser, PricesAreExactTicks) {
+    int64_t t = 0;
+    EXPECT_EQ(parsePriceTicks("50", 100, t), PriceStatus::Ok);     EXPECT_EQ(t, 5000);
+    EXPECT_EQ(parsePriceTicks("50.", 100, t), PriceStatus::Ok);    EXPECT_EQ(t, 5000);
+    EXPECT_EQ(parsePriceTicks("0.01", 100, t), PriceStatus::Ok);   EXPECT_EQ(t, 1);
+    EXPECT_EQ(parsePriceTicks("50.250000", 100, t), PriceStatus::Ok); EXPECT_EQ(t, 5025);
+    EXPECT_EQ(parsePriceTicks("1.25", 4, t), PriceStatus::Ok);     EXPECT_EQ(t, 5);
+    EXPECT_EQ(parsePriceTicks("7", 1, t), PriceStatus::Ok);        EXPECT_EQ(t, 7);
+
+    EXPECT_EQ(parsePriceTicks("50.255", 100, t), PriceStatus::TooFine);
+    EXPECT_EQ(parsePriceTicks("1.3", 4, t), PriceStatus::TooFine);
+    EXPECT_EQ(parsePriceTicks("0.0000000000000000001", 100, t), PriceStatus::TooFine);
+    EXPECT_EQ(parsePriceTicks("92233720368547758.08", 100, t), PriceStatus::OutOfRange);
+    EXPECT_EQ(parsePriceTicks("99999999999999999999", 100, t), PriceStatus::OutOfRange);
+    for (const char* bad : {"", ".", "0", "0.00", "-1", "+1", "1e2", "1.2.3", "50,25", "0x10", " 1"})
+        EXPECT_EQ(parsePriceTicks(bad, 100, t), PriceStatus::Bad) << bad;
+
+    // A double cannot hold this; the old llround(price * 100) was off by one.
+    Command c;
+    std::string_view bad;
+    ASSERT_EQ(parseCommand("NEW BUY 1 @ 90071992547409.93", 100, c, bad), CmdStatus::Ok);
+    EXPECT_EQ(c.price_ticks, 9007199254740993);
+    Command old;
+    ASSERT_TRUE(legacyParse("NEW BUY 1 @ 90071992547409.93", 100, old));
+    EXPECT_NE(old.price_ticks, 9007199254740993);
+}
+
+TEST(CommandParser, PreciseErrors) {
+    EXPECT_EQ(errorFor("NEW BUY 10 @ 50.255"), "ERROR Invalid price 50.255: finer than the tick size 0.01");
+    EXPECT_EQ(errorFor("NEW BUY 10 @ 1.3", 4), "ERROR Invalid price 1.3: finer than the tick size 1/4");
+    EXPECT_EQ(errorFor("MOD 4 10 @ 99999999999999999999"), "ERROR Invalid price 99999999999999999999: out of range");
+    EXPECT_EQ(errorFor("NEW BUY 10 @ 0.00"), "ERROR Invalid price 0.00: expected a positive decimal");
+    EXPECT_EQ(errorFor("NEW BUY 10 @ 1e2"), "ERROR Invalid price 1e2: expected a positive decimal");
+    EXPECT_EQ(errorFor("NEW BUY 0 @ 1"), "ERROR Invalid quantity 0: expected a whole number from 1 to 2147483647");
+    EXPECT_EQ(errorFor("NEW SELL 2147483648 @ 1"),
+              "ERROR Invalid quantity 2147483648: expected a whole number from 1 to 2147483647");
+    EXPECT_EQ(errorFor("CXL 12abc"), "ERROR Invalid order id 12abc: expected a positive whole number");
+    EXPECT_EQ(errorFor("NEW BUY 10 @ 1 now"), "ERROR Unexpected now at end of command");
+    EXPECT_EQ(errorFor("NEW lower BUY 1 @ 1"), "ERROR Invalid NEW. Expected: NEW [SYMBOL] BUY|SELL <qty> @ <price>");
+    EXPECT_EQ(errorFor("NEW TOOLONGSYM BUY 1 @ 1"), "ERROR Invalid symbol TOOLONGSYM");
+    EXPECT_EQ(errorFor("NEW BUY 10 50.25"), "ERROR Invalid NEW. Expected: NEW [SYMBOL] BUY|SELL <qty> @ <price>");
+    EXPECT_EQ(errorFor("CXL"), "ERROR Invalid CXL. Expected: CXL [SYMBOL] <order_id>");
+    EXPECT_EQ(errorFor("MOD 5 10 @"), "ERROR Invalid MOD. Expected: MOD [SYMBOL] <order_id> <new_qty> @ <new_price>");
+    EXPECT_EQ(errorFor("PING"), "ERROR Unknown command. Use NEW/CXL/MOD/QUIT.");
+    EXPECT_EQ(errorFor("QUIT now"), "ERROR Unexpected now at end of command");
+}
+
+// Every well-formed command parses exactly as it did before.
+TEST(CommandParser, RandomValidCommandsMatchLegacy) {
+    std::mt19937_64 rng(2024);
+    for (int i = 0; i < 50000; ++i) {
+        const std::string line = randomCommand(rng);
+        Command got, want;
+        std::string_view bad;
+        ASSERT_EQ(parseCommand(line, 100, got, bad), CmdStatus::Ok) << "'" << line << "' bad=" << bad;
+        ASSERT_TRUE(legacyParse(line, 100, want)) << line;
+        ASSERT_TRUE(same(got, want)) << line;
+    }
+}
+
+// Corrupted commands: whatever the new parser accepts, the old one accepted
+// with the same meaning. (The new one is stricter: trailing input, signs,
+// exponents and prices finer than the tick are now errors.)
+TEST(CommandParser, RandomCorruptionsNeverAcceptMore) {
+    std::mt19937_64 rng(7);
+    static const char noise[] = "0123456789.@ \t+-eEBUYSELNWCXMODa,";
+    int accepted = 0, rejected = 0;
+    for (int i = 0; i < 100000; ++i) {
+        std::string line = randomCommand(rng);
+        for (int e = 1 + static_cast<int>(rng() % 3); e > 0 && !line.empty(); --e) {
+            const size_t at = rng() % line.size();
+            switch (rng() % 3) {
+                case 0: line.insert(at, 1, noise[rng() % (sizeof(noise) - 1)]); break;
+                case 1: line.erase(at, 1); break;
+                case 2: line[at] = noise[rng() % (sizeof(noise) - 1)]; break;
+            }
+        }
+        Command got, want;
+        std::string_view bad;
+        const CmdStatus st = parseCommand(line, 100, got, bad);
+        if (st != CmdStatus::Ok) {
+            ++rejected;
+            std::string err;
+            appendCommandError(st, bad, 100, err);
+            ASSERT_EQ(err.compare(0, 6, "ERROR "), 0);
+            ASSERT_TRUE(bad.empty() || (bad.data() >= line.data() && bad.data() + bad.size() <= line.data() + line.size()));
+            continue;
+        }
+        ++accepted;
+        if (got.type == CmdType::Quit || got.price_ticks > (int64_t{1} << 50)) continue;
+        ASSERT_TRUE(legacyParse(line, 100, want)) << "'" << line << "'";
+        ASSERT_TRUE(same(got, want)) << "'" << line << "'";
+    }
+    EXPECT_GT(accepted, 1000);
+    EXPECT_GT(rejected, 1000);
+}
@@ -0,0 +1,67 @@
+#include "gtest/gtest.h"
+#include "cpu_affinity.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+TEST(CpuAffinity, ParsesCpuLists) {
+    std::vector<int> c;
+    ASSERT_TRUE(parseCpuList("3", c));
+    EXPECT_EQ(c, std::vector<int>({3}));
+    ASSERT_TRUE(parseCpuList("2,0", c));
+    EXPECT_EQ(c, std::vector<int>({2, 0}));
+    ASSERT_TRUE(parseCpuList("0-3,6", c));
+    EXPECT_EQ(c, std::vector<int>({0, 1, 2, 3, 6}));
+    EXPECT_EQ(formatCpuList(c), "0,1,2,3,6");
+
+    for (const char* bad : {"", ",", "1,", "a", "-1", "3-1", "1-", "1-2-3", "1 ,2", "5000"})
+        EXPECT_FALSE(parseCpuList(bad, c)) << bad;
+}
+
+#if defined(__linux__)
+TEST(CpuAffinity, PinsTheCallingThread) {
+    const std::vector<int> allowed = allowedCpus();
+    ASSERT_FALSE(allowed.empty());
+    const int cpu = allowed.back();
+    std::string err = "unset";
+    int ran_on = -1, set_count = 0;
+    char name[16] = {};
+    std::thread([&] {
+        ThreadPlacement p;
+        p.cpu = cpu;
+        err = placeThisThread("pinned-thread-long-name", p);
+        ran_on = sched_getcpu();
+        set_count = static_cast<int>(allowedCpus().size());
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+    }).join();
+    EXPECT_EQ(err, "");
+    EXPECT_EQ(ran_on, cpu);
+    EXPECT_EQ(set_count, 1);
+    EXPECT_STREQ(name, "pinned-thread-l");   // truncated to 15 chars
+}
+
+TEST(CpuAffinity, ReportsWhatDidNotApply) {
+    std::string pin_err, fifo_err;
+    int policy = -1;
+    std::thread([&] {
+        ThreadPlacement p;
+        p.cpu = 4095;   // beyond any machine this runs on
+        pin_err = placeThisThread(nullptr, p);
+        p.cpu = -1;
+        p.fifo_priority = 1;
+        fifo_err = placeThisThread(nullptr, p);
+        sched_param sp{};
+        pthread_getschedparam(pthread_self(), &policy, &sp);
+    }).join();
+    EXPECT_NE(pin_err.find("not pinned"), std::string::npos) << pin_err;
+    // SCHED_FIFO needs privileges: either it took effect or it says why not.
+    if (fifo_err.empty()) EXPECT_EQ(policy, SCHED_FIFO);
+    else EXPECT_NE(fifo_err.find("running SCHED_OTHER"), std::string::npos) << fifo_err;
+}
+#endif
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include "depth_feed.hpp"
+
+#include <vector>
+
+namespace {
+MdType type(const MdLevelMsg& r) { return static_cast<MdType>(r.type); }
+}
+
+TEST(DepthTracker, PublishesOnlyChangedLevels) {
+    OrderBook book;
+    BookEvents ev;
+    DepthTracker depth(2);
+    std::vector<MdLevelMsg> out;
+
+    book.processOrder(Side::Buy, 10, 100, 1, ev);
+    ASSERT_EQ(depth.update(book, kDefaultSymbol, 1, out), 1u);
+    EXPECT_EQ(type(out[0]), MdType::LevelNew);
+    EXPECT_EQ(out[0].side, 0);
+    EXPECT_EQ(out[0].price_ticks, 100);
+    EXPECT_EQ(out[0].qty, 10);
+    EXPECT_EQ(out[0].count, 1u);
+
+    // Same price: one Update with the new totals; the ask side is untouched.
+    out.clear();
+    book.processOrder(Side::Buy, 5, 100, 2, ev);
+    ASSERT_EQ(depth.update(book, kDefaultSymbol, 2, out), 1u);
+    EXPECT_EQ(type(out[0]), MdType::LevelUpdate);
+    EXPECT_EQ(out[0].qty, 15);
+    EXPECT_EQ(out[0].count, 2u);
+
+    // Nothing changed: nothing published.
+    out.clear();
+    EXPECT_EQ(depth.update(book, kDefaultSymbol, 3, out), 0u);
+
+    // A trade that empties the level deletes it.
+    book.processOrder(Side::Sell, 15, 100, 3, ev);
+    ASSERT_EQ(depth.update(book, kDefaultSymbol, 4, out), 1u);
+    EXPECT_EQ(type(out[0]), MdType::LevelDelete);
+    EXPECT_EQ(out[0].price_ticks, 100);
+    EXPECT_EQ(out[0].qty, 0);
+    EXPECT_TRUE(depth.levels(Side::Buy).empty());
+}
+
+TEST(DepthTracker, LevelsLeavingTopNAreDeleted) {
+    OrderBook book;
+    BookEvents ev;
+    DepthTracker depth(2);
+    std::vector<MdLevelMsg> out;
+
+    book.processOrder(Side::Sell, 1, 105, 1, ev);
+    book.processOrder(Side::Sell, 1, 106, 2, ev);
+    book.processOrder(Side::Sell, 1, 107, 3, ev);   // third level: not published
+    ASSERT_EQ(depth.update(book, kDefaultSymbol, 1, out), 2u);
+
+    // A better ask pushes 106 out of the top two.
+    out.clear();
+    book.processOrder(Side::Sell, 1, 104, 4, ev);
+    ASSERT_EQ(depth.update(book, kDefaultSymbol, 2, out), 2u);
+    EXPECT_EQ(type(out[0]), MdType::LevelNew);
+    EXPECT_EQ(out[0].price_ticks, 104);
+    EXPECT_EQ(out[0].side, 1);
+    EXPECT_EQ(type(out[1]), MdType::LevelDelete);
+    EXPECT_EQ(out[1].price_ticks, 106);
+
+    // Cancelling the new touch brings 106 back.
+    out.clear();
+    book.cancel(4, ev);
+    ASSERT_EQ(depth.update(book, kDefaultSymbol, 3, out), 2u);
+    EXPECT_EQ(type(out[0]), MdType::LevelNew);
+    EXPECT_EQ(out[0].price_ticks, 106);
+    EXPECT_EQ(type(out[1]), MdType::LevelDelete);
+    EXPECT_EQ(out[1].price_ticks, 104);
+}
+
+TEST(DepthCache, SnapshotCarriesSequenceAndLevels) {
+    DepthCache cache;
+    SymbolId aapl = 0, msft = 0;
+    ASSERT_TRUE(encodeSymbol("AAPL", aapl));
+    ASSERT_TRUE(encodeSymbol("MSFT", msft));
+    cache.store(aapl, 1, 42, 5, {LevelInfo{100, 10, 1}, LevelInfo{99, 5, 2}}, {LevelInfo{101, 7, 1}});
+    cache.store(msft, 0, 7, 5, {}, {});
+
+    std::vector<MdLevelMsg> out;
+    ASSERT_EQ(cache.snapshot(false, aapl, 9, out), 1u);
+    ASSERT_EQ(out.size(), 5u);
+    EXPECT_EQ(type(out[0]), MdType::SnapshotBegin);
+    EXPECT_EQ(out[0].channel, 1);
+    EXPECT_EQ(out[0].ref_seq, 42u);
+    EXPECT_EQ(out[0].count, 3u);
+    EXPECT_EQ(out[0].qty, 5);   // depth N: a top-N snapshot, not the whole book
+    EXPECT_EQ(type(out[1]), MdType::SnapshotLevel);
+    EXPECT_EQ(out[1].side, 0);
+    EXPECT_EQ(out[2].price_ticks, 99);
+    EXPECT_EQ(out[3].side, 1);
+    EXPECT_EQ(out[3].qty, 7);
+    EXPECT_EQ(type(out[4]), MdType::SnapshotEnd);
+
+    out.clear();
+    EXPECT_EQ(cache.snapshot(false, kDefaultSymbol, 9, out), 0u);
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(cache.snapshot(true, kDefaultSymbol, 9, out), 2u);
+    EXPECT_EQ(out.size(), 7u);
+}
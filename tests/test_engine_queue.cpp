@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+#include "engine_queue.hpp"
+
+#include <thread>
+#include <vector>
+
+// Every producer's messages arrive exactly once and in that producer's order.
+static void check_mpsc_delivery(QueueKind kind, WaitPolicy wait) {
+    OrderQueue q(64, kind, wait);
+    const int producers = 8, per = 5000;
+
+    std::vector<int64_t> next(producers, 0);
+    int received = 0;
+    bool in_order = true;
+    std::thread consumer([&] {
+        OrderMsg batch[16];
+        while (received < producers * per) {
+            const size_t n = q.popBatch(batch, 16);
+            if (n == 0) break;
+            for (size_t i = 0; i < n; ++i) {
+                auto& expect = next[static_cast<size_t>(batch[i].session)];
+                if (batch[i].order_id != expect) in_order = false;
+                expect = batch[i].order_id + 1;
+                ++received;
+            }
+        }
+    });
+
+    std::vector<std::thread> ps;
+    for (int p = 0; p < producers; ++p) {
+        ps.emplace_back([&q, p, per] {
+            OrderMsg m;
+            m.session = static_cast<SessionId>(p);
+            for (int i = 0; i < per; ++i) { m.order_id = i; ASSERT_TRUE(q.push(m)); }
+        });
+    }
+    for (auto& t : ps) t.join();
+    consumer.join();
+
+    EXPECT_EQ(received, producers * per);
+    EXPECT_TRUE(in_order);
+}
+
+TEST(OrderQueue, MutexDeliversAllInProducerOrder)    { check_mpsc_delivery(QueueKind::Mutex, WaitPolicy::Block); }
+TEST(OrderQueue, MpscBlockDeliversAllInProducerOrder) { check_mpsc_delivery(QueueKind::Mpsc, WaitPolicy::Block); }
+TEST(OrderQueue, MpscSpinDeliversAllInProducerOrder)  { check_mpsc_delivery(QueueKind::Mpsc, WaitPolicy::Spin); }
+TEST(OrderQueue, MpscYieldDeliversAllInProducerOrder) { check_mpsc_delivery(QueueKind::Mpsc, WaitPolicy::SpinYield); }
+
+TEST(OrderQueue, StopDrainsThenReportsEmpty) {
+    for (QueueKind kind : {QueueKind::Mutex, QueueKind::Mpsc}) {
+        OrderQueue q(8, kind, WaitPolicy::Block);
+        OrderMsg m;
+        for (int i = 1; i <= 3; ++i) { m.order_id = i; ASSERT_TRUE(q.push(m)); }
+        q.stop();
+        EXPECT_FALSE(q.push(m));
+
+        OrderMsg out[8];
+        EXPECT_EQ(q.popBatch(out, 8), 3u);
+        EXPECT_EQ(out[2].order_id, 3);
+        EXPECT_FALSE(q.pop().has_value());
+    }
+}
@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+#include "journal.hpp"
+#include "temp_path.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+JournalRecord order(JournalOp op, Side side, int qty, int64_t price, int64_t id) {
+    JournalRecord r{};
+    r.op = static_cast<uint8_t>(op);
+    r.side = side == Side::Buy ? 0 : 1;
+    r.qty = static_cast<uint32_t>(qty);
+    r.price_ticks = price;
+    r.order_id = id;
+    return r;
+}
+
+// Sets one byte of record 'index' in the file, as a crash might leave it.
+void overwrite(const std::string& path, size_t index, size_t byte, int value) {
+    FILE* f = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(f, nullptr);
+    std::fseek(f, static_cast<long>(kJournalHeaderBytes + index * sizeof(JournalRecord) + byte), SEEK_SET);
+    std::fputc(value, f);
+    std::fclose(f);
+}
+
+std::vector<LevelInfo> levels(const OrderBook& b, Side s) {
+    std::vector<LevelInfo> out;
+    b.depth(s, 100, out);
+    return out;
+}
+}
+
+TEST(Journal, ReopenRecoversRecordsAndAppendsAfterThem) {
+    TempPath tmp;
+    {
+        Journal j;
+        ASSERT_TRUE(j.open(tmp.path, 16, JournalSync::Batch));
+        EXPECT_EQ(j.recovered(), 0u);
+        EXPECT_EQ(j.append(order(JournalOp::New, Side::Buy, 10, 100, 1)), 1u);
+        EXPECT_EQ(j.append(order(JournalOp::New, Side::Sell, 5, 101, 2)), 2u);
+        j.commit(1, 2);
+        EXPECT_EQ(j.syncs(), 1u);
+    }
+    Journal j;
+    ASSERT_TRUE(j.open(tmp.path, 1000, JournalSync::None));
+    EXPECT_EQ(j.capacity(), 16u);   // an existing file keeps its size
+    ASSERT_EQ(j.recovered(), 2u);
+    EXPECT_EQ(j.record(1).order_id, 2);
+    EXPECT_EQ(j.record(1).price_ticks, 101);
+    EXPECT_EQ(j.append(order(JournalOp::Cancel, Side::Buy, 0, 0, 1)), 3u);
+}
+
+TEST(Journal, ReplayDropsTornTail) {
+    TempPath tmp;
+    {
+        Journal j;
+        ASSERT_TRUE(j.open(tmp.path, 16, JournalSync::None));
+        for (int i = 1; i <= 3; ++i) j.append(order(JournalOp::New, Side::Buy, i, 100, i));
+    }
+    // Damage the last record, as a crash mid-write might.
+    overwrite(tmp.path, 2, 8 * 5, 0x7f);
+
+    Journal j;
+    ASSERT_TRUE(j.open(tmp.path, 16, JournalSync::None));
+    ASSERT_EQ(j.recovered(), 2u);
+    EXPECT_EQ(j.record(1).order_id, 2);
+    EXPECT_EQ(j.append(order(JournalOp::New, Side::Buy, 1, 100, 9)), 3u);   // reuses the torn slot
+}
+
+TEST(Journal, RecoverySkipsAnUnwrittenLowerSlot) {
+    // Two shards share the slot counter: shard 0 reserves slot 2 but crashes
+    // before writing it, while shard 1 writes and commits slot 3 (and ACKs).
+    TempPath tmp;
+    {
+        Journal j;
+        ASSERT_TRUE(j.open(tmp.path, 16, JournalSync::Batch));
+        JournalRecord r = order(JournalOp::New, Side::Buy, 1, 100, 1);
+        r.shard = 0;
+        j.append(r);
+        r = order(JournalOp::New, Side::Buy, 2, 100, 2);
+        j.append(r);
+        r = order(JournalOp::New, Side::Sell, 3, 105, 3);
+        r.shard = 1;
+        EXPECT_EQ(j.append(r), 3u);
+        j.commit(3, 3);
+    }
+    for (size_t b = 0; b < sizeof(JournalRecord); ++b) overwrite(tmp.path, 1, b, 0);
+
+    Journal j;
+    ASSERT_TRUE(j.open(tmp.path, 16, JournalSync::None));
+    ASSERT_EQ(j.recovered(), 2u);
+    EXPECT_EQ(j.record(0).order_id, 1);
+    EXPECT_EQ(j.record(1).order_id, 3);
+    EXPECT_EQ(j.record(1).shard, 1);
+    EXPECT_EQ(j.append(order(JournalOp::Cancel, Side::Buy, 0, 0, 1)), 4u);   // after the survivor
+}
+
+TEST(Journal, FullJournalRefusesAppends) {
+    TempPath tmp;
+    Journal j;
+    ASSERT_TRUE(j.open(tmp.path, 2, JournalSync::None));
+    EXPECT_NE(j.append(order(JournalOp::New, Side::Buy, 1, 100, 1)), 0u);
+    EXPECT_NE(j.append(order(JournalOp::New, Side::Buy, 1, 100, 2)), 0u);
+    EXPECT_EQ(j.append(order(JournalOp::New, Side::Buy, 1, 100, 3)), 0u);
+}
+
+TEST(Journal, ReplayRebuildsTheBook) {
+    TempPath tmp;
+    OrderBook live;
+    BookEvents ev;
+    {
+        Journal j;
+        ASSERT_TRUE(j.open(tmp.path, 64, JournalSync::None));
+        const JournalRecord in[] = {
+            order(JournalOp::New, Side::Sell, 100, 105, 1),
+            order(JournalOp::New, Side::Sell, 50, 106, 2),
+            order(JournalOp::New, Side::Buy, 30, 101, 3),
+            order(JournalOp::New, Side::Buy, 120, 105, 4),   // crosses: fills 1, rests 20 @ 105
+            order(JournalOp::Modify, Side::Buy, 10, 102, 3),
+            order(JournalOp::Cancel, Side::Buy, 0, 0, 2),
+        };
+        for (const auto& r : in) { j.append(r); journalApply(live, r, ev); }
+    }
+
+    Journal j;
+    ASSERT_TRUE(j.openReadOnly(tmp.path));
+    OrderBook replayed;
+    for (size_t i = 0; i < j.recovered(); ++i) journalApply(replayed, j.record(i), ev);
+
+    for (Side s : {Side::Buy, Side::Sell}) {
+        const auto a = levels(live, s), b = levels(replayed, s);
+        ASSERT_EQ(a.size(), b.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            EXPECT_EQ(a[i].price_ticks, b[i].price_ticks);
+            EXPECT_EQ(a[i].qty, b[i].qty);
+            EXPECT_EQ(a[i].count, b[i].count);
+        }
+    }
+    EXPECT_EQ(replayed.restingOrders(), live.restingOrders());
+    EXPECT_EQ(replayed.bestBidTicks(), 105);
+}
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <vector>
+
+TEST(LatencyHistogram, SmallValuesAreExact) {
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 100; ++v) h.record(v);
+    EXPECT_EQ(h.count(), 100u);
+    EXPECT_EQ(h.min(), 1u);
+    EXPECT_EQ(h.max(), 100u);
+    EXPECT_EQ(h.percentile(50), 50u);
+    EXPECT_EQ(h.percentile(99), 99u);
+    EXPECT_EQ(h.percentile(100), 100u);
+    EXPECT_DOUBLE_EQ(h.mean(), 50.5);
+}
+
+TEST(LatencyHistogram, BucketsCoverTheRangeInOrder) {
+    size_t last = 0;
+    for (uint64_t v : {uint64_t{0}, uint64_t{255}, uint64_t{256}, uint64_t{1000}, uint64_t{1} << 40, UINT64_MAX}) {
+        const size_t i = LatencyHistogram::index(v);
+        ASSERT_LT(i, LatencyHistogram::kBuckets);
+        EXPECT_GE(i, last);
+        EXPECT_GE(LatencyHistogram::highest(i), v);
+        last = i;
+    }
+    // A bucket's highest value maps back to the same bucket.
+    for (size_t i = 0; i + 1 < LatencyHistogram::kBuckets; ++i) {
+        ASSERT_EQ(LatencyHistogram::index(LatencyHistogram::highest(i)), i);
+        ASSERT_EQ(LatencyHistogram::index(LatencyHistogram::highest(i) + 1), i + 1);
+    }
+}
+
+TEST(LatencyHistogram, PercentilesWithinRelativeError) {
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> dist(11.0, 1.5);   // ~60 us median, long tail
+    std::vector<uint64_t> raw;
+    LatencyHistogram a, b;
+    for (int i = 0; i < 200000; ++i) {
+        const auto v = static_cast<uint64_t>(dist(rng));
+        raw.push_back(v);
+        (i % 2 ? a : b).record(v);   // two threads' worth, merged below
+    }
+    a.merge(b);
+    ASSERT_EQ(a.count(), raw.size());
+    std::sort(raw.begin(), raw.end());
+    EXPECT_EQ(a.max(), raw.back());
+    for (double p : {50.0, 90.0, 99.0, 99.9, 99.99}) {
+        const auto exact = static_cast<double>(raw[static_cast<size_t>(p / 100.0 * raw.size() + 0.5) - 1]);
+        const auto got = static_cast<double>(a.percentile(p));
+        EXPECT_GE(got, exact) << p;
+        EXPECT_LE(got, exact * (1.0 + 1.0 / 128)) << p;
+    }
+}
+
+TEST(LatencyHistogram, WritesHgrmPercentiles) {
+    LatencyHistogram h;
+    for (int i = 0; i < 10; ++i) h.record(200);
+    h.record(250);
+    std::ostringstream out;
+    h.writePercentiles(out, 100.0);
+    const std::string s = out.str();
+    EXPECT_NE(s.find("Value     Percentile TotalCount"), std::string::npos);
+    EXPECT_NE(s.find("       2.000 0.909090909091         10          11.00"), std::string::npos);
+    EXPECT_NE(s.find("       2.500 1.000000000000         11"), std::string::npos);
+    EXPECT_NE(s.find("Total count    =           11"), std::string::npos);
+
+    h.reset();
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.percentile(99), 0u);
+}
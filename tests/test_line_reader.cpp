@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+#include "line_reader.hpp"
+
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+struct SocketPair {
+    int fds[2]{-1, -1};
+    SocketPair()  { EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0); }
+    ~SocketPair() { if (fds[0] >= 0) close(fds[0]); if (fds[1] >= 0) close(fds[1]); }
+    void write(const std::string& s) { ASSERT_EQ(::write(fds[1], s.data(), s.size()), static_cast<ssize_t>(s.size())); }
+};
+}
+
+TEST(LineReader, SplitsManyLinesFromOneRecv) {
+    SocketPair sp;
+    sp.write("NEW BUY 10 @ 50.25\nCXL 7\nQUIT\n");
+
+    LineReader r;
+    std::string_view line;
+    ASSERT_EQ(r.readLine(sp.fds[0], line), LineReader::Status::Line);
+    EXPECT_EQ(line, "NEW BUY 10 @ 50.25");
+    ASSERT_EQ(r.readLine(sp.fds[0], line), LineReader::Status::Line);
+    EXPECT_EQ(line, "CXL 7");
+    ASSERT_EQ(r.readLine(sp.fds[0], line), LineReader::Status::Line);
+    EXPECT_EQ(line, "QUIT");
+    EXPECT_EQ(r.recvCalls(), 1u);
+}
+
+TEST(LineReader, JoinsPartialLinesAcrossReads) {
+    SocketPair sp;
+    LineReader r;
+    std::string_view line;
+
+    sp.write("NEW SE");
+    EXPECT_EQ(r.readLine(sp.fds[0], line, MSG_DONTWAIT), LineReader::Status::Again);
+    sp.write("LL 5 @ 1.00\n\nMOD");
+    ASSERT_EQ(r.readLine(sp.fds[0], line, MSG_DONTWAIT), LineReader::Status::Line);
+    EXPECT_EQ(line, "NEW SELL 5 @ 1.00");
+    ASSERT_EQ(r.readLine(sp.fds[0], line, MSG_DONTWAIT), LineReader::Status::Line);
+    EXPECT_EQ(line, "");
+    EXPECT_EQ(r.readLine(sp.fds[0], line, MSG_DONTWAIT), LineReader::Status::Again);
+    EXPECT_EQ(r.buffered(), 3u);
+
+    close(sp.fds[1]); sp.fds[1] = -1;
+    EXPECT_EQ(r.readLine(sp.fds[0], line), LineReader::Status::Closed);
+}
+
+TEST(LineReader, RejectsLinesOverLimitButAcceptsExactLimit) {
+    SocketPair sp;
+    LineReader r(16, 8);
+    std::string_view line;
+
+    sp.write(std::string(16, 'x') + "\n");
+    ASSERT_EQ(r.readLine(sp.fds[0], line), LineReader::Status::Line);
+    EXPECT_EQ(line.size(), 16u);
+
+    sp.write(std::string(17, 'y'));
+    EXPECT_EQ(r.readLine(sp.fds[0], line), LineReader::Status::TooLong);
+}
+
+TEST(LineReader, CompactsLongStreamsWithSmallBuffer) {
+    SocketPair sp;
+    LineReader r(32, 16);
+    std::string_view line;
+    std::string all;
+    for (int i = 0; i < 200; ++i) all += "CXL " + std::to_string(i) + "\n";
+
+    int got = 0;
+    size_t off = 0;
+    while (got < 200) {
+        if (off < all.size()) {
+            const size_t n = std::min<size_t>(37, all.size() - off);
+            sp.write(all.substr(off, n));
+            off += n;
+        }
+        while (r.readLine(sp.fds[0], line, MSG_DONTWAIT) == LineReader::Status::Line) {
+            EXPECT_EQ(line, "CXL " + std::to_string(got));
+            ++got;
+        }
+    }
+    EXPECT_EQ(got, 200);
+}
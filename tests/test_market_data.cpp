@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "market_data.hpp"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+// Bound loopback UDP socket on an ephemeral port.
+struct UdpSink {
+    int fd = -1;
+    uint16_t port = 0;
+    UdpSink() {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in a{}; a.sin_family = AF_INET; a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(bind(fd, reinterpret_cast<sockaddr*>(&a), sizeof(a)), 0);
+        socklen_t len = sizeof(a);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&a), &len);
+        port = ntohs(a.sin_port);
+        timeval tv{0, 200000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    ~UdpSink() { close(fd); }
+
+    // Receives datagrams until the socket stays quiet.
+    std::vector<std::vector<char>> drain() {
+        std::vector<std::vector<char>> out;
+        char buf[2048];
+        ssize_t n;
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) out.emplace_back(buf, buf + n);
+        return out;
+    }
+};
+
+BookEvent trade(int i) {
+    BookEvent ev;
+    ev.type = BookEventType::Trade;
+    ev.qty = i + 1;
+    ev.price_ticks = 5000 + i;
+    ev.order_id = i;
+    return ev;
+}
+}
+
+TEST(MdChannel, PacksSequencedMessagesIntoMtuDatagrams) {
+    UdpSink sink;
+    MarketDataPublisher pub("127.0.0.1", sink.port);
+    MdChannel ch(pub, 3, /*flush_ns*/ UINT64_MAX);
+
+    SymbolId sym = 0;
+    ASSERT_TRUE(encodeSymbol("AAPL", sym));
+    BookEvent rej; rej.type = BookEventType::Reject;
+    for (int i = 0; i < 100; ++i) {
+        ch.publish(trade(i), sym, 1000 + i);
+        ch.publish(rej, sym, 1000 + i);   // not market data: no sequence number
+    }
+    ch.flush();
+    EXPECT_EQ(ch.nextSeq(), 101u);
+
+    const auto dgrams = sink.drain();
+    ASSERT_EQ(dgrams.size(), (100 + kMdMsgsPerDatagram - 1) / kMdMsgsPerDatagram);
+    EXPECT_EQ(pub.datagramsSent(), dgrams.size());
+
+    uint64_t next = 1;
+    for (const auto& d : dgrams) {
+        ASSERT_LE(d.size(), kMdMaxDatagram);
+        MdPacketHeader h;
+        std::memcpy(&h, d.data(), sizeof(h));
+        EXPECT_EQ(h.magic, kMdMagic);
+        EXPECT_EQ(h.channel, 3);
+        EXPECT_EQ(h.first_seq, next);
+        ASSERT_EQ(d.size(), sizeof(h) + h.count * sizeof(MdMsg));
+        for (uint16_t i = 0; i < h.count; ++i) {
+            MdMsg m;
+            std::memcpy(&m, d.data() + sizeof(h) + i * sizeof(MdMsg), sizeof(m));
+            const BookEvent ev = mdDecode(m);
+            const int k = static_cast<int>(next - 1 + i);
+            EXPECT_EQ(ev.type, BookEventType::Trade);
+            EXPECT_EQ(ev.qty, k + 1);
+            EXPECT_EQ(ev.price_ticks, 5000 + k);
+            EXPECT_EQ(m.symbol, sym);
+            EXPECT_EQ(m.ts_ns, static_cast<uint64_t>(1000 + k));
+        }
+        next += h.count;
+    }
+    EXPECT_EQ(next, 101u);
+}
+
+TEST(MdChannel, FlushesOnAgeWithinABatch) {
+    UdpSink sink;
+    MarketDataPublisher pub("127.0.0.1", sink.port);
+    MdChannel ch(pub, 0, /*flush_ns*/ 50);
+
+    ch.publish(trade(0), kDefaultSymbol, 100);
+    ch.publish(trade(1), kDefaultSymbol, 120);   // still young: buffered
+    ch.publish(trade(2), kDefaultSymbol, 160);   // oldest is 60ns old: flush
+    ch.publish(trade(3), kDefaultSymbol, 170);
+    EXPECT_EQ(sink.drain().size(), 1u);
+    ch.flush();
+    const auto rest = sink.drain();
+    ASSERT_EQ(rest.size(), 1u);
+    MdPacketHeader h;
+    std::memcpy(&h, rest[0].data(), sizeof(h));
+    EXPECT_EQ(h.first_seq, 4u);
+    EXPECT_EQ(h.count, 1);
+}
@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "md_publisher.hpp"
+
+#include <cstring>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+struct UdpSink {
+    int fd = -1;
+    uint16_t port = 0;
+    UdpSink() {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in a{}; a.sin_family = AF_INET; a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(bind(fd, reinterpret_cast<sockaddr*>(&a), sizeof(a)), 0);
+        socklen_t len = sizeof(a);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&a), &len);
+        port = ntohs(a.sin_port);
+        timeval tv{0, 200000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    ~UdpSink() { close(fd); }
+
+    std::vector<std::string> lines() {
+        std::vector<std::string> out;
+        char buf[2048];
+        ssize_t n;
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) out.emplace_back(buf, static_cast<size_t>(n));
+        return out;
+    }
+};
+
+MdItem event(BookEventType type, int64_t price) {
+    MdItem it;
+    it.ev.type = type;
+    it.ev.price_ticks = price;
+    it.ev.qty = 1;
+    return it;
+}
+
+MdItem level(uint64_t seq) {
+    MdItem it;
+    it.kind = MdItem::Kind::Level;
+    it.seq = seq;
+    std::memset(&it.rec, 0, sizeof(it.rec));
+    it.rec.type = static_cast<uint8_t>(MdType::LevelUpdate);
+    it.rec.price_ticks = static_cast<int64_t>(seq);
+    it.rec.qty = 1;
+    return it;
+}
+
+MdWriterConfig textConfig(uint64_t conflate_ns) {
+    MdWriterConfig cfg;
+    cfg.conflate_ns = conflate_ns;
+    cfg.price = PriceFormat(1);   // prices print as raw ticks
+    return cfg;
+}
+}
+
+TEST(SpscRing, KeepsOrderAndReportsFull) {
+    SpscRing<int> ring(4);
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(ring.tryPush(i));
+    EXPECT_FALSE(ring.tryPush(4));
+
+    int out[8];
+    ASSERT_EQ(ring.popBatch(out, 3), 3u);
+    EXPECT_EQ(out[0], 0);
+    EXPECT_EQ(out[2], 2);
+    EXPECT_TRUE(ring.tryPush(4));
+
+    // The consumer may see the new item only once its cached view is empty.
+    std::vector<int> rest;
+    size_t n;
+    while ((n = ring.popBatch(out, 8)) > 0) rest.insert(rest.end(), out, out + n);
+    EXPECT_EQ(rest, (std::vector<int>{3, 4}));
+}
+
+TEST(MdWriter, ConflatesBboButNotTrades) {
+    UdpSink sink;
+    MarketDataPublisher pub("127.0.0.1", sink.port);
+    MdWriter w(pub, 0, textConfig(/*conflate_ns*/ 1000));
+
+    for (int i = 0; i < 5; ++i) w.handle(event(BookEventType::BestBid, 100 + i));
+    w.handle(event(BookEventType::Trade, 99));
+    w.handle(event(BookEventType::BestAsk, 110));
+    EXPECT_EQ(w.conflated(), 4u);
+
+    w.flush(1000);   // interval elapsed: latest bid and ask go out
+    const auto lines = sink.lines();
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_EQ(lines[0].rfind("TRADE", 0), 0u);
+    EXPECT_NE(lines[1].find("104"), std::string::npos);
+    EXPECT_NE(lines[2].find("110"), std::string::npos);
+
+    // Nothing pending: a later flush sends nothing.
+    w.flush(5000);
+    EXPECT_TRUE(sink.lines().empty());
+}
+
+TEST(MdPublisherThread, DeliversPostedItemsOnStop) {
+    UdpSink sink;
+    MarketDataPublisher pub("127.0.0.1", sink.port);
+    MdPublisherThread stage(pub, 2, textConfig(0), 64);
+    stage.start();
+    for (int i = 0; i < 10; ++i) ASSERT_TRUE(stage.post(static_cast<size_t>(i % 2), event(BookEventType::Trade, i)));
+    stage.stop();
+    EXPECT_EQ(sink.lines().size(), 10u);
+    EXPECT_EQ(stage.dropped(), 0u);
+}
+
+// Items the engine could not post must still cost their sequence numbers, so
+// a subscriber sees the loss as a gap rather than a quietly wrong book.
+TEST(MdPublisherThread, FullRingShowsUpAsGap) {
+    UdpSink sink;
+    MarketDataPublisher pub("127.0.0.1", sink.port);
+    MdWriterConfig cfg;
+    cfg.binary = true;
+    MdPublisherThread stage(pub, 1, cfg, 4);
+
+    // Not started yet: the ring takes 4 items, the next 4 are dropped.
+    for (uint64_t seq = 1; seq <= 8; ++seq) EXPECT_EQ(stage.post(0, level(seq)), seq <= 4);
+    EXPECT_EQ(stage.dropped(), 4u);
+
+    stage.start();
+    while (!stage.post(0, level(9))) std::this_thread::yield();
+    stage.stop();
+
+    std::vector<uint64_t> seqs;
+    for (const std::string& d : sink.lines()) {
+        MdPacketHeader h;
+        ASSERT_GE(d.size(), sizeof(h));
+        std::memcpy(&h, d.data(), sizeof(h));
+        for (uint16_t i = 0; i < h.count; ++i) {
+            MdLevelMsg r;
+            std::memcpy(&r, d.data() + sizeof(h) + i * sizeof(MdMsg), sizeof(r));
+            EXPECT_EQ(static_cast<uint64_t>(r.price_ticks), h.first_seq + i);   // wire seq == engine seq
+            seqs.push_back(h.first_seq + i);
+        }
+    }
+    ASSERT_GE(seqs.size(), 5u);
+    EXPECT_EQ(std::vector<uint64_t>(seqs.begin(), seqs.begin() + 5), (std::vector<uint64_t>{1, 2, 3, 4, 9}));
+}
@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <cstdio>
 #include <cmath>
+#include <limits>
+#include <random>
 
 // -------- helpers -----------------------------------------------------------
 
@@ -135,4 +137,230 @@ TEST(OrderBookV2, CancelRemovesOrderAndUpdatesSnapshot) {
     (void)rep;
 
     EXPECT_EQ(ob.bestBidTicks(), 0);
-}
\ No newline at end of file
+}
+TEST(OrderBookEvents, SweepReportsTypedTradesAndBest) {
+    OrderBook ob;
+    BookEvents ev;
+
+    ob.processOrder(Side::Sell, 30, to_ticks(50.20), 1, ev);
+    ob.processOrder(Side::Sell, 30, to_ticks(50.21), 2, ev);
+    ev.clear();
+
+    ob.processOrder(Side::Buy, 50, to_ticks(50.21), 3, ev);
+
+    ASSERT_EQ(ev.size(), 3u);
+    EXPECT_EQ(ev[0].type, BookEventType::Trade);
+    EXPECT_EQ(ev[0].side, Side::Buy);
+    EXPECT_EQ(ev[0].qty, 30);
+    EXPECT_EQ(ev[0].price_ticks, to_ticks(50.20));
+    EXPECT_EQ(ev[0].order_id, 1);
+    EXPECT_EQ(ev[1].type, BookEventType::Trade);
+    EXPECT_EQ(ev[1].qty, 20);
+    EXPECT_EQ(ev[1].order_id, 2);
+    EXPECT_EQ(ev[2].type, BookEventType::BestAsk);
+    EXPECT_EQ(ev[2].price_ticks, to_ticks(50.21));
+    EXPECT_EQ(ev[2].qty, 10);
+}
+
+TEST(OrderBookEvents, StringAdapterMatchesFormattedEvents) {
+    OrderBook a, b;
+    BookEvents ev;
+
+    (void)a.processOrder(Side::Buy, 100, to_ticks(50.25), 1, fmt_price_2dp);
+    b.processOrder(Side::Buy, 100, to_ticks(50.25), 1, ev);
+    ev.clear();
+
+    auto lines = a.replace(1, 40, to_ticks(50.30), 1, fmt_price_2dp);
+    b.replace(1, 40, to_ticks(50.30), 1, ev);
+
+    ASSERT_EQ(lines.size(), ev.size());
+    for (size_t i = 0; i < ev.size(); ++i)
+        EXPECT_EQ(lines[i], formatEvent(ev[i], fmt_price_2dp));
+    EXPECT_EQ(lines[0], "CANCELED id 1");
+    EXPECT_EQ(lines[1], "REPLACED 1 -> 1");
+
+    auto err = a.cancel(99, fmt_price_2dp);
+    ASSERT_FALSE(err.empty());
+    EXPECT_EQ(err[0], "ERROR Unknown order id 99");
+}
+
+// -------- dense ladder backend ----------------------------------------------
+
+static BookConfig dense_cfg(int64_t span) {
+    BookConfig cfg;
+    cfg.ladder = LadderKind::Dense;
+    cfg.dense_span = span;
+    return cfg;
+}
+
+TEST(OrderBookDense, CrossesAndSnapshotsLikeMap) {
+    OrderBook ob(dense_cfg(4096));
+
+    (void)ob.processOrder(Side::Buy, 100, to_ticks(50.25), 1, fmt_price_2dp);
+    (void)ob.processOrder(Side::Buy,  20, to_ticks(50.25), 3, fmt_price_2dp);
+    (void)ob.processOrder(Side::Buy,  10, to_ticks(50.20), 2, fmt_price_2dp);
+    auto r = ob.processOrder(Side::Sell, 120, to_ticks(50.10), 4, fmt_price_2dp);
+
+    EXPECT_TRUE(contains_regex(r, trade_re_with_side("SELL", 100, R"(50\.25)", 1)));
+    EXPECT_TRUE(contains_regex(r, trade_re_with_side("SELL", 20,  R"(50\.25)", 3)));
+    EXPECT_EQ(ob.bestBidTicks(), to_ticks(50.20));
+    EXPECT_EQ(ob.bestBidQty(), 10);
+
+    (void)ob.cancel(2, fmt_price_2dp);
+    EXPECT_FALSE(ob.hasBestBid());
+}
+
+TEST(OrderBookDense, FarPricesFallBackToSparseLevels) {
+    OrderBook ob(dense_cfg(64));
+
+    (void)ob.processOrder(Side::Sell, 10, 5000, 1, fmt_price_2dp);   // centres the ask window
+    (void)ob.processOrder(Side::Sell, 10, 9000, 2, fmt_price_2dp);   // far above: sparse
+    (void)ob.processOrder(Side::Sell, 10, 100,  3, fmt_price_2dp);   // far below: sparse, new best
+    EXPECT_EQ(ob.bestAskTicks(), 100);
+
+    auto r = ob.processOrder(Side::Buy, 25, 9000, 4, fmt_price_2dp);
+    EXPECT_TRUE(contains_regex(r, trade_re_with_side("BUY", 10, R"(1\.00)", 3)));
+    EXPECT_TRUE(contains_regex(r, trade_re_with_side("BUY", 10, R"(50\.00)", 1)));
+    EXPECT_TRUE(contains_regex(r, trade_re_with_side("BUY", 5,  R"(90\.00)", 2)));
+    EXPECT_EQ(ob.bestAskTicks(), 9000);
+    EXPECT_EQ(ob.bestAskQty(), 5);
+}
+
+// Random flow (including prices far outside a small window) must produce
+// exactly the same event stream from both backends.
+TEST(OrderBookDense, RandomFlowMatchesMapBackend) {
+    OrderBook map_book;
+    OrderBook dense_book(dense_cfg(128));
+    BookEvents a, b;
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> op_dist(0, 9), qty_dist(1, 200), side_dist(0, 1);
+    std::normal_distribution<double> px_dist(5025.0, 150.0);
+    std::vector<int64_t> live;
+    int64_t next_id = 1;
+
+    for (int i = 0; i < 20000; ++i) {
+        a.clear(); b.clear();
+        const int op = op_dist(rng);
+        if (op < 2 && !live.empty()) {
+            const size_t k = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+            map_book.cancel(live[k], a);
+            dense_book.cancel(live[k], b);
+            live[k] = live.back(); live.pop_back();
+        } else if (op < 3 && !live.empty()) {
+            const size_t k = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+            const int64_t px = std::max<int64_t>(1, std::llround(px_dist(rng)));
+            const int qty = qty_dist(rng);
+            map_book.replace(live[k], qty, px, live[k], a);
+            dense_book.replace(live[k], qty, px, live[k], b);
+        } else {
+            const Side side = side_dist(rng) ? Side::Buy : Side::Sell;
+            const int64_t px = std::max<int64_t>(1, std::llround(px_dist(rng)));
+            const int qty = qty_dist(rng);
+            map_book.processOrder(side, qty, px, next_id, a);
+            dense_book.processOrder(side, qty, px, next_id, b);
+            live.push_back(next_id++);
+        }
+        ASSERT_EQ(a.size(), b.size()) << "step " << i;
+        for (size_t j = 0; j < a.size(); ++j)
+            ASSERT_EQ(formatEvent(a[j], fmt_price_2dp), formatEvent(b[j], fmt_price_2dp)) << "step " << i;
+    }
+}
+
+// -------- pooled order store ------------------------------------------------
+
+TEST(OrderBookPool, CancelFromMiddleKeepsFIFOAndRecyclesNodes) {
+    BookConfig cfg;
+    cfg.pool_capacity = 8;
+    OrderBook ob(cfg);
+    BookEvents ev;
+
+    for (int64_t id = 1; id <= 5; ++id) ob.processOrder(Side::Buy, 10, to_ticks(50.00), id, ev);
+    EXPECT_EQ(ob.restingOrders(), 5u);
+    EXPECT_EQ(ob.poolHighWater(), 5u);
+
+    ob.cancel(3, ev);
+    ob.cancel(1, ev);
+    ob.cancel(5, ev);
+    EXPECT_EQ(ob.restingOrders(), 2u);
+    EXPECT_EQ(ob.bestBidQty(), 20);
+
+    ev.clear();
+    ob.processOrder(Side::Sell, 20, to_ticks(50.00), 6, ev);
+    ASSERT_GE(ev.size(), 2u);
+    EXPECT_EQ(ev[0].order_id, 2);
+    EXPECT_EQ(ev[1].order_id, 4);
+    EXPECT_EQ(ob.restingOrders(), 0u);
+
+    // Freed nodes are reused; growth past the preallocation adds a slab.
+    for (int64_t id = 10; id < 20; ++id) ob.processOrder(Side::Buy, 1, to_ticks(49.00), id, ev);
+    EXPECT_EQ(ob.poolHighWater(), 10u);
+    EXPECT_GE(ob.poolCapacity(), 10u);
+}
+
+// -------- per-level aggregates ----------------------------------------------
+
+TEST(OrderBookDepth, LevelTotalsTrackAddFillCancelReplace) {
+    for (LadderKind kind : {LadderKind::Map, LadderKind::Dense}) {
+        BookConfig cfg;
+        cfg.ladder = kind;
+        OrderBook ob(cfg);
+        BookEvents ev;
+
+        ob.processOrder(Side::Sell, 100, to_ticks(50.30), 1, ev);
+        ob.processOrder(Side::Sell,  50, to_ticks(50.30), 2, ev);
+        ob.processOrder(Side::Sell,  70, to_ticks(50.40), 3, ev);
+        ob.processOrder(Side::Buy,   40, to_ticks(50.10), 4, ev);
+
+        LevelInfo li;
+        ASSERT_TRUE(ob.depthAt(Side::Sell, 0, li));
+        EXPECT_EQ(li.price_ticks, to_ticks(50.30));
+        EXPECT_EQ(li.qty, 150);
+        EXPECT_EQ(li.count, 2);
+        ASSERT_TRUE(ob.depthAt(Side::Sell, 1, li));
+        EXPECT_EQ(li.price_ticks, to_ticks(50.40));
+        EXPECT_EQ(li.qty, 70);
+        EXPECT_FALSE(ob.depthAt(Side::Sell, 2, li));
+        EXPECT_EQ(ob.depthLevels(Side::Sell), 2u);
+
+        ob.processOrder(Side::Buy, 30, to_ticks(50.30), 5, ev);   // partial fill of id 1
+        ASSERT_TRUE(ob.depthAt(Side::Sell, 0, li));
+        EXPECT_EQ(li.qty, 120);
+        EXPECT_EQ(li.count, 2);
+
+        ob.cancel(2, ev);
+        ASSERT_TRUE(ob.depthAt(Side::Sell, 0, li));
+        EXPECT_EQ(li.qty, 70);
+        EXPECT_EQ(li.count, 1);
+        EXPECT_EQ(ob.bestAskQty(), 70);
+
+        ob.replace(3, 25, to_ticks(50.30), 3, ev);                // moves into the touch
+        std::vector<LevelInfo> asks;
+        EXPECT_EQ(ob.depth(Side::Sell, 10, asks), 1u);
+        EXPECT_EQ(asks[0].qty, 95);
+        EXPECT_EQ(asks[0].count, 2);
+
+        std::vector<LevelInfo> bids;
+        EXPECT_EQ(ob.depth(Side::Buy, 10, bids), 1u);
+        EXPECT_EQ(bids[0].price_ticks, to_ticks(50.10));
+        EXPECT_EQ(bids[0].qty, 40);
+    }
+}
+
+// A level's total can exceed what one order may hold; the best-price event
+// and accessors must carry it without wrapping.
+TEST(OrderBookDepth, LevelTotalsAboveIntMaxDoNotWrap) {
+    OrderBook ob;
+    BookEvents ev;
+    const int big = std::numeric_limits<int>::max();
+    const int64_t total = 2 * static_cast<int64_t>(big);
+
+    ob.processOrder(Side::Buy, big, to_ticks(50.00), 1, ev);
+    ev.clear();
+    ob.processOrder(Side::Buy, big, to_ticks(50.00), 2, ev);
+
+    EXPECT_EQ(ob.bestBidQty(), total);
+    ASSERT_FALSE(ev.empty());
+    EXPECT_EQ(ev.back().type, BookEventType::BestBid);
+    EXPECT_EQ(ev.back().qty, total);
+}
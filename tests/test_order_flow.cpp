@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+#include "order_flow.hpp"
+#include "temp_path.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+// Drives a model against a book that rests every non-marketable NEW, as the
+// exchange's ORDER_ADDED replies would.
+std::vector<FlowOrder> run(FlowModel& m, int n, int64_t& next_id) {
+    std::vector<FlowOrder> out;
+    for (int i = 0; i < n; ++i) {
+        const FlowOrder o = m.next();
+        if (o.action != FlowAction::Cancel && !o.marketable) m.onAdded(next_id++, o.side, o.symbol, o.qty);
+        out.push_back(o);
+    }
+    return out;
+}
+}
+
+TEST(OrderFlow, SameSeedSameStream) {
+    FlowConfig cfg;
+    cfg.seed = 42;
+    FlowModel a(cfg), b(cfg), c(cfg, 1);
+    int64_t ia = 1, ib = 1, ic = 1;
+    const auto ra = run(a, 2000, ia), rb = run(b, 2000, ib), rc = run(c, 2000, ic);
+    bool differs = false;
+    for (size_t i = 0; i < ra.size(); ++i) {
+        ASSERT_EQ(ra[i].action, rb[i].action) << i;
+        ASSERT_EQ(ra[i].price_ticks, rb[i].price_ticks) << i;
+        ASSERT_EQ(ra[i].qty, rb[i].qty) << i;
+        ASSERT_EQ(ra[i].order_id, rb[i].order_id) << i;
+        differs |= ra[i].price_ticks != rc[i].price_ticks || ra[i].action != rc[i].action;
+    }
+    EXPECT_TRUE(differs);   // another stream is another sequence
+}
+
+TEST(OrderFlow, MixFollowsWeightsAndTargetsLiveOrders) {
+    FlowConfig cfg;
+    cfg.new_weight = 0.5; cfg.cancel_weight = 0.3; cfg.modify_weight = 0.2;
+    cfg.marketable = 0.1;
+    cfg.max_live = 0;   // no cap
+    FlowModel m(cfg);
+    int64_t next_id = 1;
+    std::vector<bool> live(1, false);
+    const int n = 100000;
+    for (int i = 0; i < n; ++i) {
+        const FlowOrder o = m.next();
+        if (o.action != FlowAction::New) {
+            // Only ids that rested and have not been canceled or replaced.
+            ASSERT_GT(o.order_id, 0);
+            ASSERT_TRUE(live[static_cast<size_t>(o.order_id)]) << o.order_id;
+            live[static_cast<size_t>(o.order_id)] = false;
+        }
+        if (o.action != FlowAction::Cancel && !o.marketable) {
+            live.push_back(true);
+            m.onAdded(next_id++, o.side, o.symbol, o.qty);
+        }
+        if (o.action != FlowAction::Cancel) { ASSERT_GT(o.price_ticks, 0); }
+    }
+    const FlowStats& s = m.stats();
+    EXPECT_EQ(s.news + s.cancels + s.modifies, static_cast<uint64_t>(n));
+    EXPECT_NEAR(static_cast<double>(s.news) / n, 0.5, 0.02);
+    EXPECT_NEAR(static_cast<double>(s.cancels) / n, 0.3, 0.02);
+    EXPECT_NEAR(static_cast<double>(s.modifies) / n, 0.2, 0.02);
+    EXPECT_NEAR(static_cast<double>(s.marketable) / static_cast<double>(s.news), 0.1, 0.01);
+}
+
+TEST(OrderFlow, PricesSitAroundTheMid) {
+    FlowConfig cfg;
+    cfg.walk_ticks = 0;   // fixed mid
+    cfg.marketable = 0.5;
+    cfg.cancel_weight = cfg.modify_weight = 0;
+    cfg.qty_dist = QtyDist::Uniform; cfg.qty_min = 5; cfg.qty_max = 9;
+    FlowModel m(cfg);
+    for (int i = 0; i < 5000; ++i) {
+        const FlowOrder o = m.next();
+        ASSERT_EQ(o.action, FlowAction::New);
+        ASSERT_GE(o.qty, 5);
+        ASSERT_LE(o.qty, 9);
+        const int64_t d = o.price_ticks - cfg.mid_ticks;
+        if (o.marketable) EXPECT_EQ(d, o.side == Side::Buy ? cfg.cross_ticks : -cfg.cross_ticks);
+        else if (o.side == Side::Buy) EXPECT_LE(d, -cfg.half_spread);
+        else EXPECT_GE(d, cfg.half_spread);
+    }
+}
+
+TEST(OrderFlow, MaxLiveTurnsNewsIntoCancels) {
+    FlowConfig cfg;
+    cfg.cancel_weight = cfg.modify_weight = 0;
+    cfg.marketable = 0;
+    cfg.max_live = 10;
+    FlowModel m(cfg);
+    int64_t next_id = 1;
+    run(m, 1000, next_id);
+    EXPECT_LE(m.live(), 10u);
+    EXPECT_GT(m.stats().cancels, 0u);
+}
+
+TEST(OrderFlow, LearnsFromReplyLines) {
+    FlowConfig cfg;
+    cfg.new_weight = 0; cfg.cancel_weight = 1; cfg.modify_weight = 0;
+    FlowModel m(cfg);
+    m.observeLine("ORDER_ADDED BUY 10 @ 50.24 id 7");
+    m.observeLine("ORDER_ADDED SELL 5 @ 50.30 id 9 sym AAPL tag 3");
+    m.observeLine("TRADE BUY 2 @ 50.30 against id 9 tag 5");   // partial fill
+    EXPECT_EQ(m.live(), 2u);
+    m.observeLine("CANCELED id 7");
+    EXPECT_EQ(m.live(), 1u);
+
+    FlowOrder o = m.next();
+    ASSERT_EQ(o.action, FlowAction::Cancel);
+    EXPECT_EQ(o.order_id, 9);
+    EXPECT_EQ(o.side, Side::Sell);
+    std::string text;
+    FlowModel::appendText(o, 100, text);
+    EXPECT_EQ(text, "CXL AAPL 9\n");
+
+    m.observeLine("ORDER_ADDED SELL 5 @ 50.30 id 11");
+    m.observeLine("ORDER_ADDED BUY 4 @ 50.20 id 12");
+    m.observeLine("ERROR Unknown order id 11 tag 4");
+    EXPECT_EQ(m.live(), 1u);
+    m.observeLine("TRADE SELL 3 @ 50.20 against id 12");
+    m.observeLine("TRADE SELL 1 @ 50.20 against id 12");
+    EXPECT_EQ(m.live(), 0u);
+    EXPECT_EQ(m.stats().added, 4u);
+    EXPECT_EQ(m.stats().rejects, 1u);
+}
+
+TEST(OrderFlow, FormatsTextCommands) {
+    std::string out;
+    FlowOrder n; n.action = FlowAction::New; n.side = Side::Sell; n.qty = 12; n.price_ticks = 5031;
+    FlowModel::appendText(n, 100, out);
+    FlowOrder md; md.action = FlowAction::Modify; md.order_id = 4; md.qty = 3; md.price_ticks = 4999;
+    ASSERT_TRUE(encodeSymbol("SYM1", md.symbol));
+    FlowModel::appendText(md, 100, out);
+    EXPECT_EQ(out, "NEW SELL 12 @ 50.31\nMOD SYM1 4 3 @ 49.99\n");
+}
+
+TEST(OrderFlow, LoadsScenarioFiles) {
+    TempPath good, bad;
+    std::ofstream(good.path) << "# churn\nseed = 9\ncancel_weight=0.5 # trailing\n\n"
+                                "qty_dist = fixed\nqty_median = 40\nsymbols = 3\n";
+    std::ofstream(bad.path) << "seed = 1\nspeed = 3\n";
+
+    FlowConfig cfg;
+    std::string err;
+    ASSERT_TRUE(loadFlowConfig(good.path, cfg, err)) << err;
+    EXPECT_EQ(cfg.seed, 9u);
+    EXPECT_DOUBLE_EQ(cfg.cancel_weight, 0.5);
+    EXPECT_EQ(cfg.qty_dist, QtyDist::Fixed);
+    EXPECT_EQ(cfg.symbols, 3);
+    FlowModel m(cfg);
+    const FlowOrder o = m.next();
+    EXPECT_EQ(o.qty, 40);
+    EXPECT_NE(o.symbol, kDefaultSymbol);
+
+    EXPECT_FALSE(loadFlowConfig(bad.path, cfg, err));
+    EXPECT_EQ(err, bad.path + ":2: unknown setting 'speed'");
+
+    EXPECT_FALSE(setFlowOption(cfg, "qty_dist", "pareto", err));
+    EXPECT_EQ(err, "bad value 'pareto' for qty_dist");
+    EXPECT_FALSE(setFlowOption(cfg, "marketable", "1.5", err));
+    EXPECT_FALSE(loadFlowConfig("/nonexistent/flow.conf", cfg, err));
+}
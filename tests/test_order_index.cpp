@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+#include "order_index.hpp"
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Item { int64_t id; };
+
+using Index = OrderIndex<Item>;
+constexpr int64_t kPage = Index::kPageSlots;
+
+} // namespace
+
+TEST(OrderIndex, SequentialIdsLiveInPagesThatAreReclaimed) {
+    Index ix;
+    std::vector<Item> items(5 * kPage);
+    for (int64_t i = 0; i < 5 * kPage; ++i) {
+        items[i].id = 1000 + i;
+        ix.insert(items[i].id, &items[i]);
+    }
+    EXPECT_EQ(ix.size(), items.size());
+    EXPECT_EQ(ix.tableEntries(), 0u);
+    EXPECT_EQ(ix.windowPages(), 6u);   // 1000 is not page aligned
+    EXPECT_EQ(ix.find(1000), &items[0]);
+    EXPECT_EQ(ix.find(1000 + 5 * kPage - 1), &items.back());
+    EXPECT_EQ(ix.find(999), nullptr);
+    EXPECT_EQ(ix.find(1000 + 5 * kPage), nullptr);
+
+    // Erasing every id of the first pages hands them back.
+    for (int64_t id = 1000; id < 3 * kPage; ++id) EXPECT_EQ(ix.erase(id), &items[id - 1000]);
+    EXPECT_EQ(ix.windowPages(), 3u);
+    EXPECT_EQ(ix.erase(1000), nullptr);
+    EXPECT_EQ(ix.find(3 * kPage), &items[3 * kPage - 1000]);
+
+    // A hole in the middle of the window.
+    for (int64_t id = 4 * kPage; id < 5 * kPage; ++id) ix.erase(id);
+    EXPECT_EQ(ix.windowPages(), 2u);
+    EXPECT_EQ(ix.find(4 * kPage + 7), nullptr);
+    EXPECT_EQ(ix.find(5 * kPage), &items[5 * kPage - 1000]);
+
+    ix.clear();
+    EXPECT_TRUE(ix.empty());
+    EXPECT_EQ(ix.windowPages(), 0u);
+    EXPECT_EQ(ix.find(5 * kPage), nullptr);
+}
+
+TEST(OrderIndex, IdsOutsideTheWindowUseTheTable) {
+    Index ix;
+    Item a{1000000}, b{5}, c{-3}, d{1000001};
+    ix.insert(a.id, &a);
+    ix.insert(b.id, &b);   // below the window
+    ix.insert(c.id, &c);   // negative
+    ix.insert(d.id, &d);
+    EXPECT_EQ(ix.size(), 4u);
+    EXPECT_EQ(ix.tableEntries(), 2u);
+    EXPECT_EQ(ix.find(5), &b);
+    EXPECT_EQ(ix.find(-3), &c);
+    EXPECT_EQ(ix.find(1000001), &d);
+
+    // Replacing keeps one entry per id, wherever it lives.
+    Item b2{5};
+    ix.insert(5, &b2);
+    EXPECT_EQ(ix.find(5), &b2);
+    EXPECT_EQ(ix.size(), 4u);
+
+    EXPECT_EQ(ix.erase(5), &b2);
+    EXPECT_EQ(ix.erase(-3), &c);
+    EXPECT_EQ(ix.erase(5), nullptr);
+    EXPECT_EQ(ix.tableEntries(), 0u);
+    EXPECT_EQ(ix.size(), 2u);
+}
+
+TEST(OrderIndex, SlidesPastOldSurvivors) {
+    Index ix;
+    Item old{10}, mid{3 * kPage}, fresh{0};
+    ix.insert(old.id, &old);
+    ix.insert(mid.id, &mid);
+    fresh.id = static_cast<int64_t>(Index::kMaxPages) * kPage + 2 * kPage;
+    ix.insert(fresh.id, &fresh);
+
+    // The two oldest pages' survivors moved to the table; the rest stayed.
+    EXPECT_EQ(ix.tableEntries(), 1u);
+    EXPECT_EQ(ix.windowPages(), 2u);
+    EXPECT_EQ(ix.find(10), &old);
+    EXPECT_EQ(ix.find(3 * kPage), &mid);
+    EXPECT_EQ(ix.find(fresh.id), &fresh);
+    EXPECT_EQ(ix.size(), 3u);
+}
+
+TEST(OrderIndex, MatchesUnorderedMap) {
+    Index ix;
+    std::unordered_map<int64_t, Item*> ref;
+    std::vector<Item> items(200000);
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<int> pct(0, 99);
+    int64_t next = 1;
+    size_t used = 0;
+    std::vector<int64_t> ids;
+
+    for (int op = 0; op < 200000; ++op) {
+        const int r = pct(rng);
+        if (r < 45 && used < items.size()) {
+            // Mostly the next id, sometimes a jump or a stale / negative id.
+            int64_t id = next++;
+            if (r < 2) id = static_cast<int64_t>(rng() % 1000) - 500;
+            else if (r < 4) next = id = next + static_cast<int64_t>(rng() % (20 * kPage));
+            Item* it = &items[used++];
+            it->id = id;
+            ix.insert(id, it);
+            ref[id] = it;
+            ids.push_back(id);
+        } else if (r < 90 && !ids.empty()) {
+            const size_t i = rng() % ids.size();
+            const int64_t id = ids[i];
+            ids[i] = ids.back();
+            ids.pop_back();
+            auto f = ref.find(id);
+            Item* want = f == ref.end() ? nullptr : f->second;
+            if (f != ref.end()) ref.erase(f);
+            ASSERT_EQ(ix.erase(id), want) << "erase " << id;
+        } else {
+            const int64_t id = static_cast<int64_t>(rng() % static_cast<uint64_t>(next + 600)) - 550;
+            auto f = ref.find(id);
+            ASSERT_EQ(ix.find(id), f == ref.end() ? nullptr : f->second) << "find " << id;
+        }
+        ASSERT_EQ(ix.size(), ref.size());
+    }
+    for (const auto& kv : ref) ASSERT_EQ(ix.find(kv.first), kv.second);
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+#include "order_book.hpp"
+#include "price_format.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace {
+// The exchange's formatter before PriceFormat.
+std::string legacyPrice(int64_t ticks) {
+    char b[64];
+    std::snprintf(b, sizeof(b), "%.2f", static_cast<double>(ticks) / 100.0);
+    return b;
+}
+}
+
+TEST(PriceFormat, MatchesTwoDecimalDoubleText) {
+    const PriceFormat px(100);
+    EXPECT_EQ(px.decimals(), 2);
+    for (int64_t t : {0LL, 1LL, 9LL, 10LL, 99LL, 100LL, 101LL, 5025LL, 5030LL, 999999LL, 123456789012LL})
+        EXPECT_EQ(px(t), legacyPrice(t)) << t;
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int64_t> d(1, 1LL << 40);
+    for (int i = 0; i < 200000; ++i) {
+        const int64_t t = d(rng);
+        ASSERT_EQ(px(t), legacyPrice(t)) << t;
+    }
+}
+
+TEST(PriceFormat, OtherTickFactors) {
+    EXPECT_EQ(PriceFormat(1)(5025), "5025");
+    EXPECT_EQ(PriceFormat(10)(5025), "502.5");
+    EXPECT_EQ(PriceFormat(1000)(5025), "5.025");
+    EXPECT_EQ(PriceFormat(10000)(7), "0.0007");
+    // Not a power of ten: one decimal per digit of the factor, rounded.
+    EXPECT_EQ(PriceFormat(4)(201), "50.3");   // 50.25
+    EXPECT_EQ(PriceFormat(8)(3), "0.4");     // 0.375 at one decimal
+    EXPECT_EQ(PriceFormat(8)(7), "0.9");     // 0.875
+    EXPECT_EQ(PriceFormat(3)(2), "0.7");
+    EXPECT_EQ(PriceFormat(3)(29), "9.7");
+    EXPECT_EQ(PriceFormat(100)(-5), "-0.05");
+    EXPECT_EQ(PriceFormat(100)(INT64_MAX), "92233720368547758.07");
+    EXPECT_EQ(PriceFormat(100)(INT64_MIN), "-92233720368547758.08");
+}
+
+TEST(PriceFormat, AppendEventMatchesFormatEvent) {
+    const PriceFormat px(100);
+    const std::function<std::string(int64_t)> fn = [](int64_t t) { return legacyPrice(t); };
+    std::string out;
+    int n = 0;
+    for (int type = 0; type <= static_cast<int>(BookEventType::Reject); ++type) {
+        for (int reason = 0; reason <= static_cast<int>(RejectReason::JournalFull); ++reason) {
+            BookEvent ev;
+            ev.type = static_cast<BookEventType>(type);
+            ev.reason = static_cast<RejectReason>(reason);
+            ev.side = reason & 1 ? Side::Sell : Side::Buy;
+            ev.qty = 2147483647 - reason;
+            ev.price_ticks = 5025 + reason;
+            ev.order_id = 9000000000LL + reason;
+            ev.new_id = 77;
+            const std::string line = formatEvent(ev, fn);
+            out.clear();
+            out += "prefix ";
+            appendEvent(out, ev, px);
+            EXPECT_EQ(out, "prefix " + line);
+            ++n;
+        }
+    }
+    EXPECT_EQ(n, 7 * 6);
+
+    BookEvent t;
+    t.type = BookEventType::Trade;
+    t.side = Side::Sell;
+    t.qty = 60;
+    t.price_ticks = 5010;
+    t.order_id = 1;
+    out.clear();
+    appendEvent(out, t, px);
+    EXPECT_EQ(out, "TRADE SELL 60 @ 50.10 against id 1");
+}
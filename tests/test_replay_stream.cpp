@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+#include "replay_stream.hpp"
+#include "temp_path.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+BookEvents replayAll(const std::vector<JournalRecord>& ops) {
+    ReplayBooks books;
+    BookEvents all;
+    for (const auto& r : ops) books.apply(r, all);
+    return all;
+}
+}
+
+TEST(ReplayStream, ParsesTextAndCsvCommands) {
+    int64_t next_id = 1;
+    JournalRecord r;
+
+    ASSERT_EQ(parseReplayLine("NEW BUY 10 @ 50.25", 100, next_id, r), ReplayParse::Ok);
+    EXPECT_EQ(r.op, static_cast<uint8_t>(JournalOp::New));
+    EXPECT_EQ(r.side, 0);
+    EXPECT_EQ(r.qty, 10u);
+    EXPECT_EQ(r.price_ticks, 5025);
+    EXPECT_EQ(r.order_id, 1);
+    EXPECT_EQ(r.symbol, kDefaultSymbol);
+
+    ASSERT_EQ(parseReplayLine("NEW,AAPL,SELL,5,50.30", 100, next_id, r), ReplayParse::Ok);
+    SymbolId aapl;
+    ASSERT_TRUE(encodeSymbol("AAPL", aapl));
+    EXPECT_EQ(r.symbol, aapl);
+    EXPECT_EQ(r.side, 1);
+    EXPECT_EQ(r.order_id, 2);
+
+    ASSERT_EQ(parseReplayLine("MOD AAPL 2 7 @ 50.40\r", 100, next_id, r), ReplayParse::Ok);
+    EXPECT_EQ(r.op, static_cast<uint8_t>(JournalOp::Modify));
+    EXPECT_EQ(r.order_id, 2);
+    EXPECT_EQ(r.qty, 7u);
+    EXPECT_EQ(r.price_ticks, 5040);
+
+    ASSERT_EQ(parseReplayLine("CXL 1", 100, next_id, r), ReplayParse::Ok);
+    EXPECT_EQ(r.op, static_cast<uint8_t>(JournalOp::Cancel));
+    EXPECT_EQ(r.order_id, 1);
+    EXPECT_EQ(next_id, 3);   // only NEW takes an id
+
+    EXPECT_EQ(parseReplayLine("", 100, next_id, r), ReplayParse::Skip);
+    EXPECT_EQ(parseReplayLine("# comment", 100, next_id, r), ReplayParse::Skip);
+    EXPECT_EQ(parseReplayLine("NEW BUY 0 @ 1", 100, next_id, r), ReplayParse::Error);
+    EXPECT_EQ(parseReplayLine("NEW BUY 10 @ -1", 100, next_id, r), ReplayParse::Error);
+    EXPECT_EQ(parseReplayLine("CXL x", 100, next_id, r), ReplayParse::Error);
+    EXPECT_EQ(parseReplayLine("HELLO", 100, next_id, r), ReplayParse::Error);
+    EXPECT_EQ(next_id, 3);
+}
+
+TEST(ReplayStream, TextFileReportsBadLine) {
+    TempPath tmp;
+    { std::ofstream(tmp.path) << "NEW BUY 10 @ 1.00\nNEW BUY ten @ 1.00\n"; }
+    std::vector<JournalRecord> ops;
+    std::string err;
+    EXPECT_FALSE(loadReplay(tmp.path, ReplayFormat::Auto, 100, ops, err));
+    EXPECT_NE(err.find(":2:"), std::string::npos);
+}
+
+TEST(ReplayStream, JournalAndTextReplayIdentically) {
+    TempPath text, jpath;
+    {
+        std::ofstream out(text.path);
+        out << "# two symbols, a cross, a modify and a cancel\n"
+               "NEW BUY 10 @ 100.00\n"
+               "NEW MSFT SELL 5 @ 200.00\n"
+               "NEW SELL 4 @ 99.50\n"
+               "MOD MSFT 2 8 @ 201.00\n"
+               "CXL 1\n"
+               "CXL 42\n";
+    }
+    std::vector<JournalRecord> from_text;
+    std::string err;
+    ASSERT_TRUE(loadReplay(text.path, ReplayFormat::Auto, 100, from_text, err)) << err;
+    ASSERT_EQ(from_text.size(), 6u);
+
+    // The same stream as the exchange would have journaled it.
+    unlink(jpath.path.c_str());
+    {
+        Journal j;
+        ASSERT_TRUE(j.open(jpath.path, 16, JournalSync::None));
+        for (const auto& r : from_text) ASSERT_NE(j.append(r), 0u);
+    }
+    std::vector<JournalRecord> from_journal;
+    ASSERT_TRUE(loadReplay(jpath.path, ReplayFormat::Auto, 100, from_journal, err)) << err;
+    ASSERT_EQ(from_journal.size(), from_text.size());
+
+    const BookEvents a = replayAll(from_text);
+    const BookEvents b = replayAll(from_journal);
+    ASSERT_EQ(a.size(), b.size());
+    size_t trades = 0, rejects = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].type, b[i].type);
+        EXPECT_EQ(a[i].order_id, b[i].order_id);
+        EXPECT_EQ(a[i].qty, b[i].qty);
+        EXPECT_EQ(a[i].price_ticks, b[i].price_ticks);
+        trades += a[i].type == BookEventType::Trade;
+        rejects += a[i].type == BookEventType::Reject;
+    }
+    EXPECT_EQ(trades, 1u);    // SELL 4 @ 99.50 against id 1
+    EXPECT_GE(rejects, 1u);   // CXL 42
+}
+
+TEST(ReplayStream, DenseAndMapBooksAgree) {
+    std::vector<JournalRecord> ops;
+    int64_t next_id = 1;
+    JournalRecord r;
+    uint32_t x = 12345;
+    for (int i = 0; i < 5000; ++i) {
+        x = x * 1103515245u + 12345u;
+        char line[64];
+        if (i > 10 && x % 4 == 0) std::snprintf(line, sizeof(line), "CXL %u", 1 + (x >> 8) % static_cast<uint32_t>(next_id - 1));
+        else std::snprintf(line, sizeof(line), "NEW %s %u @ %u.%02u", (x >> 4) & 1 ? "BUY" : "SELL",
+                           1 + (x >> 5) % 50, 95 + (x >> 11) % 10, (x >> 16) % 100);
+        ASSERT_EQ(parseReplayLine(line, 100, next_id, r), ReplayParse::Ok) << line;
+        ops.push_back(r);
+    }
+    BookConfig dense;
+    dense.ladder = LadderKind::Dense;
+    ReplayBooks a, b(dense);
+    BookEvents ea, eb;
+    for (const auto& op : ops) { a.apply(op, ea); b.apply(op, eb); }
+    ASSERT_EQ(ea.size(), eb.size());
+    for (size_t i = 0; i < ea.size(); ++i) {
+        ASSERT_EQ(ea[i].type, eb[i].type) << i;
+        ASSERT_EQ(ea[i].order_id, eb[i].order_id) << i;
+        ASSERT_EQ(ea[i].price_ticks, eb[i].price_ticks) << i;
+        ASSERT_EQ(ea[i].qty, eb[i].qty) << i;
+    }
+}
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "session.hpp"
+
+#include <chrono>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+// Connected stream pair: the session writes to 'server', the test reads 'client'.
+struct Pair {
+    int server = -1, client = -1;
+    Pair() {
+        int sv[2];
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+        server = sv[0]; client = sv[1];
+        timeval tv{0, 200000};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+    ~Pair() { if (server >= 0) close(server); if (client >= 0) close(client); }
+
+    std::string read(size_t want) {
+        std::string out;
+        char buf[4096];
+        while (out.size() < want) {
+            const ssize_t n = recv(client, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            out.append(buf, static_cast<size_t>(n));
+        }
+        return out;
+    }
+};
+}
+
+TEST(SessionTable, DeliversRepliesInOrder) {
+    SessionTable t(4);
+    t.start();
+    Pair p;
+    const SessionId id = t.open(p.server);
+    ASSERT_NE(id, kNoSession);
+
+    std::string expect;
+    for (int i = 0; i < 100; ++i) {
+        const std::string line = "REPLY " + std::to_string(i) + "\n";
+        ASSERT_TRUE(t.send(id, line));
+        expect += line;
+    }
+    EXPECT_EQ(p.read(expect.size()), expect);
+
+    const SessionStats st = t.close(id);
+    EXPECT_EQ(st.replies, 100u);
+    EXPECT_EQ(st.bytes, expect.size());
+    t.stop();
+    EXPECT_LE(t.totals().writes, 100u);   // coalesced, never more than one write per reply
+}
+
+TEST(SessionTable, StaleIdsAreRejected) {
+    SessionTable t(1);
+    t.start();
+    Pair a;
+    const SessionId first = t.open(a.server);
+    ASSERT_NE(first, kNoSession);
+    EXPECT_EQ(t.open(a.server), kNoSession);   // table full
+    t.close(first);
+    EXPECT_FALSE(t.send(first, "late\n"));
+
+    // The slot is reused (after the writer releases it) under a new generation.
+    Pair b;
+    SessionId second = kNoSession;
+    for (int i = 0; i < 100 && second == kNoSession; ++i) {
+        second = t.open(b.server);
+        if (second == kNoSession) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_NE(second, kNoSession);
+    EXPECT_NE(second, first);
+    EXPECT_FALSE(t.send(first, "late\n"));
+    EXPECT_TRUE(t.send(second, "hi\n"));
+    EXPECT_EQ(b.read(3), "hi\n");
+    t.stop();
+}
+
+TEST(SessionTable, ClientThatStopsReadingIsDropped) {
+    SessionTable t(2, /*max_backlog*/ 64 * 1024);
+    t.start();
+    Pair p;
+    const int small = 4096;
+    setsockopt(p.server, SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    setsockopt(p.client, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+    const SessionId id = t.open(p.server);
+
+    // Nobody reads: the socket fills, the backlog grows, then the session is cut.
+    const std::string chunk(1024, 'x');
+    bool accepted = true;
+    for (int i = 0; i < 1000 && accepted; ++i) accepted = t.send(id, chunk);
+    EXPECT_FALSE(accepted);
+    EXPECT_EQ(t.slowDisconnects(), 1u);
+    EXPECT_FALSE(t.send(id, chunk));
+
+    // The reader side sees the shutdown.
+    char buf[4096];
+    ssize_t n;
+    while ((n = recv(p.server, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {}
+    EXPECT_EQ(n, 0);
+    EXPECT_TRUE(t.close(id).overflowed);
+    t.stop();
+}
@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+#include "stage_stats.hpp"
+
+#include <sstream>
+
+TEST(StageStats, SplitsStampsIntoStages) {
+    StageStats s;
+    // read, enqueue, dequeue, start, matched, md, replied
+    s.record({1000, 1400, 3400, 3500, 3800, 3900, 4600});
+    s.record({2000, 2400, 3400, 3300, 3900, 4000, 4700});   // start before dequeue: clamped
+    EXPECT_EQ(s.interval(Stage::Parse).max(), 400u);
+    EXPECT_EQ(s.interval(Stage::Queue).max(), 2000u);
+    EXPECT_EQ(s.interval(Stage::Queue).min(), 1000u);
+    EXPECT_EQ(s.interval(Stage::Batch).min(), 0u);
+    EXPECT_EQ(s.interval(Stage::Match).max(), 600u);
+    EXPECT_EQ(s.interval(Stage::MarketData).max(), 100u);
+    EXPECT_EQ(s.interval(Stage::Reply).max(), 700u);
+    EXPECT_EQ(s.interval(Stage::Total).max(), 3600u);
+    EXPECT_EQ(s.interval(Stage::Total).count(), 2u);
+    EXPECT_EQ(s.total(Stage::Total).count(), 0u);
+}
+
+TEST(StageStats, IntervalsRollIntoTheTotal) {
+    StageStats a, b;
+    EXPECT_FALSE(a.rollInterval());
+    a.record({0, 100, 200, 300, 400, 500, 600});
+    ASSERT_TRUE(a.rollInterval());
+    EXPECT_EQ(a.interval(Stage::Total).count(), 0u);
+    a.record({0, 100, 200, 300, 400, 500, 1200});
+    a.rollInterval();
+    b.record({0, 100, 200, 300, 400, 500, 900});
+    b.rollInterval();
+    a.merge(b);
+    EXPECT_EQ(a.total(Stage::Total).count(), 3u);
+    EXPECT_EQ(a.total(Stage::Total).max(), 1200u);
+    EXPECT_EQ(a.total(Stage::Parse).mean(), 100.0);
+
+    std::ostringstream out;
+    a.writeTotal(out);
+    const std::string t = out.str();
+    EXPECT_NE(t.find("stage (us)"), std::string::npos);
+    EXPECT_NE(t.find("  parse                 3      0.10"), std::string::npos) << t;
+    EXPECT_NE(t.find("  market data"), std::string::npos);
+    EXPECT_NE(t.find("  total                 3"), std::string::npos);
+}
+
+TEST(StageStats, ClockIsMonotonic) {
+    const uint64_t a = stageNow();
+    const uint64_t b = stageNow();
+    EXPECT_GT(a, 0u);
+    EXPECT_GE(b, a);
+}
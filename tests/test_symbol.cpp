@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+#include "symbol.hpp"
+
+#include <vector>
+
+TEST(Symbol, EncodesAndNamesRoundTrip) {
+    SymbolId id = 0;
+    ASSERT_TRUE(encodeSymbol("AAPL", id));
+    EXPECT_NE(id, kDefaultSymbol);
+    EXPECT_EQ(symbolName(id), "AAPL");
+    EXPECT_TRUE(validSymbol(id));
+
+    ASSERT_TRUE(encodeSymbol("BRK.B", id));
+    EXPECT_EQ(symbolName(id), "BRK.B");
+    ASSERT_TRUE(encodeSymbol("SYM12345", id));   // exactly 8 chars
+    EXPECT_EQ(symbolName(id), "SYM12345");
+    EXPECT_EQ(symbolName(kDefaultSymbol), "");
+}
+
+TEST(Symbol, RejectsMalformedSymbols) {
+    SymbolId id = 0;
+    EXPECT_FALSE(encodeSymbol("", id));
+    EXPECT_FALSE(encodeSymbol("TOOLONGSYM", id));
+    EXPECT_FALSE(encodeSymbol("aapl", id));
+    EXPECT_FALSE(encodeSymbol("1ABC", id));
+    EXPECT_FALSE(encodeSymbol("AB C", id));
+
+    // Raw bytes with data after the NUL padding, or bad characters.
+    EXPECT_FALSE(validSymbol(0x4100000000000041ULL));
+    EXPECT_FALSE(validSymbol(0x61ULL));
+    EXPECT_TRUE(validSymbol(kDefaultSymbol));
+}
+
+TEST(Symbol, ShardIsStableAndSpread) {
+    const size_t shards = 4;
+    std::vector<int> hits(shards, 0);
+    for (int i = 0; i < 400; ++i) {
+        SymbolId id = 0;
+        ASSERT_TRUE(encodeSymbol("SYM" + std::to_string(i), id));
+        const size_t s = symbolShard(id, shards);
+        ASSERT_LT(s, shards);
+        EXPECT_EQ(s, symbolShard(id, shards));
+        ++hits[s];
+    }
+    for (int h : hits) EXPECT_GT(h, 50);
+    EXPECT_EQ(symbolShard(12345, 1), 0u);
+}